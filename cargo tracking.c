@@ -1,7 +1,25 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
+#include <time.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/prctl.h>
 
 // Gonderim ve Musteri Yapilari
 typedef struct Shipment {
@@ -9,29 +27,149 @@ typedef struct Shipment {
     char date[11];  // YYYY-MM-DD formatinda
     char status[20]; // "Teslim Edildi" veya "Teslim Edilmedi"
     int deliveryTime; // Gun cinsinden teslim suresi
+    uint32_t version; // Eklendigi surum (snapshot okumalari icin)
     struct Shipment* next;
 } Shipment;
 
+// Musteri kaydi: isimler namePool icinde tutulur, kayitta sadece ofsetleri bulunur
+// (64 bitlik sistemde 32 bayt, bir onbellek satirina iki musteri sigar)
 typedef struct Customer {
     int customerID;
-    char firstName[50];
-    char lastName[50];
+    uint32_t firstName; // namePool ofseti
+    uint32_t lastName;  // namePool ofseti
+    uint32_t archive;   // archiveHeads indeksi (0 = arsiv yok)
     Shipment* shipmentHistory; // Linked List (Gonderim Gecmisi)
     struct Customer* next;
 } Customer;
 
+// Arsiv Blogu: teslim edilmis eski gonderiler tarih sirasiyla delta/varint kodlanir
+#define ARCHIVE_BLOCK_CAPACITY 128
+
+typedef struct ArchiveBlock {
+    int firstDay;        // Bloktaki en eski tarih (1970'ten itibaren gun)
+    int lastDay;         // Bloktaki en yeni tarih
+    int count;           // Kayit sayisi
+    uint32_t byteLength; // Kodlanmis veri uzunlugu
+    struct ArchiveBlock* next;
+    unsigned char bytes[];
+} ArchiveBlock;
+
+// Arsiv bloklarini sirayla cozen imlec
+typedef struct ArchiveCursor {
+    const ArchiveBlock* block;
+    uint32_t offset;
+    int index;
+    int day;
+    int shipmentID;
+} ArchiveCursor;
+
+ArchiveBlock** archiveHeads = NULL; // Musteri basina blok listesi
+uint32_t archiveHeadCount = 0;
+uint32_t archiveHeadCapacity = 0;
+
+// Isim Havuzu: ayni isim yalnizca bir kez saklanir (string interning)
+typedef struct NamePool {
+    char* data;          // NUL ile ayrilmis isimler, yalnizca sona ekleme
+    uint32_t length;
+    uint32_t capacity;
+    uint32_t* slots;     // Acik adresleme tablosu (ofset + 1, 0 = bos)
+    uint32_t slotCount;  // Her zaman 2'nin kuvveti
+    uint32_t used;
+} NamePool;
+
+NamePool namePool = { NULL, 0, 0, NULL, 0, 0 };
+
+// Musteri kayitlari tek tek malloc yerine bloklar halinde ayrilir
+#define CUSTOMER_BLOCK_SIZE 4096
+
+typedef struct CustomerBlock {
+    struct CustomerBlock* next;
+    int used;
+    Customer items[CUSTOMER_BLOCK_SIZE];
+} CustomerBlock;
+
+CustomerBlock* customerBlocks = NULL;
+
+// Musteri ID'sine gore dogrudan erisim tablosu (ID'ler 1'den itibaren sirali verilir)
+Customer** customerTable = NULL;
+int* customerShipmentCounts = NULL; // Arsivdekiler dahil gonderi sayisi, ayni kapasitede
+uint32_t* customerLastAccess = NULL; // Gecmise son erisim damgasi (LRU), ayni kapasitede
+Customer* pinnedCustomer = NULL;     // Gecmisine en son erisilen musteri (diske tasinmaz)
+int customerTableCapacity = 0;
+
+// Bellek muhasebesi: her yapinin ayirdigi bayt (yalnizca yazici gunceller).
+// Toplam memoryCeiling'i asinca en uzun suredir erisilmeyen gonderim
+// gecmisleri disk segmentine tasinir (spill), erisildiginde geri okunur.
+// Tasima yalnizca guvenli noktalarda (ust duzey bir islem bittiginde) yapilir;
+// islem ortasinda tutulan Shipment isaretcileri boylece gecerli kalir.
+typedef enum MemoryCategory {
+    MEMORY_CUSTOMERS,
+    MEMORY_HISTORIES,
+    MEMORY_QUEUE,
+    MEMORY_STACK,
+    MEMORY_CITIES,
+    MEMORY_CATEGORY_COUNT
+} MemoryCategory;
+
+size_t memoryUsage[MEMORY_CATEGORY_COUNT];
+size_t memoryCeiling = 0; // --memory-limit (0 = sinirsiz)
+
+// Isim Indeksi: musteriler (soyad, ad, ID) sirasina gore dizilir.
+// Yeni musteriler kucuk, sirali pending dizisine yerlestirilir; pending ana
+// dizinin karekokunu asinca ana diziyle birlestirilir. Bu isler eklemede yapilir
+// (musteri basina amorti O(kok n)); sorgular yalnizca iki sirali diziyi okur.
+typedef struct NameIndex {
+    Customer** sorted;
+    int sortedCount;
+    int sortedCapacity;
+    Customer** pending;
+    int pendingCount;
+    int pendingCapacity;
+} NameIndex;
+
+NameIndex nameIndex = { NULL, 0, 0, NULL, 0, 0 };
+
 int autoCustomerID = 1;
 int autoShipmentID = 1;
 
+// Bolumlu modda isci p yalnizca p+1, p+1+N, ... musteri ve gonderi ID'lerini
+// uretir (N = idStride); tablolar yogun kalsin diye ID yerel sira numarasina cevrilir
+int idStride = 1;
+int partitionIndex = 0;
+
+static inline int customerSlot(int customerID) {
+    return idStride == 1 ? customerID : (customerID - 1) / idStride + 1;
+}
+
 // Priority Queue Veri Yapisi
 typedef struct PriorityQueueNode {
     int shipmentID;
     int deliveryTime; // Gun cinsinden teslim suresi
     char status[20];  // "Isleme Alindi", "Teslimatta", "Teslim Edildi"
+    uint32_t born;    // Eklendigi surum
+    uint32_t died;    // Kuyruktan cikarildigi surum (0 = kuyrukta)
     struct PriorityQueueNode* next;
 } PriorityQueueNode;
 
 PriorityQueueNode* priorityQueue = NULL; // Kuyruk baslangici
+PriorityQueueNode* priorityQueueChain = NULL;    // Okuyucular icin zincir basi (olu dugumler dahil)
+PriorityQueueNode* priorityQueueDeadTail = NULL; // Zincirdeki son olu dugum
+
+// Teslim suresi indeksi: her kucuk sure degeri icin kuyruktaki son dugum.
+// Ekleme, kuyrugu bastan gezmek yerine en yakin dolu kovanin sonuna yapilir.
+#define QUEUE_TAIL_BUCKETS 1024
+PriorityQueueNode* queueBucketTails[QUEUE_TAIL_BUCKETS];
+uint64_t queueBucketMask[QUEUE_TAIL_BUCKETS / 64]; // Dolu kovalar
+
+// Hub kuyruklarindaki kargo (her sehrin kendi oncelik kuyrugu vardir)
+typedef struct HubParcel {
+    int shipmentID;
+    int deliveryTime;
+    uint32_t sequence; // Esit surelerde gelis sirasi
+    char status[20];
+} HubParcel;
+
+typedef void (*HubParcelHandler)(int hub, const HubParcel* parcel, void* context);
 
 // Sehir Dugumu Yapisi
 typedef struct CityNode {
@@ -40,10 +178,66 @@ typedef struct CityNode {
     int deliveryTime;          // Teslim suresi (gun cinsinden)
     struct CityNode* child;    // Ilk alt sehir (cocuk dugum)
     struct CityNode* sibling;  // Aynı seviyedeki sonraki sehir
+    uint32_t version;          // Eklendigi surum
 } CityNode;
 
 CityNode* root = NULL; // Agacin koku (kargo sirketinin merkezi)
-int autoCityID = 1;
+int autoCityID = 1;       // Kullanilan en buyuk sehir ID'si
+
+// Sehir ID'sinden dugume dizin (yalnizca yazici kullanir). lastChild cocuk
+// zincirinin sonudur; yeni sehir kardes zinciri yurunmeden eklenir.
+// parentCityID, hub kuyruguna sonradan eklenen sehrin ebeveynini bulmak icindir.
+// Dizin sayfalidir: yalnizca kullanilan ID araliklarinin sayfalari acilir,
+// boylece seyrek ID'ler (ornegin 1 ve 16777215) iki sayfa kadar yer tutar.
+#define CITY_MAX_ID 16777215
+#define CITY_INDEX_PAGE_BITS 12
+#define CITY_INDEX_PAGE_SIZE (1 << CITY_INDEX_PAGE_BITS)
+#define CITY_INDEX_PAGES ((CITY_MAX_ID >> CITY_INDEX_PAGE_BITS) + 1)
+
+typedef struct CityIndexEntry {
+    CityNode* city;
+    CityNode* lastChild;
+    int parentCityID; // Kok icin 0
+} CityIndexEntry;
+
+typedef struct CityIndex {
+    CityIndexEntry** pages; // CITY_INDEX_PAGES isaretci; ilk sayfa acilirken ayrilir
+    int pageCount;          // Acilmis sayfa sayisi
+} CityIndex;
+
+CityIndex cityIndex = { NULL, 0 };
+
+// Toplu islem gunlugu: her kayit bir eklemenin tersidir (hangi dugumun nereden
+// cikarilacagi). Dugumler kopyalanmaz; geri alinan dugum yinelenene ya da
+// gunluk atilana kadar kayitta bekler.
+typedef enum OpLogKind {
+    OPLOG_SHIPMENT,
+    OPLOG_CITY
+} OpLogKind;
+
+typedef struct OpLogEntry {
+    int kind;
+    int owner;    // Musteri ID'si ya da ebeveyn sehir ID'si (kok icin 0)
+    void* node;   // Eklenen Shipment/CityNode
+    void* before; // Onceki gonderi ya da ebeveynin onceki son cocugu (yoksa NULL)
+} OpLogEntry;
+
+typedef struct OpLog {
+    OpLogEntry* entries;
+    int applied;        // [0, applied) uygulanmis, [applied, end) yinelenebilir
+    int end;
+    int capacity;
+    int* batchStarts;   // Her toplu islemin ilk kaydi
+    int appliedBatches;
+    int batchEnd;
+    int batchCapacity;
+    int openStart;      // Acik toplu islemin ilk kaydi (-1 = yok)
+} OpLog;
+
+OpLog opLog = { .openStart = -1 };
+int opLogActive = 0; // Acik islem ya da kayit varsa 1; ekleme yolunda tek dal
+uint32_t* loggedShipmentCounts = NULL; // Musteri sirasina gore gunlukteki gonderi kaydi
+int loggedShipmentCapacity = 0;
 
 // Stack Veri Yapisi
 typedef struct ShipmentStackNode {
@@ -51,34 +245,112 @@ typedef struct ShipmentStackNode {
     char date[11];  // YYYY-MM-DD formatinda
     char status[20]; // "Teslim Edildi" veya "Teslim Edilmedi"
     int deliveryTime; // Gun cinsinden teslim suresi
+    uint32_t born;    // Eklendigi surum
+    uint32_t died;    // Cikarildigi surum (0 = stack'te)
     struct ShipmentStackNode* next;
 } ShipmentStackNode;
 
 ShipmentStackNode* shipmentStack = NULL; // Stack'in tepe noktasi
+ShipmentStackNode* shipmentStackChain = NULL;    // Okuyucular icin zincir basi
+ShipmentStackNode* shipmentStackDeadTail = NULL; // Zincirdeki son olu dugum
+
+// Kuyruk ve stack'e tekrar eklenen kargo ID'lerini yakalayan filtre:
+// canli ID'lerin kesin kumesi. Yeni ID'de bos yuvaya kadar yapilan tarama
+// hem "yok" cevabini hem ekleme yerini verir; onune konan bir Bloom filtresi
+// bu taramayi kaldiramadigi icin yalnizca ek maliyetti.
+typedef struct ShipmentIDFilter {
+    int64_t* slots;         // Acik adresleme, doluluk en fazla %75
+    uint32_t slotCount;     // 2'nin kuvveti
+    uint32_t live;
+    long duplicates;
+} ShipmentIDFilter;
+
+ShipmentIDFilter queueIDFilter = { 0 };
+ShipmentIDFilter stackIDFilter = { 0 };
+int shipmentDedupEnabled = 1;
 
 // Global degisken (musteri listesi baslangic noktasi)
 Customer* customerList = NULL;
 
+int quietMode = 0; // Sunucu modunda konsol ciktisini kapatir
+
+#define ROLLUP_MAX_QUERY_DAYS 3660 // Gunluk ozet sorgusunun en fazla gun sayisi
+
+// Buyuyebilen bayt tamponu (sunucu yanitlari ve disa aktarim)
+typedef struct ByteBuffer {
+    unsigned char* data;
+    size_t length;
+    size_t capacity;
+} ByteBuffer;
+
+// Gonderim gecmisi disa aktarim imleci. Gecmisler musteri ID'sine, her musteride
+// (tarih, gonderi ID) sirasina gore gezilir; imlec son yazilan kaydi tutar ve
+// metin anahtari olarak saklanip sonraki sayfada geri verilebilir.
+#define EXPORT_DISPLAY_RECORDS 100 // Konsolda tek seferde gosterilen kayit
+
+typedef enum ExportFormat {
+    EXPORT_TEXT,  // Konsol satirlari (displayCustomerShipments bicimi)
+    EXPORT_CSV,
+    EXPORT_JSONL
+} ExportFormat;
+
+typedef struct ExportCursor {
+    int customerID;      // Siradaki musteri (0 = disa aktarim bitti)
+    int singleCustomer;  // 1: yalnizca customerID disa aktarilir
+    char afterDate[11];  // Bu musteride (afterDate, afterShipmentID) dahil oncesi yazildi
+    int afterShipmentID; // afterDate bos ise musterinin basindan baslanir
+    int headerWritten;   // CSV basligi yalnizca ilk sayfada
+    // Devam ipucu: sayfa ortasinda kalinan canli liste konumu. Yalnizca
+    // hintVersion hala commitVersion ise gecerlidir (0: ipucu yok).
+    uint32_t hintVersion;
+    const Shipment* hintNode;  // Bellekteki gecmiste siradaki dugum
+    uint32_t hintSpilledNext;  // Diske tasinmis gecmiste siradaki kayit
+} ExportCursor;
+
 // Fonksiyon Prototipleri
 void menu();
 void initializeDefaultCities();
 void printError(const char* message);
+void printInfo(const char* format, ...);
 void* safeMalloc(size_t size);
-
-void addCustomer(char* firstName, char* lastName);
+void* safeRealloc(void* ptr, size_t size);
+void trackMemory(MemoryCategory category, long delta);
+size_t totalMemoryUsage();
+long spillLeastRecentHistories(size_t targetBytes);
+
+uint32_t internName(const char* name);
+const char* customerFirstName(const Customer* customer);
+const char* customerLastName(const Customer* customer);
+Customer* allocateCustomer();
+void printCustomerMemoryReport();
+void indexCustomerName(Customer* customer);
+void flushNameIndex();
+int searchCustomersByName(const char* lastName, const char* firstName, int prefix,
+                          int offset, int limit, Customer** out, int* total);
+void freeNameIndex();
+
+int addCustomer(char* firstName, char* lastName);
 Customer* findCustomer(int customerID);
-void addShipment(int customerID, char* date, char* status, int deliveryTime);
+int addShipment(int customerID, char* date, char* status, int deliveryTime);
 void displayCustomerShipments(int customerID);
 
-void addToPriorityQueue(int shipmentID, int deliveryTime, char* status);
+int addToPriorityQueue(int shipmentID, int deliveryTime, char* status);
+int takePriorityQueueHead(PriorityQueueNode* out);
 void processPriorityQueue();
 void displayPriorityQueue();
 void freePriorityQueue();
+int collectLastShipments(Shipment* out, int limit);
 void displayLastFiveShipments();
 
-CityNode* createCityNode(int cityID, char* cityName);
-void addCity(int parentCityID, int cityID, char* cityName, int deliveryTime);
+CityNode* createCityNode(int cityID, const char* cityName);
+int addCity(int parentCityID, int cityID, char* cityName, int deliveryTime);
+#ifdef KARGO_LEGACY_BENCH
+int legacyAddCity(int parentCityID, int cityID, char* cityName, int deliveryTime);
 CityNode* findCity(CityNode* node, int cityID);
+#endif
+CityNode* findCityByID(int cityID);
+void freeCityIndex(CityIndex* index);
+int loadCityNetwork(const char* path);
 int calculateTreeDepth(CityNode* node);
 void printTree(CityNode* node, int level);
 void freeCityTree(CityNode* node);
@@ -86,12 +358,21 @@ int countCities(CityNode* node);
 void printCitiesAlphabetically(CityNode* node);
 int calculateMinDeliveryTime(CityNode* node);
 
-Shipment* searchDeliveredShipments(Shipment* shipmentHistory, const char* date);
-void mergeSortShipments(Shipment** shipmentHistory);
-Shipment* sortedMerge(Shipment* left, Shipment* right);
-void splitList(Shipment* head, Shipment** frontRef, Shipment** backRef);
-
-void pushShipment(int shipmentID, char* date, char* status, int deliveryTime);
+Shipment* searchDeliveredShipments(Customer* customer, const char* date, Shipment* scratch);
+Shipment* searchDeliveredInList(Shipment* shipmentHistory, const char* date);
+void displaySortedHistory(int customerID, int keyChoice, int descending, const char* fromDate, const char* toDate);
+#ifdef KARGO_LEGACY_BENCH
+void legacyMergeSortShipments(Shipment** shipmentHistory);
+Shipment* legacySortedMerge(Shipment* left, Shipment* right);
+void legacySplitList(Shipment* head, Shipment** frontRef, Shipment** backRef);
+Shipment* legacySearchDeliveredInList(Shipment* shipmentHistory, const char* date);
+#endif
+
+int pushShipment(int shipmentID, char* date, char* status, int deliveryTime);
+int shipmentIDFilterInsert(ShipmentIDFilter* filter, int shipmentID);
+void shipmentIDFilterRemove(ShipmentIDFilter* filter, int shipmentID);
+void freeShipmentIDFilter(ShipmentIDFilter* filter);
+int takeStackTop(ShipmentStackNode* out);
 void popShipment();
 void displayShipmentStack();
 void freeShipmentStack();
@@ -99,11 +380,248 @@ void freeShipmentStack();
 int isValidName(const char* name, int length);
 int isValidDate(const char* date);
 int isPositiveNumber(int number);
-int countShipments(Shipment* shipment);
+
+int dateToDays(const char* date);
+void daysToDate(int days, char* out);
+void recordShipmentRollup(int customerID, const Shipment* shipment);
+int updateShipmentStatus(int customerID, int shipmentID, const char* status);
+void displayDailyRollups(int dayCount);
+void freeRollups();
+int beginBatch();
+int commitBatch();
+int rollbackBatch();
+int undoBatch();
+int redoBatch();
+void logShipmentInsert(Customer* customer, Shipment* shipment, Shipment** link);
+void logCityInsert(int parentCityID, CityNode* city, CityNode* previousLastChild);
+void replaceLoggedShipment(const Shipment* old, Shipment* updated);
+int isLoggedCustomer(int customerID);
+void discardOpLog(const char* reason);
+void freeOpLog();
+Shipment* customerHistory(Customer* customer);
+int loadCustomerHistory(Customer* customer);
+int isSpilledHistory(const Shipment* history);
+void releaseRetiredSpillExtent(void* tagged);
+int readSpilledShipments(const Shipment* history, uint32_t start, Shipment* out, int max);
+void freeShipmentHistory(Shipment* history);
+void enforceMemoryCeiling();
+void displayMemoryUsage();
+void freeSpillSegment();
+long archiveDeliveredShipments(const char* cutoffDate, size_t* freedBytes, size_t* archivedBytes);
+void openArchiveCursor(ArchiveCursor* cursor, const ArchiveBlock* block);
+int nextArchivedShipment(ArchiveCursor* cursor, Shipment* out);
+int searchArchivedShipments(const Customer* customer, const char* targetDate, Shipment* out);
+ArchiveBlock** customerArchive(const Customer* customer);
+int countCustomerShipments(const Customer* customer);
+void freeArchive();
 
 void freeCustomerList();
 void cleanup();
 
+uint32_t beginWrite();
+void commitWrite();
+void bumpCommitVersion();
+int isVisible(uint32_t born, uint32_t died);
+void beginSnapshotRead();
+void endSnapshotRead();
+void releaseReaderSlot();
+void retireMemory(void* pointer);
+void reclaimSnapshots();
+void freeRetiredMemory();
+
+int importCsvFile(const char* path, int threadCount, long* importedCustomers, long* importedShipments);
+int readCsvField(const char** cursor, const char* lineEnd, char* out, size_t capacity);
+int parseCsvNumber(const char* text);
+int defaultThreadCount();
+
+void buildHubQueues();
+int hubQueuesBuilt();
+int enqueueHubParcel(int cityID, int shipmentID, int deliveryTime, const char* status);
+long drainHubQueues(int threadCount, HubParcelHandler handler, void* context);
+void printHubParcel(int hub, const HubParcel* parcel, void* context);
+void displayHubQueues();
+void freeHubQueues();
+
+void bufferReserve(ByteBuffer* buffer, size_t extra);
+void bufferAppend(ByteBuffer* buffer, const void* bytes, size_t count);
+void bufferFree(ByteBuffer* buffer);
+void openExportCursor(ExportCursor* cursor, int customerID);
+int parseExportToken(ExportCursor* cursor, const char* token, int customerID);
+void formatExportToken(const ExportCursor* cursor, char* out, size_t capacity);
+long exportShipments(ExportCursor* cursor, long limit, ExportFormat format, ByteBuffer* out);
+void appendExportRecord(ByteBuffer* out, ExportFormat format, int customerID, const Shipment* shipment, int archived);
+long exportToFile(const char* path, ExportFormat format, long limit, ExportCursor* cursor);
+
+int runServer(const char* socketPath);
+int startPartitionWorkers(int count);
+void stopPartitionWorkers();
+double monotonicSeconds();
+void runCustomerBenchmark(long customerCount);
+void runArchiveBenchmark(long customerCount, int shipmentsPerCustomer);
+void runMemoryBenchmark(long customerCount, int shipmentsPerCustomer, double limitMegabytes);
+void runExportBenchmark(long customerCount, int shipmentsPerCustomer);
+void runPartitionBenchmark(int partitions, long customerCount, int shipmentsPerCustomer);
+void runCityLoadBenchmark(long maxCities);
+void runTraceBenchmark(long spanCount);
+void runUndoBenchmark(long shipmentCount);
+void runImportBenchmark(long rowCount, int maxThreads);
+void runSnapshotBenchmark(int readerCount, double seconds);
+void runDedupBenchmark(long operationCount);
+void runRollupBenchmark(long shipmentCount);
+void runSortBenchmark(long length, int rounds);
+void runDispatchSimulation(long parcelCount, int hubCapacity, const char* tracePath);
+void runHubDispatchBenchmark(long parcelCount, int maxThreads);
+
+// Siralama ve Arama Cekirdekleri
+//
+// Anahtarlar static inline karsilastiricilardir. DEFINE_LIST_KERNELS bir
+// anahtar ve yon icin siralama ve arama fonksiyonlarini uretir; anahtar
+// dogrudan cagrildigi icin derleyici onu dongulerin icine gomer (qsort'taki
+// gibi fonksiyon isaretcisi uzerinden cagri yapilmaz). Uretilen tum
+// fonksiyonlar kararlidir: esit anahtarli dugumler mevcut siralarini korur.
+#define SORT_ASCENDING 1
+#define SORT_DESCENDING -1
+
+static inline int compareIntKeys(int a, int b) {
+    return (a > b) - (a < b);
+}
+
+// YYYY-MM-DD metninde sozluk sirasi tarih sirasidir
+static inline int shipmentDateKey(const Shipment* a, const Shipment* b) {
+    return memcmp(a->date, b->date, 10);
+}
+
+static inline int shipmentIDKey(const Shipment* a, const Shipment* b) {
+    return compareIntKeys(a->shipmentID, b->shipmentID);
+}
+
+static inline int shipmentDateIDKey(const Shipment* a, const Shipment* b) {
+    int result = shipmentDateKey(a, b);
+    return result != 0 ? result : shipmentIDKey(a, b);
+}
+
+static inline int shipmentDeliveryKey(const Shipment* a, const Shipment* b) {
+    return compareIntKeys(a->deliveryTime, b->deliveryTime);
+}
+
+static inline int queueDeliveryKey(const PriorityQueueNode* a, const PriorityQueueNode* b) {
+    return compareIntKeys(a->deliveryTime, b->deliveryTime);
+}
+
+// name##Merge      : iki sirali listeyi birlestirir (esitlerde a onde)
+// name##Sort       : listeyi yerinde siralar (ozyinelemesiz, asagidan yukari birlestirme)
+// name##SortArray  : isaretci dizisini siralar
+// name##InsertLink : probe'un eklenecegi baglanti (esitlerin sonu)
+// name##LowerBound : anahtari probe'dan kucuk olmayan ilk dugum
+// name##LastAtOrBefore: node'dan itibaren anahtari probe'u gecmeyen son dugum
+#define DEFINE_LIST_KERNELS(name, Type, key, order)                                        \
+    static inline Type* name##Merge(Type* a, Type* b) {                                   \
+        Type* result;                                                                     \
+        Type** link = &result;                                                            \
+        while (a != NULL && b != NULL) {                                                  \
+            if ((order) * key(b, a) < 0) {                                                \
+                *link = b;                                                                \
+                link = &b->next;                                                          \
+                b = b->next;                                                              \
+            } else {                                                                      \
+                *link = a;                                                                \
+                link = &a->next;                                                          \
+                a = a->next;                                                              \
+            }                                                                             \
+        }                                                                                 \
+        *link = a != NULL ? a : b;                                                        \
+        return result;                                                                    \
+    }                                                                                     \
+                                                                                          \
+    static inline void name##Sort(Type** head) {                                          \
+        Type* runs[64] = { NULL }; /* runs[i]: 2^i uzunlugunda sirali parca ya da bos */  \
+        int used = 0;                                                                     \
+        Type* node = *head;                                                               \
+        while (node != NULL) {                                                            \
+            Type* run = node;                                                             \
+            node = node->next;                                                            \
+            run->next = NULL;                                                             \
+            int i = 0;                                                                    \
+            for (; i < used && runs[i] != NULL; i++) {                                    \
+                run = name##Merge(runs[i], run); /* eski parca solda: kararlilik */       \
+                runs[i] = NULL;                                                           \
+            }                                                                             \
+            if (i == used) used++;                                                        \
+            runs[i] = run;                                                                \
+        }                                                                                 \
+        Type* result = NULL;                                                              \
+        for (int i = 0; i < used; i++) {                                                  \
+            if (runs[i] != NULL) result = result ? name##Merge(runs[i], result) : runs[i];\
+        }                                                                                 \
+        *head = result;                                                                   \
+    }                                                                                     \
+                                                                                          \
+    static inline void name##SortArray(Type** items, size_t count) {                      \
+        /* 16'lik parcalar eklemeli siralanir, sonra ikiser ikiser birlestirilir */       \
+        for (size_t start = 0; start < count; start += 16) {                              \
+            size_t end = count - start < 16 ? count : start + 16;                         \
+            for (size_t i = start + 1; i < end; i++) {                                    \
+                Type* item = items[i];                                                    \
+                size_t j = i;                                                             \
+                for (; j > start && (order) * key(item, items[j - 1]) < 0; j--) {         \
+                    items[j] = items[j - 1];                                              \
+                }                                                                         \
+                items[j] = item;                                                          \
+            }                                                                             \
+        }                                                                                 \
+        if (count <= 16) return;                                                          \
+        Type** scratch = (Type**)safeMalloc(count * sizeof(Type*));                       \
+        Type** from = items;                                                              \
+        Type** to = scratch;                                                              \
+        for (size_t width = 16; width < count; width *= 2) {                              \
+            for (size_t left = 0; left < count; left += 2 * width) {                      \
+                size_t middle = left + width < count ? left + width : count;              \
+                size_t right = middle + width < count ? middle + width : count;           \
+                size_t i = left, j = middle, k = left;                                    \
+                while (i < middle && j < right) {                                         \
+                    to[k++] = (order) * key(from[j], from[i]) < 0 ? from[j++] : from[i++];\
+                }                                                                         \
+                while (i < middle) to[k++] = from[i++];                                   \
+                while (j < right) to[k++] = from[j++];                                    \
+            }                                                                             \
+            Type** swap = from;                                                           \
+            from = to;                                                                    \
+            to = swap;                                                                    \
+        }                                                                                 \
+        if (from != items) memcpy(items, from, count * sizeof(Type*));                    \
+        free(scratch);                                                                    \
+    }                                                                                     \
+                                                                                          \
+    static inline Type** name##InsertLink(Type** link, const Type* probe) {               \
+        while (*link != NULL && (order) * key(*link, probe) <= 0) {                       \
+            link = &(*link)->next;                                                        \
+        }                                                                                 \
+        return link;                                                                      \
+    }                                                                                     \
+                                                                                          \
+    static inline Type* name##LowerBound(Type* node, const Type* probe) {                 \
+        while (node != NULL && (order) * key(node, probe) < 0) {                          \
+            node = node->next;                                                            \
+        }                                                                                 \
+        return node;                                                                      \
+    }                                                                                     \
+                                                                                          \
+    static inline Type* name##LastAtOrBefore(Type* node, const Type* probe) {             \
+        while (node->next != NULL && (order) * key(node->next, probe) <= 0) {             \
+            node = node->next;                                                            \
+        }                                                                                 \
+        return node;                                                                      \
+    }
+
+DEFINE_LIST_KERNELS(shipmentsByDate, Shipment, shipmentDateKey, SORT_ASCENDING)
+DEFINE_LIST_KERNELS(shipmentsByDateID, Shipment, shipmentDateIDKey, SORT_ASCENDING)
+DEFINE_LIST_KERNELS(shipmentsByDateIDDescending, Shipment, shipmentDateIDKey, SORT_DESCENDING)
+DEFINE_LIST_KERNELS(shipmentsByID, Shipment, shipmentIDKey, SORT_ASCENDING)
+DEFINE_LIST_KERNELS(shipmentsByIDDescending, Shipment, shipmentIDKey, SORT_DESCENDING)
+DEFINE_LIST_KERNELS(shipmentsByDelivery, Shipment, shipmentDeliveryKey, SORT_ASCENDING)
+DEFINE_LIST_KERNELS(shipmentsByDeliveryDescending, Shipment, shipmentDeliveryKey, SORT_DESCENDING)
+DEFINE_LIST_KERNELS(queueByDelivery, PriorityQueueNode, queueDeliveryKey, SORT_ASCENDING)
+
 int isValidName(const char* name, int length) {
     return strlen(name) < length && strlen(name) > 0; // 50 karakterlik sinir
 }
@@ -149,53 +667,528 @@ void* safeMalloc(size_t size) {
     return ptr;
 }
 
+void* safeRealloc(void* ptr, size_t size) {
+    void* newPtr = realloc(ptr, size);
+    if (newPtr == NULL) {
+        printf("Bellek tahsisi basarisiz oldu.\n");
+        exit(EXIT_FAILURE); // Programi guvenli sekilde sonlandir
+    }
+    return newPtr;
+}
+
 void printError(const char* message) {
+    if (quietMode) return;
     printf("Hata: %s\n", message);
 }
 
+void printInfo(const char* format, ...) {
+    if (quietMode) return;
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+// Izleme (Tracing)
+//
+// -DKARGO_TRACE ile derlenince islemlerin icindeki asamalar TRACE_SPAN ile
+// isaretlenir. Bir span bulundugu blogun sonuna kadar surer (GCC/Clang
+// cleanup ozniteligi). Makro bir degisken tanimi ve bir if deyimine acildigi
+// icin yalnizca blok icinde tek basina bir deyim olarak yazilabilir:
+// "if (x) TRACE_SPAN(...);" ya da dogrudan bir etiketten ("case 1:") sonra
+// kullanim derlenmez; once { } acilmalidir. Calisma zamaninda
+// --trace <dosya> verilmediyse span traceEnabled'i bir kez okuyup kendi
+// kopyasina yazar; acilis ve bitis yalnizca bu kopyayi sinar. Kapali yolda
+// tek karar budur ve hep ayni yone gider (acilis ve bitis ayni degeri gorur).
+// Verildiyse her span bittiginde tek bir tam olay ("ph":"X") o is
+// parcaciginin halkasina yazilir. Halkayi yalnizca sahibi yazar, bu yuzden
+// kilit yoktur; dolunca en eski olaylarin uzerine yazilir. Cikista tum
+// halkalar Chrome trace-event JSON olarak dosyaya dokulur (chrome://tracing
+// veya Perfetto ile alev grafigi olarak acilir). Makro KARGO_TRACE olmadan
+// bos tanimlanir; izleme kodu hic derlenmez.
+#ifdef KARGO_TRACE
+#define TRACE_RING_EVENTS 65536 // Is parcacigi basina (2'nin kuvveti)
+
+typedef struct TraceEvent {
+    const char* name;
+    uint64_t start;    // ns, CLOCK_MONOTONIC
+    uint64_t duration; // ns
+} TraceEvent;
+
+typedef struct TraceRing {
+    TraceEvent events[TRACE_RING_EVENTS];
+    uint64_t head;            // Yazilan toplam olay (release ile yayinlanir)
+    int threadIndex;
+    struct TraceRing* next;   // Tum halkalarin listesi (kilitsiz basa ekleme)
+} TraceRing;
+
+typedef struct TraceSpan {
+    const char* name;
+    uint64_t start;
+    int enabled; // Acilistaki traceEnabled kopyasi; bitis de bunu sinar
+} TraceSpan;
+
+int traceEnabled = 0;
+const char* tracePath = NULL;
+TraceRing* traceRings = NULL;
+int traceThreadCount = 0;
+_Thread_local TraceRing* traceRing = NULL;
+
+static inline uint64_t traceNow() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+// Is parcaciginin ilk olayinda halkasini ayirir ve listeye ekler
+TraceRing* attachTraceRing() {
+    TraceRing* ring = (TraceRing*)safeMalloc(sizeof(TraceRing));
+    ring->head = 0;
+    ring->threadIndex = __atomic_add_fetch(&traceThreadCount, 1, __ATOMIC_RELAXED);
+    ring->next = __atomic_load_n(&traceRings, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&traceRings, &ring->next, ring, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    }
+    traceRing = ring;
+    return ring;
+}
+
+__attribute__((noinline)) void beginTraceSpanSlow(TraceSpan* span) {
+    if (traceRing == NULL) attachTraceRing();
+    span->start = traceNow();
+}
+
+__attribute__((noinline)) void endTraceSpanSlow(TraceSpan* span) {
+    uint64_t end = traceNow();
+    TraceRing* ring = traceRing;
+    TraceEvent* event = &ring->events[ring->head & (TRACE_RING_EVENTS - 1)];
+    event->name = span->name;
+    event->start = span->start;
+    event->duration = end - span->start;
+    __atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+}
+
+static inline void endTraceSpan(TraceSpan* span) {
+    if (__builtin_expect(span->enabled, 0)) endTraceSpanSlow(span);
+}
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SPAN(spanName)                                                                  \
+    TraceSpan TRACE_CONCAT(traceSpan, __LINE__) __attribute__((cleanup(endTraceSpan))) = { spanName, 0, traceEnabled }; \
+    if (__builtin_expect(TRACE_CONCAT(traceSpan, __LINE__).enabled, 0)) beginTraceSpanSlow(&TRACE_CONCAT(traceSpan, __LINE__))
+
+// JSON metni icin kacis (span adlari sabit metinlerdir, yine de korunur)
+void writeTraceName(FILE* file, const char* name) {
+    for (; *name; name++) {
+        if (*name == '"' || *name == '\\') fputc('\\', file);
+        fputc(*name, file);
+    }
+}
+
+// Tum halkalardaki olaylari Chrome trace-event bicimde yazar; yazilan olay sayisini doner
+long writeTraceFile(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        printError("Izleme dosyasi acilamadi.");
+        return -1;
+    }
+
+    uint64_t origin = UINT64_MAX;
+    for (TraceRing* ring = __atomic_load_n(&traceRings, __ATOMIC_ACQUIRE); ring != NULL; ring = ring->next) {
+        uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        uint64_t first = head > TRACE_RING_EVENTS ? head - TRACE_RING_EVENTS : 0;
+        for (uint64_t i = first; i < head; i++) {
+            uint64_t start = ring->events[i & (TRACE_RING_EVENTS - 1)].start;
+            if (start < origin) origin = start;
+        }
+    }
+
+    long written = 0, dropped = 0;
+    int pid = (int)getpid();
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    for (TraceRing* ring = __atomic_load_n(&traceRings, __ATOMIC_ACQUIRE); ring != NULL; ring = ring->next) {
+        uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        uint64_t first = head > TRACE_RING_EVENTS ? head - TRACE_RING_EVENTS : 0;
+        dropped += (long)first;
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+                "\"args\":{\"name\":\"is parcacigi %d\"}}", written > 0 ? ",\n" : "", pid, ring->threadIndex,
+                ring->threadIndex);
+        written++;
+        for (uint64_t i = first; i < head; i++) {
+            const TraceEvent* event = &ring->events[i & (TRACE_RING_EVENTS - 1)];
+            fprintf(file, ",\n{\"name\":\"");
+            writeTraceName(file, event->name);
+            fprintf(file, "\",\"cat\":\"kargo\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d}",
+                    (event->start - origin) / 1000.0, event->duration / 1000.0, pid, ring->threadIndex);
+            written++;
+        }
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    if (dropped > 0) {
+        printInfo("Izleme halkasi dolu: en eski %ld olay yazilamadi.\n", dropped);
+    }
+    return written;
+}
+
+void flushTraceAtExit() {
+    if (tracePath != NULL) {
+        long written = writeTraceFile(tracePath);
+        if (written >= 0) fprintf(stderr, "%ld izleme kaydi %s dosyasina yazildi.\n", written, tracePath);
+    }
+}
+#else
+#define TRACE_SPAN(spanName) do { } while (0)
+#endif
+
+// Anlik Goruntu (Snapshot) Okumalari
+//
+// Tek bir yazici ve kilit almayan okuyucular icin surumleme:
+// - Yazici her degisiklikte yeni dugumleri commitVersion + 1 ile damgalar,
+//   dugumu release ile yayinlar ve ardindan commitVersion'i artirir.
+// - Okuyucu, beginSnapshotRead ile o anki commitVersion'i kendi yuvasina yazar
+//   ve yalnizca bu surume kadar dogmus (ve henuz olmemis) dugumleri gorur.
+// - Kuyruk/stack basindan cikarilan dugumler hemen serbest birakilmaz; eski
+//   goruntuye sahip okuyucular bitene kadar zincirin basinda "olu" kalir.
+// - Zincirden ayrilan veya silinen bellek, o anda aktif olan tum okuyucular
+//   cikana kadar bekleme listesinde tutulur (grace period).
+//
+// Surumler 32 bittir; karsilastirmalar isaretli fark ile yapildigindan
+// sarmalama (wrap-around) guvenlidir. 0 surumu "yok/canli" anlamina gelir.
+#define SNAPSHOT_MAX_READERS 64
+
+#define publishPointer(field, value) __atomic_store_n(&(field), (value), __ATOMIC_RELEASE)
+#define readPointer(field) __atomic_load_n(&(field), __ATOMIC_ACQUIRE)
+
+typedef struct ReaderSlot {
+    uint32_t snapshot;  // Aktif okuyucunun goruntu surumu (0 = pasif)
+    uint32_t inUse;     // Yuva bir is parcacigina atanmis mi
+    uint64_t exits;     // Okuma bolumunden cikis sayaci
+    char padding[48];   // Yuvalar ayri onbellek satirlarinda
+} ReaderSlot;
+
+// Bekleme listesi: aktif okuyucular cikinca serbest birakilacak bellek
+typedef struct RetiredBatch {
+    void** items;
+    int count;
+    int capacity;
+    uint64_t waitExits[SNAPSHOT_MAX_READERS]; // Muhurlendigi andaki cikis sayaclari
+    uint32_t waitMask[SNAPSHOT_MAX_READERS / 32];
+    struct RetiredBatch* next;
+} RetiredBatch;
+
+ReaderSlot readerSlots[SNAPSHOT_MAX_READERS];
+uint32_t commitVersion = 1;
+uint32_t writeVersion = 1;
+
+_Thread_local int readerSlotIndex = -1;
+_Thread_local uint32_t readerSnapshot = 0; // 0: okuma bolumu disinda, her sey gorunur
+_Thread_local int readerDepth = 0;
+
+RetiredBatch* openRetiredBatch = NULL;
+RetiredBatch* sealedRetiredBatches = NULL;
+
+// Ornek: surumu a olan bir degisiklik b goruntusunde gorunur mu
+int versionAtOrBefore(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) <= 0;
+}
+
+// Dugum okuyucunun goruntusunde var mi (writer ve okuma bolumu disi: her zaman)
+int isVisible(uint32_t born, uint32_t died) {
+    if (readerSnapshot == 0) {
+        return died == 0;
+    }
+    return versionAtOrBefore(born, readerSnapshot) && (died == 0 || !versionAtOrBefore(died, readerSnapshot));
+}
+
+uint32_t beginWrite() {
+    writeVersion = commitVersion + 1;
+    if (writeVersion == 0) writeVersion = 1;
+    return writeVersion;
+}
+
+void commitWrite() {
+    __atomic_store_n(&commitVersion, writeVersion, __ATOMIC_SEQ_CST);
+}
+
+// Dugum damgalamayan degisiklikler (cikarma, yer degistirme, diske tasima)
+// sonrasinda cagrilir; surumle dogrulanan disa aktarim ipuclari gecersizlesir.
+void bumpCommitVersion() {
+    beginWrite();
+    commitWrite();
+}
+
+int acquireReaderSlot() {
+    for (int i = 0; i < SNAPSHOT_MAX_READERS; i++) {
+        uint32_t expected = 0;
+        if (__atomic_compare_exchange_n(&readerSlots[i].inUse, &expected, 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+            return i;
+        }
+    }
+    printf("Okuyucu yuvasi kalmadi (en fazla %d).\n", SNAPSHOT_MAX_READERS);
+    exit(EXIT_FAILURE);
+}
+
+// Okuma bolumunu baslatir; ic ice cagrilabilir
+void beginSnapshotRead() {
+    if (readerDepth++ > 0) {
+        return;
+    }
+    if (readerSlotIndex < 0) {
+        readerSlotIndex = acquireReaderSlot();
+    }
+
+    ReaderSlot* slot = &readerSlots[readerSlotIndex];
+    uint32_t snapshot;
+    do {
+        // Yazici yuvayi gormeden ilerlediyse goruntuyu tazele
+        snapshot = __atomic_load_n(&commitVersion, __ATOMIC_SEQ_CST);
+        __atomic_store_n(&slot->snapshot, snapshot, __ATOMIC_SEQ_CST);
+    } while (__atomic_load_n(&commitVersion, __ATOMIC_SEQ_CST) != snapshot);
+    readerSnapshot = snapshot;
+}
+
+void endSnapshotRead() {
+    if (--readerDepth > 0) {
+        return;
+    }
+    ReaderSlot* slot = &readerSlots[readerSlotIndex];
+    __atomic_store_n(&slot->snapshot, 0, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&slot->exits, 1, __ATOMIC_SEQ_CST);
+    readerSnapshot = 0;
+}
+
+// Is parcacigi sonlanirken yuvasini birakir
+void releaseReaderSlot() {
+    if (readerSlotIndex >= 0) {
+        __atomic_store_n(&readerSlots[readerSlotIndex].inUse, 0, __ATOMIC_SEQ_CST);
+        readerSlotIndex = -1;
+    }
+}
+
+// Aktif okuyucularin en eski goruntusu (okuyucu yoksa commitVersion)
+uint32_t oldestActiveSnapshot() {
+    uint32_t oldest = __atomic_load_n(&commitVersion, __ATOMIC_SEQ_CST);
+    for (int i = 0; i < SNAPSHOT_MAX_READERS; i++) {
+        uint32_t snapshot = __atomic_load_n(&readerSlots[i].snapshot, __ATOMIC_SEQ_CST);
+        if (snapshot != 0 && !versionAtOrBefore(oldest, snapshot)) {
+            oldest = snapshot;
+        }
+    }
+    return oldest;
+}
+
+// Bellegi, su an aktif olan okuyucular cikana kadar bekletir
+void retireMemory(void* pointer) {
+    if (openRetiredBatch == NULL) {
+        openRetiredBatch = (RetiredBatch*)safeMalloc(sizeof(RetiredBatch));
+        memset(openRetiredBatch, 0, sizeof(RetiredBatch));
+    }
+    RetiredBatch* batch = openRetiredBatch;
+    if (batch->count == batch->capacity) {
+        batch->capacity = batch->capacity ? batch->capacity * 2 : 64;
+        batch->items = (void**)safeRealloc(batch->items, batch->capacity * sizeof(void*));
+    }
+    batch->items[batch->count++] = pointer;
+}
+
+void freeRetiredBatch(RetiredBatch* batch) {
+    for (int i = 0; i < batch->count; i++) {
+        if (isSpilledHistory(batch->items[i])) {
+            releaseRetiredSpillExtent(batch->items[i]); // Dosya araligi da bosalir
+        } else {
+            free(batch->items[i]);
+        }
+    }
+    free(batch->items);
+    free(batch);
+}
+
+// Acik partiyi muhurler ve beklemesi biten partileri serbest birakir
+void reclaimRetiredMemory() {
+    if (openRetiredBatch != NULL) {
+        RetiredBatch* batch = openRetiredBatch;
+        openRetiredBatch = NULL;
+        // Bellegi zincirden ayiran publishPointer yalnizca release'tir; tam bariyer
+        // olmadan yuva okumalari ondan once yapilabilir (StoreLoad). Okuyucu tarafi
+        // beginSnapshotRead'deki seq_cst yuva yazimi + commitVersion okumasidir:
+        // ya yazici yuvayi dolu gorup partiyi bekletir ya da okuyucu yeni
+        // zincir basini gorur ve ayrilan bellege hic ulasamaz.
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        for (int i = 0; i < SNAPSHOT_MAX_READERS; i++) {
+            if (__atomic_load_n(&readerSlots[i].snapshot, __ATOMIC_SEQ_CST) != 0) {
+                batch->waitMask[i / 32] |= 1u << (i % 32);
+                batch->waitExits[i] = __atomic_load_n(&readerSlots[i].exits, __ATOMIC_SEQ_CST);
+            }
+        }
+        batch->next = sealedRetiredBatches;
+        sealedRetiredBatches = batch;
+    }
+
+    RetiredBatch** link = &sealedRetiredBatches;
+    while (*link != NULL) {
+        RetiredBatch* batch = *link;
+        int waiting = 0;
+        for (int i = 0; i < SNAPSHOT_MAX_READERS && !waiting; i++) {
+            if ((batch->waitMask[i / 32] & (1u << (i % 32))) &&
+                __atomic_load_n(&readerSlots[i].exits, __ATOMIC_SEQ_CST) == batch->waitExits[i]) {
+                waiting = 1; // Bu okuyucu hala ayni okuma bolumunde
+            }
+        }
+        if (waiting) {
+            link = &batch->next;
+        } else {
+            *link = batch->next;
+            freeRetiredBatch(batch);
+        }
+    }
+}
+
+// Kuyruk ve stack zincirlerinin basindaki, hicbir okuyucunun artik goremeyecegi
+// olu dugumleri zincirden ayirir ve bekleme listesine ekler
+void reclaimSnapshots() {
+    uint32_t horizon = oldestActiveSnapshot();
+
+    PriorityQueueNode* queueHead = priorityQueueChain;
+    while (queueHead != priorityQueue && versionAtOrBefore(queueHead->died, horizon)) {
+        PriorityQueueNode* dead = queueHead;
+        queueHead = queueHead->next;
+        retireMemory(dead);
+        trackMemory(MEMORY_QUEUE, -(long)sizeof(PriorityQueueNode));
+    }
+    if (queueHead != priorityQueueChain) {
+        publishPointer(priorityQueueChain, queueHead);
+        if (queueHead == priorityQueue) priorityQueueDeadTail = NULL;
+    }
+
+    ShipmentStackNode* stackHead = shipmentStackChain;
+    while (stackHead != shipmentStack && versionAtOrBefore(stackHead->died, horizon)) {
+        ShipmentStackNode* dead = stackHead;
+        stackHead = stackHead->next;
+        retireMemory(dead);
+        trackMemory(MEMORY_STACK, -(long)sizeof(ShipmentStackNode));
+    }
+    if (stackHead != shipmentStackChain) {
+        publishPointer(shipmentStackChain, stackHead);
+        if (stackHead == shipmentStack) shipmentStackDeadTail = NULL;
+    }
+
+    // Yukaridaki yayinlar ile yuva taramasi arasindaki bariyer reclaimRetiredMemory'de
+    reclaimRetiredMemory();
+}
+
+// Program sonunda bekleyen tum bellegi serbest birakir (okuyucu kalmamis olmali)
+void freeRetiredMemory() {
+    reclaimRetiredMemory();
+    while (sealedRetiredBatches != NULL) {
+        RetiredBatch* batch = sealedRetiredBatches;
+        sealedRetiredBatches = batch->next;
+        freeRetiredBatch(batch);
+    }
+}
+
 void freePriorityQueue() {
-    while (priorityQueue != NULL) {
-        PriorityQueueNode* temp = priorityQueue;
-        priorityQueue = priorityQueue->next;
+    // Olu dugumler de zincirde oldugundan zincir basindan serbest birak
+    while (priorityQueueChain != NULL) {
+        PriorityQueueNode* temp = priorityQueueChain;
+        priorityQueueChain = priorityQueueChain->next;
         free(temp);
     }
+    priorityQueue = NULL;
+    priorityQueueDeadTail = NULL;
+    memset(queueBucketTails, 0, sizeof(queueBucketTails));
+    memset(queueBucketMask, 0, sizeof(queueBucketMask));
+    freeShipmentIDFilter(&queueIDFilter);
+    memoryUsage[MEMORY_QUEUE] = 0;
 }
 
+// Ozyinelemesiz: dugumun cocuk zinciri kardeslerinin onune eklenir, boylece
+// agac tek bir zincir gibi bosaltilir (derin zincirlerde yigin tasmaz).
+// Her cocuk zinciri bir kez yurundugunden toplam sure dugum sayisiyla dogrusaldir.
 void freeCityTree(CityNode* node) {
-    if (node == NULL) return;
-    freeCityTree(node->child);
-    freeCityTree(node->sibling);
-    free(node);
+    while (node != NULL) {
+        CityNode* next = node->sibling;
+        if (node->child != NULL) {
+            CityNode* last = node->child;
+            while (last->sibling != NULL) last = last->sibling;
+            last->sibling = next;
+            next = node->child;
+        }
+        free(node);
+        trackMemory(MEMORY_CITIES, -(long)sizeof(CityNode));
+        node = next;
+    }
+}
+
+void freeCityIndex(CityIndex* index) {
+    if (index->pages == NULL) {
+        return;
+    }
+    for (int i = 0; i < CITY_INDEX_PAGES; i++) {
+        free(index->pages[i]);
+    }
+    free(index->pages);
+    trackMemory(MEMORY_CITIES, -(long)CITY_INDEX_PAGES * (long)sizeof(CityIndexEntry*)
+                               - (long)index->pageCount * CITY_INDEX_PAGE_SIZE * (long)sizeof(CityIndexEntry));
+    index->pages = NULL;
+    index->pageCount = 0;
 }
 
 void freeShipmentStack() {
-    while (shipmentStack != NULL) {
-        ShipmentStackNode* temp = shipmentStack;
-        shipmentStack = shipmentStack->next;
+    while (shipmentStackChain != NULL) {
+        ShipmentStackNode* temp = shipmentStackChain;
+        shipmentStackChain = shipmentStackChain->next;
         free(temp);
     }
+    shipmentStack = NULL;
+    shipmentStackDeadTail = NULL;
+    freeShipmentIDFilter(&stackIDFilter);
+    memoryUsage[MEMORY_STACK] = 0;
 }
 
 void freeCustomerList() {
     while (customerList != NULL) {
         Customer* temp = customerList;
         customerList = customerList->next;
+        freeShipmentHistory(temp->shipmentHistory);
+    }
 
-        Shipment* shipment = temp->shipmentHistory;
-        while (shipment != NULL) {
-            Shipment* tempShipment = shipment;
-            shipment = shipment->next;
-            free(tempShipment);
-        }
+    // Musteri kayitlari bloklarla birlikte serbest birakilir
+    while (customerBlocks != NULL) {
+        CustomerBlock* temp = customerBlocks;
+        customerBlocks = customerBlocks->next;
         free(temp);
     }
+
+    free(namePool.data);
+    free(namePool.slots);
+    memset(&namePool, 0, sizeof(namePool));
+    freeNameIndex();
+    freeArchive();
+    free(customerTable);
+    customerTable = NULL;
+    free(customerShipmentCounts);
+    customerShipmentCounts = NULL;
+    free(customerLastAccess);
+    customerLastAccess = NULL;
+    pinnedCustomer = NULL;
+    customerTableCapacity = 0;
+    memoryUsage[MEMORY_CUSTOMERS] = 0;
+    memoryUsage[MEMORY_HISTORIES] = 0;
+    bumpCommitVersion(); // Eski dugumlere isaret eden disa aktarim ipuclari gecersizlesir
 }
 
 void cleanup() {
+    freeOpLog();
     freePriorityQueue();
     freeCityTree(root);
+    freeCityIndex(&cityIndex);
     freeShipmentStack();
     freeCustomerList();
+    freeRollups();
+    freeHubQueues();
+    freeRetiredMemory();
+    freeSpillSegment();
 }
 
 // Menu yapisi
@@ -228,8 +1221,21 @@ void menu() {
 		printf("18. Gonderim gecmisindeki toplam kargo sayisini hesapla\n");
 		printf("19. Sehirleri alfabetik sirayla yazdir\n");
 		printf("20. En kisa teslimat suresini hesapla\n");
-		printf("---\n");
         printf("21. Cikis\n");
+		printf("---\n");
+		printf("22. Soyada gore musteri ara\n");
+		printf("23. Eski teslim edilmis kargolari arsivle\n");
+		printf("24. CSV dosyasindan toplu aktar\n");
+		printf("25. Gonderi durumunu guncelle\n");
+		printf("26. Gunluk teslimat ozetleri\n");
+		printf("---\n");
+		printf("27. Hub kuyruguna kargo ekle\n");
+		printf("28. Hub kuyruklarini paralel isle\n");
+		printf("---\n");
+		printf("29. Bellek kullanimi\n");
+		printf("30. Gonderim gecmislerini disa aktar (CSV/JSON)\n");
+		printf("31. Gonderim gecmisini sirala (tarih/ID/sure, tarih araligi)\n");
+		printf("32. Toplu islem (baslat/tamamla/iptal/geri al/yinele)\n");
         printf("Seciminiz: ");
         scanf("%d", &choice);
 
@@ -461,7 +1467,8 @@ void menu() {
 					break;
 				}
 
-				Shipment* result = searchDeliveredShipments(customer->shipmentHistory, searchDate);
+				Shipment scratch;
+				Shipment* result = searchDeliveredShipments(customer, searchDate, &scratch);
 				if (result) {
 					printf("Teslim edilmis kargo bulundu: ID: %d, Tarih: %s, Durum: %s\n",
 					   result->shipmentID, result->date, result->status);
@@ -486,16 +1493,27 @@ void menu() {
 					break;
 				}
 
-				mergeSortShipments(&customer->shipmentHistory);
+				// Gecmis tarih sirasini korusun ve okuyucular etkilenmesin diye
+				// teslim edilmeyenlerin kopyasi siralanir
+				Shipment* undelivered = NULL;
+				for (Shipment* s = customerHistory(customer); s != NULL; s = s->next) {
+					if (strcmp(s->status, "Teslim Edilmedi") == 0) {
+						Shipment* copy = (Shipment*)safeMalloc(sizeof(Shipment));
+						*copy = *s;
+						copy->next = undelivered;
+						undelivered = copy;
+					}
+				}
+
+				shipmentsByDeliverySort(&undelivered);
 
 				printf("Teslim edilmeyen kargolar siralandi:\n");
-				Shipment* current = customer->shipmentHistory;
-				while (current) {
-					if (strcmp(current->status, "Teslim Edilmedi") == 0) {
-						printf("ID: %d, Tarih: %s, Durum: %s, Teslim Suresi: %d\n",
-						   current->shipmentID, current->date, current->status, current->deliveryTime);
-					}
-					current = current->next;
+				while (undelivered) {
+					Shipment* current = undelivered;
+					printf("ID: %d, Tarih: %s, Durum: %s, Teslim Suresi: %d\n",
+					   current->shipmentID, current->date, current->status, current->deliveryTime);
+					undelivered = current->next;
+					free(current);
 				}
 				break;
 			}
@@ -522,7 +1540,7 @@ void menu() {
 				if (customer == NULL) {
 					printf("Musteri bulunamadi.\n");
 				} else {
-					printf("Gonderim gecmisindeki toplam kargo sayisi: %d\n", countShipments(customer->shipmentHistory));
+					printf("Gonderim gecmisindeki toplam kargo sayisi: %d\n", countCustomerShipments(customer));
 				}
 				break;
 			}
@@ -540,220 +1558,1134 @@ void menu() {
 				}
 				break;
 			}
-			case 21:
+			case 22: {
+				char lastName[50], mode[4];
+				Customer* page[10];
+				int prefix, offset = 0, total = 0;
+
+				printf("Soyad (veya soyad oneki): ");
+				scanf("%s", lastName);
+
+				if (!isValidName(lastName, 50)) {
+					printError("Soyad 50 karakterden kisa olmalidir ve bos olmamalidir.");
+					break;
+				}
+
+				printf("Onek aramasi mi? (e/h): ");
+				scanf("%3s", mode);
+				prefix = (mode[0] == 'e' || mode[0] == 'E');
+
+				while (1) {
+					int count = searchCustomersByName(lastName, NULL, prefix, offset, 10, page, &total);
+					if (total == 0) {
+						printf("Eslesen musteri bulunamadi.\n");
+						break;
+					}
+
+					printf("Sonuclar %d-%d / %d:\n", offset + 1, offset + count, total);
+					for (int i = 0; i < count; i++) {
+						printf("  Musteri ID: %d, Ad: %s, Soyad: %s\n", page[i]->customerID,
+							   customerFirstName(page[i]), customerLastName(page[i]));
+					}
+
+					offset += count;
+					if (offset >= total) break;
+
+					printf("Sonraki sayfa? (e/h): ");
+					scanf("%3s", mode);
+					if (mode[0] != 'e' && mode[0] != 'E') break;
+				}
+				break;
+			}
+			case 23: {
+				char cutoffDate[11];
+				size_t freedBytes = 0, archivedBytes = 0;
+				printf("Bu tarihten eski teslim edilmis kargolar arsivlenecek (YYYY-MM-DD): ");
+				scanf("%10s", cutoffDate);
+
+				if (!isValidDate(cutoffDate)) {
+					printError("Gecersiz tarih formati. YYYY-MM-DD seklinde giriniz.");
+					break;
+				}
+
+				long archived = archiveDeliveredShipments(cutoffDate, &freedBytes, &archivedBytes);
+				printf("%ld gonderi arsivlendi (%zu bayt -> %zu bayt).\n", archived, freedBytes, archivedBytes);
+				break;
+			}
+			case 24: {
+				char path[256];
+				long importedCustomers, importedShipments;
+				printf("CSV dosya yolu: ");
+				scanf("%255s", path);
+
+				int errors = importCsvFile(path, defaultThreadCount(), &importedCustomers, &importedShipments);
+				if (errors >= 0) {
+					printf("%ld musteri ve %ld gonderi aktarildi, %d satir hatali.\n",
+						   importedCustomers, importedShipments, errors);
+				}
+				break;
+			}
+			case 25: {
+				int customerID, shipmentID;
+				char status[20];
+				printf("Musteri ID: ");
+				scanf("%d", &customerID);
+				printf("Gonderi ID: ");
+				scanf("%d", &shipmentID);
+				printf("Yeni durum: ");
+				scanf(" %19[^\n]", status);
+
+				if (!isValidName(status, 20)) {
+					printError("Durum bilgisi 20 karakterden kisa olmalidir ve bos olmamalidir.");
+					break;
+				}
+
+				if (updateShipmentStatus(customerID, shipmentID, status)) {
+					printf("Gonderi %d durumu '%s' olarak guncellendi.\n", shipmentID, status);
+				} else {
+					printf("Gonderi bulunamadi (arsivdeki gonderiler guncellenemez).\n");
+				}
+				break;
+			}
+			case 26: {
+				int dayCount;
+				printf("Kac gun geriye (en yeni gonderi gunune kadar): ");
+				scanf("%d", &dayCount);
+
+				if (!isPositiveNumber(dayCount) || dayCount > ROLLUP_MAX_QUERY_DAYS) {
+					printf("Gun sayisi 1-%d arasinda olmalidir.\n", ROLLUP_MAX_QUERY_DAYS);
+					break;
+				}
+				displayDailyRollups(dayCount);
+				break;
+			}
+			case 27: {
+				int cityID, shipmentID, deliveryTime;
+				char status[20];
+				printf("Hedef sehir ID: ");
+				scanf("%d", &cityID);
+				printf("Kargo ID: ");
+				scanf("%d", &shipmentID);
+				printf("Teslim Suresi (gun): ");
+				scanf("%d", &deliveryTime);
+				printf("Durum (Isleme Alindi/Teslimatta/Teslim Edildi): ");
+				scanf("%s", status);
+
+				if (!isPositiveNumber(shipmentID) || !isPositiveNumber(deliveryTime)) {
+					printError("Kargo ID ve teslim suresi pozitif olmalidir.");
+					break;
+				}
+				if (!isValidName(status, 20)) {
+					printError("Durum bilgisi 20 karakterden kisa olmalidir ve bos olmamalidir.");
+					break;
+				}
+
+				if (enqueueHubParcel(cityID, shipmentID, deliveryTime, status)) {
+					printf("Kargo ID %d, sehir %d kuyruguna eklendi.\n", shipmentID, cityID);
+				} else {
+					printf("Sehir ID %d bulunamadi.\n", cityID);
+				}
+				break;
+			}
+			case 28: {
+				long drained = drainHubQueues(defaultThreadCount(), printHubParcel, NULL);
+				printf("%ld kargo %d isciyle islendi.\n", drained, defaultThreadCount());
+				displayHubQueues();
+				break;
+			}
+			case 29: {
+				displayMemoryUsage();
+				break;
+			}
+			case 30: {
+				int customerID, formatChoice;
+				long limit;
+				char path[256], token[48];
+				printf("Musteri ID (0 = tum musteriler): ");
+				scanf("%d", &customerID);
+				printf("Bicim (1 = CSV, 2 = JSON lines): ");
+				scanf("%d", &formatChoice);
+				printf("Dosya ('-' = ekran): ");
+				scanf("%255s", path);
+				printf("En fazla kayit (0 = hepsi): ");
+				scanf("%ld", &limit);
+				printf("Devam anahtari ('-' = bastan): ");
+				scanf("%47s", token);
+
+				if (customerID < 0 || (formatChoice != 1 && formatChoice != 2) || limit < 0) {
+					printError("Gecersiz disa aktarim secenekleri.");
+					break;
+				}
+				ExportCursor cursor;
+				if (!parseExportToken(&cursor, strcmp(token, "-") == 0 ? NULL : token, customerID)) {
+					printError("Devam anahtari gecersiz.");
+					break;
+				}
+				long written = exportToFile(path, formatChoice == 1 ? EXPORT_CSV : EXPORT_JSONL, limit, &cursor);
+				if (written < 0) {
+					break;
+				}
+				printf("%ld gonderi disa aktarildi.\n", written);
+				if (cursor.customerID != 0) {
+					formatExportToken(&cursor, token, sizeof(token));
+					printf("Devam anahtari: %s\n", token);
+				}
+				break;
+			}
+			case 31: {
+				int customerID, keyChoice, orderChoice;
+				char fromDate[11], toDate[11];
+				printf("Musteri ID: ");
+				scanf("%d", &customerID);
+				printf("Siralama anahtari (1 = tarih, 2 = gonderi ID, 3 = teslim suresi): ");
+				scanf("%d", &keyChoice);
+				printf("Yon (1 = artan, 2 = azalan): ");
+				scanf("%d", &orderChoice);
+				printf("Baslangic tarihi ('-' = sinirsiz): ");
+				scanf("%10s", fromDate);
+				printf("Bitis tarihi ('-' = sinirsiz): ");
+				scanf("%10s", toDate);
+
+				int openFrom = strcmp(fromDate, "-") == 0, openTo = strcmp(toDate, "-") == 0;
+				if (!isPositiveNumber(customerID) || keyChoice < 1 || keyChoice > 3 ||
+				    (orderChoice != 1 && orderChoice != 2) ||
+				    (!openFrom && !isValidDate(fromDate)) || (!openTo && !isValidDate(toDate))) {
+					printError("Gecersiz siralama secenekleri.");
+					break;
+				}
+				displaySortedHistory(customerID, keyChoice, orderChoice == 2,
+				                     openFrom ? NULL : fromDate, openTo ? NULL : toDate);
+				break;
+			}
+			case 32: {
+				int action;
+				printf("Toplu islem: %s, %d islem geri alinabilir, %d islem yinelenebilir\n",
+				       opLog.openStart >= 0 ? "acik" : "kapali", opLog.appliedBatches,
+				       opLog.batchEnd - opLog.appliedBatches);
+				printf("1 = baslat, 2 = tamamla, 3 = iptal et, 4 = son islemi geri al, 5 = yinele: ");
+				scanf("%d", &action);
+
+				int count;
+				switch (action) {
+					case 1:
+						if (beginBatch()) {
+							printf("Toplu islem baslatildi; gonderi ve sehir eklemeleri kaydediliyor.\n");
+						} else {
+							printf("Zaten acik bir toplu islem var.\n");
+						}
+						break;
+					case 2:
+						count = commitBatch();
+						if (count < 0) printf("Acik toplu islem yok.\n");
+						else printf("Toplu islem tamamlandi (%d ekleme).\n", count);
+						break;
+					case 3:
+						count = rollbackBatch();
+						if (count < 0) printf("Acik toplu islem yok.\n");
+						else printf("Toplu islem iptal edildi, %d ekleme geri alindi.\n", count);
+						break;
+					case 4:
+						count = undoBatch();
+						if (count < 0) printf(opLog.openStart >= 0 ? "Once acik toplu islemi tamamlayin ya da iptal edin.\n"
+						                                           : "Geri alinacak toplu islem yok.\n");
+						else printf("Son toplu islem geri alindi (%d ekleme).\n", count);
+						break;
+					case 5:
+						count = redoBatch();
+						if (count < 0) printf(opLog.openStart >= 0 ? "Once acik toplu islemi tamamlayin ya da iptal edin.\n"
+						                                           : "Yinelenecek toplu islem yok.\n");
+						else printf("Toplu islem yinelendi (%d ekleme).\n", count);
+						break;
+					default:
+						printf("Gecersiz secim.\n");
+				}
+				break;
+			}
+			case 21: // Cikis 21'de kalir; yeni secenekler sonraki numaralari alir
 				printf("Sistemden cikis yapiliyor...\n");
 				cleanup();
 				exit(0);
             default:
                 printf("Gecersiz secim. Lutfen tekrar deneyin.\n");
         }
+        enforceMemoryCeiling();
     }
 }
 
 
-// Musteri ve gonderim islemleri
-void addCustomer(char* firstName, char* lastName) {
-    // Musteri ID'sini otomatik olarak belirle
-    int customerID = autoCustomerID++;
-
-    Customer* newCustomer = (Customer*)safeMalloc(sizeof(Customer));
-    newCustomer->customerID = customerID;
-    strcpy(newCustomer->firstName, firstName);
-    strcpy(newCustomer->lastName, lastName);
-    newCustomer->shipmentHistory = NULL;
-    newCustomer->next = customerList;
-    customerList = newCustomer;
-
-    printf("Musteri %d (%s %s) basariyla eklendi.\n", customerID, firstName, lastName);
+// Isim Havuzu Islemleri
+uint32_t hashName(const char* name) {
+    uint32_t hash = 2166136261u; // FNV-1a
+    while (*name) {
+        hash ^= (unsigned char)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
 }
 
-Customer* findCustomer(int customerID) {
-    Customer* current = customerList;
-    while (current != NULL) {
-        if (current->customerID == customerID) {
-            return current;
+void growNameSlots() {
+    uint32_t newCount = namePool.slotCount ? namePool.slotCount * 2 : 1024;
+    uint32_t* newSlots = (uint32_t*)safeMalloc(newCount * sizeof(uint32_t));
+    memset(newSlots, 0, newCount * sizeof(uint32_t));
+
+    // Mevcut isimleri yeni tabloya yerlestir
+    for (uint32_t i = 0; i < namePool.slotCount; i++) {
+        uint32_t entry = namePool.slots[i];
+        if (entry == 0) continue;
+        uint32_t index = hashName(namePool.data + entry - 1) & (newCount - 1);
+        while (newSlots[index] != 0) {
+            index = (index + 1) & (newCount - 1);
         }
-        current = current->next;
+        newSlots[index] = entry;
     }
-    return NULL;
-}
 
+    free(namePool.slots);
+    trackMemory(MEMORY_CUSTOMERS, (long)(newCount - namePool.slotCount) * sizeof(uint32_t));
+    namePool.slots = newSlots;
+    namePool.slotCount = newCount;
+}
 
-void addShipment(int customerID, char* date, char* status, int deliveryTime) {
-	int shipmentID = autoShipmentID++;
+// Ismi havuza ekler (zaten varsa mevcut ofseti doner)
+uint32_t internName(const char* name) {
+    if ((namePool.used + 1) * 4 >= namePool.slotCount * 3) {
+        growNameSlots(); // Doluluk %75'i gecmesin
+    }
 
-    Customer* customer = findCustomer(customerID);
-    if (customer == NULL) {
-        printError("Musteri bulunamadi.");
-        return;
+    uint32_t mask = namePool.slotCount - 1;
+    uint32_t index = hashName(name) & mask;
+    while (namePool.slots[index] != 0) {
+        uint32_t offset = namePool.slots[index] - 1;
+        if (strcmp(namePool.data + offset, name) == 0) {
+            return offset;
+        }
+        index = (index + 1) & mask;
     }
 
-    if (!isValidDate(date)) {
-        printError("Tarih formati hatali. YYYY-MM-DD formatinda giriniz.");
-        return;
+    uint32_t length = (uint32_t)strlen(name) + 1;
+    if (namePool.length + length > namePool.capacity) {
+        uint32_t newCapacity = namePool.capacity ? namePool.capacity : 4096;
+        while (namePool.length + length > newCapacity) {
+            newCapacity *= 2;
+        }
+        namePool.data = (char*)safeRealloc(namePool.data, newCapacity);
+        trackMemory(MEMORY_CUSTOMERS, (long)(newCapacity - namePool.capacity));
+        namePool.capacity = newCapacity;
     }
 
-    Shipment* newShipment = (Shipment*)safeMalloc(sizeof(Shipment));
-    newShipment->shipmentID = shipmentID;
-    strcpy(newShipment->date, date);
-    strcpy(newShipment->status, status);
-    newShipment->deliveryTime = deliveryTime;
-    newShipment->next = NULL;
+    uint32_t offset = namePool.length;
+    memcpy(namePool.data + offset, name, length);
+    namePool.length += length;
+    namePool.slots[index] = offset + 1;
+    namePool.used++;
+    return offset;
+}
 
-    // Tarihe gore sirali ekleme
-    Shipment** current = &customer->shipmentHistory;
-    while (*current != NULL && strcmp((*current)->date, date) < 0) {
-        current = &(*current)->next;
-    }
-    newShipment->next = *current;
-    *current = newShipment;
+// Donen isaretci bir sonraki internName cagrisina kadar gecerlidir
+const char* customerFirstName(const Customer* customer) {
+    return namePool.data + customer->firstName;
+}
+
+const char* customerLastName(const Customer* customer) {
+    return namePool.data + customer->lastName;
+}
 
-    printf("Gonderi %d musteri %d icin basariyla eklendi.\n", shipmentID, customerID);
+Customer* allocateCustomer() {
+    if (customerBlocks == NULL || customerBlocks->used == CUSTOMER_BLOCK_SIZE) {
+        CustomerBlock* block = (CustomerBlock*)safeMalloc(sizeof(CustomerBlock));
+        trackMemory(MEMORY_CUSTOMERS, sizeof(CustomerBlock));
+        block->used = 0;
+        block->next = customerBlocks;
+        customerBlocks = block;
+    }
+    return &customerBlocks->items[customerBlocks->used++];
 }
 
+// Musteri basina bellek kullanimini eski sabit dizili kayit ile karsilastirir
+void printCustomerMemoryReport() {
+    long customerCount = 0;
+    long blockCount = 0;
+    for (Customer* c = customerList; c != NULL; c = c->next) customerCount++;
+    for (CustomerBlock* b = customerBlocks; b != NULL; b = b->next) blockCount++;
 
-void displayCustomerShipments(int customerID) {
-    Customer* customer = findCustomer(customerID);
-    if (customer == NULL) {
-        printf("Musteri ID %d bulunamadi.\n", customerID);
+    if (customerCount == 0) {
+        printf("Kayitli musteri yok.\n");
         return;
     }
 
-    printf("Musteri: %s %s (ID: %d)\n", customer->firstName, customer->lastName, customer->customerID);
-    printf("Gonderim Gecmisi:\n");
+    // Eski kayit: int + char[50] + char[50] + iki isaretci, her biri ayri malloc
+    size_t legacyRecord = sizeof(int) + 50 + 50 + 2 * sizeof(void*);
+    legacyRecord = (legacyRecord + sizeof(void*) - 1) / sizeof(void*) * sizeof(void*);
+    size_t legacyChunk = (legacyRecord + sizeof(size_t) + 15) / 16 * 16; // malloc basligi + hizalama
 
-    Shipment* current = customer->shipmentHistory;
-    if (current == NULL) {
+    size_t recordBytes = (size_t)blockCount * sizeof(CustomerBlock);
+    size_t poolBytes = namePool.capacity + (size_t)namePool.slotCount * sizeof(uint32_t);
+
+    printf("Musteri sayisi: %ld, farkli isim sayisi: %u\n", customerCount, namePool.used);
+    printf("Onceki duzen : %zu bayt/musteri (kayit %zu bayt, toplam %.1f MB)\n",
+           legacyChunk, legacyRecord, legacyChunk * (double)customerCount / 1048576.0);
+    printf("Yeni duzen   : %.1f bayt/musteri (kayit %zu bayt + isim havuzu %.1f MB, toplam %.1f MB)\n",
+           (double)(recordBytes + poolBytes) / customerCount, sizeof(Customer),
+           poolBytes / 1048576.0, (recordBytes + poolBytes) / 1048576.0);
+}
+
+// Musteri ve gonderim islemleri
+int addCustomer(char* firstName, char* lastName) {
+    // Musteri ID'sini otomatik olarak belirle
+    int customerID = autoCustomerID;
+    int slot = customerSlot(customerID);
+    autoCustomerID += idStride;
+
+    Customer* newCustomer = allocateCustomer();
+    newCustomer->customerID = customerID;
+    newCustomer->firstName = internName(firstName);
+    newCustomer->lastName = internName(lastName);
+    newCustomer->archive = 0;
+    indexCustomerName(newCustomer);
+
+    if (slot >= customerTableCapacity) {
+        int newCapacity = customerTableCapacity ? customerTableCapacity * 2 : 1024;
+        while (slot >= newCapacity) newCapacity *= 2;
+        customerTable = (Customer**)safeRealloc(customerTable, newCapacity * sizeof(Customer*));
+        memset(customerTable + customerTableCapacity, 0, (newCapacity - customerTableCapacity) * sizeof(Customer*));
+        customerShipmentCounts = (int*)safeRealloc(customerShipmentCounts, newCapacity * sizeof(int));
+        memset(customerShipmentCounts + customerTableCapacity, 0, (newCapacity - customerTableCapacity) * sizeof(int));
+        customerLastAccess = (uint32_t*)safeRealloc(customerLastAccess, newCapacity * sizeof(uint32_t));
+        memset(customerLastAccess + customerTableCapacity, 0, (newCapacity - customerTableCapacity) * sizeof(uint32_t));
+        trackMemory(MEMORY_CUSTOMERS, (long)(newCapacity - customerTableCapacity) *
+                    (sizeof(Customer*) + sizeof(int) + sizeof(uint32_t)));
+        customerTableCapacity = newCapacity;
+    }
+    customerTable[slot] = newCustomer;
+    newCustomer->shipmentHistory = NULL;
+    newCustomer->next = customerList;
+    publishPointer(customerList, newCustomer);
+
+    printInfo("Musteri %d (%s %s) basariyla eklendi.\n", customerID, firstName, lastName);
+    return customerID;
+}
+
+Customer* findCustomer(int customerID) {
+    if (customerID <= 0 || (idStride > 1 && (customerID - 1) % idStride != partitionIndex)) {
+        return NULL; // Baska bir bolumun musterisi
+    }
+    int slot = customerSlot(customerID);
+    if (slot >= customerTableCapacity) {
+        return NULL;
+    }
+    return customerTable[slot];
+}
+
+// Isim Indeksi Islemleri
+int compareCustomerNames(const Customer* a, const Customer* b) {
+    int result = strcmp(customerLastName(a), customerLastName(b));
+    if (result == 0) result = strcmp(customerFirstName(a), customerFirstName(b));
+    if (result == 0) result = (a->customerID > b->customerID) - (a->customerID < b->customerID);
+    return result;
+}
+
+void indexCustomerName(Customer* customer) {
+    if (nameIndex.pendingCount == nameIndex.pendingCapacity) {
+        int oldCapacity = nameIndex.pendingCapacity;
+        nameIndex.pendingCapacity = nameIndex.pendingCapacity ? nameIndex.pendingCapacity * 2 : 256;
+        trackMemory(MEMORY_CUSTOMERS, (long)(nameIndex.pendingCapacity - oldCapacity) * sizeof(Customer*));
+        nameIndex.pending = (Customer**)safeRealloc(nameIndex.pending, nameIndex.pendingCapacity * sizeof(Customer*));
+    }
+
+    // Sirali yere kaydirarak ekle (pending en fazla kok n kayit tutar)
+    int low = 0, high = nameIndex.pendingCount;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (compareCustomerNames(nameIndex.pending[mid], customer) < 0) low = mid + 1;
+        else high = mid;
+    }
+    memmove(&nameIndex.pending[low + 1], &nameIndex.pending[low], (nameIndex.pendingCount - low) * sizeof(Customer*));
+    nameIndex.pending[low] = customer;
+    nameIndex.pendingCount++;
+
+    if ((long long)nameIndex.pendingCount * nameIndex.pendingCount > nameIndex.sortedCount) {
+        flushNameIndex();
+    }
+}
+
+// Sirali src'yi, sonunda yeterli yer olan sirali dest'e sondan baslayarak birlestirir.
+// src kisa oldugundan her src kaydinin yeri ikili aramayla bulunur ve aradaki dest
+// blogu tek memmove ile kaydirilir: O(src log dest) karsilastirma.
+void mergeNameRuns(Customer** dest, int destCount, Customer* const* src, int srcCount) {
+    int end = destCount; // dest[0, end) henuz yerinde
+    for (int j = srcCount - 1; j >= 0; j--) {
+        int low = 0, high = end;
+        while (low < high) {
+            int mid = low + (high - low) / 2;
+            if (compareCustomerNames(dest[mid], src[j]) < 0) low = mid + 1;
+            else high = mid;
+        }
+        memmove(&dest[low + j + 1], &dest[low], (end - low) * sizeof(Customer*));
+        dest[low + j] = src[j];
+        end = low;
+    }
+}
+
+// Sirali pending'i ana diziye birlestirir ve bosaltir
+void flushNameIndex() {
+    int total = nameIndex.sortedCount + nameIndex.pendingCount;
+    if (total > nameIndex.sortedCapacity) {
+        trackMemory(MEMORY_CUSTOMERS, (long)(total + total / 2 - nameIndex.sortedCapacity) * sizeof(Customer*));
+        nameIndex.sortedCapacity = total + total / 2;
+        nameIndex.sorted = (Customer**)safeRealloc(nameIndex.sorted, nameIndex.sortedCapacity * sizeof(Customer*));
+    }
+    mergeNameRuns(nameIndex.sorted, nameIndex.sortedCount, nameIndex.pending, nameIndex.pendingCount);
+
+    nameIndex.sortedCount = total;
+    nameIndex.pendingCount = 0;
+}
+
+// Musterinin sorgu araligina gore konumu: <0 once, 0 eslesiyor, >0 sonra
+int compareCustomerToQuery(const Customer* customer, const char* lastName, const char* firstName, int prefix) {
+    if (firstName == NULL) {
+        return prefix ? strncmp(customerLastName(customer), lastName, strlen(lastName))
+                      : strcmp(customerLastName(customer), lastName);
+    }
+
+    int result = strcmp(customerLastName(customer), lastName);
+    if (result != 0) return result;
+    return prefix ? strncmp(customerFirstName(customer), firstName, strlen(firstName))
+                  : strcmp(customerFirstName(customer), firstName);
+}
+
+// Sirali dizide sorguyla eslesen [first, last) araligi
+void findNameRange(Customer* const* array, int count, const char* lastName, const char* firstName, int prefix,
+                   int* first, int* last) {
+    // Alt sinir: sorguya esit veya buyuk ilk kayit
+    int low = 0, high = count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (compareCustomerToQuery(array[mid], lastName, firstName, prefix) < 0) low = mid + 1;
+        else high = mid;
+    }
+    *first = low;
+
+    // Ust sinir: sorgudan buyuk ilk kayit
+    high = count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (compareCustomerToQuery(array[mid], lastName, firstName, prefix) <= 0) low = mid + 1;
+        else high = mid;
+    }
+    *last = low;
+}
+
+// Soyada (ve istege bagli olarak ada) gore musteri arar. prefix=1 ise son verilen
+// alan onek olarak eslestirilir. Eslesen [offset, offset+limit) araligi out'a yazilir,
+// toplam eslesme sayisi total'a doner. Karmasiklik: O(log n + k)
+int searchCustomersByName(const char* lastName, const char* firstName, int prefix,
+                          int offset, int limit, Customer** out, int* total) {
+    int a, sortedLast, b, pendingLast;
+    findNameRange(nameIndex.sorted, nameIndex.sortedCount, lastName, firstName, prefix, &a, &sortedLast);
+    findNameRange(nameIndex.pending, nameIndex.pendingCount, lastName, firstName, prefix, &b, &pendingLast);
+    *total = (sortedLast - a) + (pendingLast - b);
+
+    // Istemciden gelen offset eslesme sayisiyla sinirlanir (toplama tasmasin)
+    if (offset < 0) offset = 0;
+    if (offset > *total) offset = *total;
+
+    // Birlesik sirada ilk offset kaydin kaci ana diziden gelir: ana diziden i,
+    // pending'den offset - i kayit alinir ve uygun i ikili aramayla bulunur
+    int low = offset - (pendingLast - b) > 0 ? offset - (pendingLast - b) : 0;
+    int high = offset < sortedLast - a ? offset : sortedLast - a;
+    while (low < high) {
+        int i = low + (high - low) / 2;
+        if (compareCustomerNames(nameIndex.sorted[a + i], nameIndex.pending[b + offset - i - 1]) < 0) low = i + 1;
+        else high = i;
+    }
+    a += low;
+    b += offset - low;
+
+    int count = 0;
+    while (count < limit && (a < sortedLast || b < pendingLast)) {
+        if (b == pendingLast || (a < sortedLast && compareCustomerNames(nameIndex.sorted[a], nameIndex.pending[b]) < 0)) {
+            out[count++] = nameIndex.sorted[a++];
+        } else {
+            out[count++] = nameIndex.pending[b++];
+        }
+    }
+    return count;
+}
+
+void freeNameIndex() {
+    free(nameIndex.sorted);
+    free(nameIndex.pending);
+    memset(&nameIndex, 0, sizeof(nameIndex));
+}
+
+
+int addShipment(int customerID, char* date, char* status, int deliveryTime) {
+	int shipmentID = autoShipmentID;
+    autoShipmentID += idStride;
+
+    Customer* customer = findCustomer(customerID);
+    if (customer == NULL) {
+        printError("Musteri bulunamadi.");
+        return 0;
+    }
+
+    if (!isValidDate(date)) {
+        printError("Tarih formati hatali. YYYY-MM-DD formatinda giriniz.");
+        return 0;
+    }
+    if (!loadCustomerHistory(customer)) {
+        return 0;
+    }
+
+    Shipment* newShipment = (Shipment*)safeMalloc(sizeof(Shipment));
+    newShipment->shipmentID = shipmentID;
+    strcpy(newShipment->date, date);
+    strcpy(newShipment->status, status);
+    newShipment->deliveryTime = deliveryTime;
+    newShipment->version = beginWrite();
+    newShipment->next = NULL;
+    trackMemory(MEMORY_HISTORIES, sizeof(Shipment));
+
+    // Tarihe gore sirali ekleme; ayni tarihliler ID sirasinda kalir (disa aktarim imleci buna dayanir)
+    Shipment** current = shipmentsByDateInsertLink(&customer->shipmentHistory, newShipment);
+    newShipment->next = *current;
+    publishPointer(*current, newShipment);
+    commitWrite();
+    if (__builtin_expect(opLogActive, 0)) {
+        logShipmentInsert(customer, newShipment, current);
+    }
+    recordShipmentRollup(customerID, newShipment);
+
+    printInfo("Gonderi %d musteri %d icin basariyla eklendi.\n", shipmentID, customerID);
+    return shipmentID;
+}
+
+
+void displayCustomerShipments(int customerID) {
+    Customer* customer = findCustomer(customerID);
+    if (customer == NULL) {
+        printf("Musteri ID %d bulunamadi.\n", customerID);
+        return;
+    }
+
+    printf("Musteri: %s %s (ID: %d)\n", customerFirstName(customer), customerLastName(customer), customer->customerID);
+    printf("Gonderim Gecmisi:\n");
+
+    int total = countCustomerShipments(customer);
+    if (total == 0) {
         printf("  Gonderim gecmisi yok.\n");
         return;
     }
 
-    while (current != NULL) {
-        printf("  Gonderi ID: %d, Tarih: %s, Durum: %s, Teslim Suresi: %d gun\n",
-               current->shipmentID, current->date, current->status, current->deliveryTime);
-        current = current->next;
+    // Arsiv ve canli kayitlar tarih sirasiyla; uzun gecmislerin yalnizca ilk
+    // sayfasi gosterilir, devami anahtarla disa aktarimdan alinir
+    ExportCursor cursor;
+    ByteBuffer buffer = { NULL, 0, 0 };
+    openExportCursor(&cursor, customerID);
+    long shown = exportShipments(&cursor, EXPORT_DISPLAY_RECORDS, EXPORT_TEXT, &buffer);
+    fwrite(buffer.data, 1, buffer.length, stdout);
+    bufferFree(&buffer);
+
+    if (shown < total) {
+        char token[48];
+        formatExportToken(&cursor, token, sizeof(token));
+        printf("  ... %d gonderinin ilk %ld tanesi gosterildi. Devami: disa aktarim (29), anahtar %s\n",
+               total, shown, token);
+    }
+}
+
+// Musterinin gecmisini [fromDate, toDate] araliginda (NULL = sinirsiz) secilen
+// anahtara gore siralayip listeler. keyChoice: 1 = tarih, 2 = gonderi ID, 3 = teslim suresi
+void displaySortedHistory(int customerID, int keyChoice, int descending, const char* fromDate, const char* toDate) {
+    Customer* customer = findCustomer(customerID);
+    if (customer == NULL) {
+        printf("Musteri ID %d bulunamadi.\n", customerID);
+        return;
+    }
+
+    // Arsivlenmis ve canli kayitlarin araliga dusen kopyalari
+    Shipment* list = NULL;
+    Shipment record;
+    ArchiveCursor cursor;
+    ArchiveBlock** archive = customerArchive(customer);
+    openArchiveCursor(&cursor, archive ? *archive : NULL);
+    int hasArchived = nextArchivedShipment(&cursor, &record);
+    Shipment* live = customerHistory(customer);
+    while (hasArchived || live != NULL) {
+        const Shipment* source = hasArchived ? &record : live;
+        if ((fromDate == NULL || strcmp(source->date, fromDate) >= 0) &&
+            (toDate == NULL || strcmp(source->date, toDate) <= 0)) {
+            Shipment* copy = (Shipment*)safeMalloc(sizeof(Shipment));
+            *copy = *source;
+            copy->next = list;
+            list = copy;
+        }
+        if (hasArchived) hasArchived = nextArchivedShipment(&cursor, &record);
+        else live = live->next;
+    }
+
+    switch (keyChoice * 2 + (descending != 0)) {
+        case 2: shipmentsByDateIDSort(&list); break;
+        case 3: shipmentsByDateIDDescendingSort(&list); break;
+        case 4: shipmentsByIDSort(&list); break;
+        case 5: shipmentsByIDDescendingSort(&list); break;
+        case 6: shipmentsByDeliverySort(&list); break;
+        default: shipmentsByDeliveryDescendingSort(&list); break;
+    }
+
+    if (list == NULL) {
+        printf("  Aralikta gonderim yok.\n");
+        return;
+    }
+    ByteBuffer buffer = { NULL, 0, 0 };
+    while (list != NULL) {
+        Shipment* current = list;
+        appendExportRecord(&buffer, EXPORT_TEXT, customerID, current, 0);
+        list = current->next;
+        free(current);
+    }
+    fwrite(buffer.data, 1, buffer.length, stdout);
+    bufferFree(&buffer);
+}
+
+// Kargo ID Tekillestirme
+#define DEDUP_EMPTY_SLOT INT64_MIN
+
+uint64_t mixShipmentID(int shipmentID) {
+    uint64_t x = (uint64_t)(uint32_t)shipmentID + 0x9E3779B97F4A7C15ull; // splitmix64
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+MemoryCategory filterMemoryCategory(const ShipmentIDFilter* filter) {
+    return filter == &stackIDFilter ? MEMORY_STACK : MEMORY_QUEUE;
+}
+
+void growShipmentIDSlots(ShipmentIDFilter* filter) {
+    uint32_t newCount = filter->slotCount ? filter->slotCount * 2 : 1024;
+    int64_t* newSlots = (int64_t*)safeMalloc(newCount * sizeof(int64_t));
+    for (uint32_t i = 0; i < newCount; i++) newSlots[i] = DEDUP_EMPTY_SLOT;
+
+    for (uint32_t i = 0; i < filter->slotCount; i++) {
+        if (filter->slots[i] == DEDUP_EMPTY_SLOT) continue;
+        uint32_t index = (uint32_t)mixShipmentID((int)filter->slots[i]) & (newCount - 1);
+        while (newSlots[index] != DEDUP_EMPTY_SLOT) {
+            index = (index + 1) & (newCount - 1);
+        }
+        newSlots[index] = filter->slots[i];
+    }
+
+    free(filter->slots);
+    trackMemory(filterMemoryCategory(filter), (long)(newCount - filter->slotCount) * sizeof(int64_t));
+    filter->slots = newSlots;
+    filter->slotCount = newCount;
+}
+
+// ID'yi filtreye ekler; zaten canliysa hicbir sey degistirmeden 0 doner
+int shipmentIDFilterInsert(ShipmentIDFilter* filter, int shipmentID) {
+    if ((filter->live + 1) * 4 >= filter->slotCount * 3) {
+        growShipmentIDSlots(filter); // Doluluk %75'i gecmesin
+    }
+
+    uint32_t slotMask = filter->slotCount - 1;
+    uint32_t index = (uint32_t)mixShipmentID(shipmentID) & slotMask;
+    while (filter->slots[index] != DEDUP_EMPTY_SLOT) {
+        if (filter->slots[index] == shipmentID) {
+            filter->duplicates++;
+            return 0;
+        }
+        index = (index + 1) & slotMask;
+    }
+    filter->slots[index] = shipmentID;
+    filter->live++;
+    return 1;
+}
+
+// Kuyruktan/stack'ten cikan ID'yi kumeden siler
+void shipmentIDFilterRemove(ShipmentIDFilter* filter, int shipmentID) {
+    if (filter->live == 0) return;
+
+    uint32_t slotMask = filter->slotCount - 1;
+    uint32_t index = (uint32_t)mixShipmentID(shipmentID) & slotMask;
+    while (filter->slots[index] != shipmentID) {
+        if (filter->slots[index] == DEDUP_EMPTY_SLOT) return;
+        index = (index + 1) & slotMask;
+    }
+
+    // Geri kaydirmali silme: arkadaki kayitlari bosluga tasi, mezar tasi birakma
+    uint32_t hole = index;
+    for (uint32_t next = (hole + 1) & slotMask; filter->slots[next] != DEDUP_EMPTY_SLOT;
+         next = (next + 1) & slotMask) {
+        uint32_t home = (uint32_t)mixShipmentID((int)filter->slots[next]) & slotMask;
+        if (((next - home) & slotMask) >= ((next - hole) & slotMask)) {
+            filter->slots[hole] = filter->slots[next];
+            hole = next;
+        }
+    }
+    filter->slots[hole] = DEDUP_EMPTY_SLOT;
+    filter->live--;
+}
+
+void freeShipmentIDFilter(ShipmentIDFilter* filter) {
+    trackMemory(filterMemoryCategory(filter), -(long)((size_t)filter->slotCount * sizeof(int64_t)));
+    free(filter->slots);
+    memset(filter, 0, sizeof(*filter));
+}
+
+// Teslim suresi deliveryTime'i gecmeyen son dugum (yoksa NULL: basa eklenir).
+// Esit sureler eklenme sirasini korur.
+PriorityQueueNode* queueLastAtOrBefore(int deliveryTime) {
+    PriorityQueueNode* current = NULL;
+    PriorityQueueNode probe;
+    probe.deliveryTime = deliveryTime;
+    if (deliveryTime >= 0) {
+        // deliveryTime'a kadar olan en buyuk dolu kova
+        int bucket = deliveryTime < QUEUE_TAIL_BUCKETS ? deliveryTime : QUEUE_TAIL_BUCKETS - 1;
+        int word = bucket / 64;
+        uint64_t bits = queueBucketMask[word] & (~0ull >> (63 - bucket % 64));
+        while (bits == 0 && word > 0) {
+            bits = queueBucketMask[--word];
+        }
+        if (bits != 0) {
+            current = queueBucketTails[word * 64 + 63 - __builtin_clzll(bits)];
+            if (deliveryTime < QUEUE_TAIL_BUCKETS) {
+                return current;
+            }
+        }
+    }
+
+    // Indeks disindaki sureler icin dogrusal arama. Dolu kova yoksa da
+    // bastan yurunur: indekslenmeyen negatif sureler kuyrugun basindadir.
+    if (current == NULL) {
+        if (priorityQueue == NULL || queueDeliveryKey(&probe, priorityQueue) < 0) {
+            return NULL;
+        }
+        current = priorityQueue;
     }
+    return queueByDeliveryLastAtOrBefore(current, &probe);
 }
 
-// Kargo Ekleme (Priority Queue'ya ekleme)
-void addToPriorityQueue(int shipmentID, int deliveryTime, char* status) {
-    PriorityQueueNode* newNode = (PriorityQueueNode*)malloc(sizeof(PriorityQueueNode));
+// Kargo Ekleme (Priority Queue'ya ekleme). Kargo zaten kuyruktaysa 0 doner.
+int addToPriorityQueue(int shipmentID, int deliveryTime, char* status) {
+    if (shipmentDedupEnabled && !shipmentIDFilterInsert(&queueIDFilter, shipmentID)) {
+        printInfo("Kargo ID %d zaten kuyrukta, tekrar eklenmedi.\n", shipmentID);
+        return 0;
+    }
+
+    PriorityQueueNode* newNode = (PriorityQueueNode*)safeMalloc(sizeof(PriorityQueueNode));
+    trackMemory(MEMORY_QUEUE, sizeof(PriorityQueueNode));
     newNode->shipmentID = shipmentID;
     newNode->deliveryTime = deliveryTime;
     strcpy(newNode->status, status);
+    newNode->born = beginWrite();
+    newNode->died = 0;
     newNode->next = NULL;
 
-    if (priorityQueue == NULL || deliveryTime < priorityQueue->deliveryTime) {
-        // Yeni dugum basa ekleniyor
+    PriorityQueueNode* current = queueLastAtOrBefore(deliveryTime);
+    if (current == NULL) {
+        // Yeni dugum basa ekleniyor (zincirde olu dugumlerden sonra)
         newNode->next = priorityQueue;
+        if (priorityQueueDeadTail != NULL) {
+            publishPointer(priorityQueueDeadTail->next, newNode);
+        } else {
+            publishPointer(priorityQueueChain, newNode);
+        }
         priorityQueue = newNode;
     } else {
-        // Dogru konumu bul ve yerlestir
-        PriorityQueueNode* current = priorityQueue;
-        while (current->next != NULL && current->next->deliveryTime <= deliveryTime) {
-            current = current->next;
-        }
         newNode->next = current->next;
-        current->next = newNode;
+        publishPointer(current->next, newNode);
+    }
+    if (deliveryTime >= 0 && deliveryTime < QUEUE_TAIL_BUCKETS) {
+        queueBucketTails[deliveryTime] = newNode;
+        queueBucketMask[deliveryTime / 64] |= 1ull << (deliveryTime % 64);
     }
+    commitWrite();
 
-    printf("Kargo ID %d, teslim suresi %d gun ile kuyruga eklendi.\n", shipmentID, deliveryTime);
+    printInfo("Kargo ID %d, teslim suresi %d gun ile kuyruga eklendi.\n", shipmentID, deliveryTime);
+    return 1;
 }
 
-// Oncelikli Kargoyu Isleme Alma
-void processPriorityQueue() {
+// Kuyrugun basindaki kargoyu cikarip out'a kopyalar (kuyruk bossa 0 doner)
+int takePriorityQueueHead(PriorityQueueNode* out) {
     if (priorityQueue == NULL) {
-        printf("Kuyrukta islenecek kargo yok.\n");
-        return;
+        return 0;
     }
 
     PriorityQueueNode* temp = priorityQueue;
-    printf("Kargo ID %d isleniyor. Teslim suresi: %d gun, Durum: %s\n",
-           temp->shipmentID, temp->deliveryTime, temp->status);
+    *out = *temp;
+    out->next = NULL;
+
+    // Bas dugum kovasinin son dugumuyse kova bosalmistir
+    int bucket = temp->deliveryTime;
+    if (bucket >= 0 && bucket < QUEUE_TAIL_BUCKETS && queueBucketTails[bucket] == temp) {
+        queueBucketTails[bucket] = NULL;
+        queueBucketMask[bucket / 64] &= ~(1ull << (bucket % 64));
+    }
 
+    // Dugum eski goruntuye sahip okuyucular icin zincirde olu olarak kalir
+    __atomic_store_n(&temp->died, beginWrite(), __ATOMIC_RELAXED);
     priorityQueue = priorityQueue->next; // Kuyrugu ilerlet
-    free(temp); // Bellegi serbest birak
+    priorityQueueDeadTail = temp;
+    commitWrite();
+    shipmentIDFilterRemove(&queueIDFilter, out->shipmentID);
+
+    reclaimSnapshots(); // Artik gorunmeyen dugumlerin bellegini serbest birak
+    return 1;
 }
 
-// Kuyruktaki Tum Kargolari Listeleme
-void displayPriorityQueue() {
-    if (priorityQueue == NULL) {
-        printf("Kuyrukta kargo yok.\n");
+// Oncelikli Kargoyu Isleme Alma
+void processPriorityQueue() {
+    PriorityQueueNode head;
+    if (!takePriorityQueueHead(&head)) {
+        printf("Kuyrukta islenecek kargo yok.\n");
         return;
     }
 
+    printf("Kargo ID %d isleniyor. Teslim suresi: %d gun, Durum: %s\n",
+           head.shipmentID, head.deliveryTime, head.status);
+}
+
+// Kuyruktaki Tum Kargolari Listeleme (kilitsiz, tutarli goruntu uzerinden)
+void displayPriorityQueue() {
+    int printed = 0;
 
-    printf("Kuyruktaki Kargolar:\n");
-    PriorityQueueNode* current = priorityQueue;
-    while (current != NULL) {
+    beginSnapshotRead();
+    for (PriorityQueueNode* current = readPointer(priorityQueueChain); current != NULL;
+         current = readPointer(current->next)) {
+        if (!isVisible(current->born, readPointer(current->died))) {
+            continue;
+        }
+        if (printed++ == 0) {
+            printf("Kuyruktaki Kargolar:\n");
+        }
         printf("  Kargo ID: %d, Teslim Suresi: %d gun, Durum: %s\n",
                current->shipmentID, current->deliveryTime, current->status);
-        current = current->next;
+    }
+    endSnapshotRead();
+
+    if (printed == 0) {
+        printf("Kuyrukta kargo yok.\n");
     }
 }
 
 
-// Gonderileri tarihe gore siralar ve en son 5 kargoyu listeler
-void displayLastFiveShipments() {
+// Gorunen gonderinin kopyasini listenin basina ekler. next alani yazici
+// tarafindan degisebilir; yalnizca veri alanlari kopyalanir.
+void prependVisibleShipment(Shipment** list, const Shipment* shipment) {
+    if (!isVisible(shipment->version, 0)) {
+        return;
+    }
+    Shipment* copy = (Shipment*)safeMalloc(sizeof(Shipment));
+    copy->shipmentID = shipment->shipmentID;
+    memcpy(copy->date, shipment->date, sizeof(copy->date));
+    memcpy(copy->status, shipment->status, sizeof(copy->status));
+    copy->deliveryTime = shipment->deliveryTime;
+    copy->version = shipment->version;
+    copy->next = *list;
+    *list = copy;
+}
+
+// Gonderileri tarihe gore siralar ve en yeni limit kargoyu out'a kopyalar (bulunan sayi doner)
+int collectLastShipments(Shipment* out, int limit) {
+    TRACE_SPAN("collectLastShipments");
     Shipment* allShipments = NULL; // Tum kargolarin birlesik listesi
     Shipment* currentShipment;
-    Customer* currentCustomer = customerList;
 
-    // Tum musterilerin gonderim gecmislerini birlestir
-    while (currentCustomer != NULL) {
-        currentShipment = currentCustomer->shipmentHistory;
-        while (currentShipment != NULL) {
-            Shipment* newShipment = (Shipment*)safeMalloc(sizeof(Shipment));
-            *newShipment = *currentShipment; // Verileri kopyala
-            newShipment->next = allShipments;
-            allShipments = newShipment;
-
-            currentShipment = currentShipment->next;
+    // Tum musterilerin gonderim gecmislerini tutarli bir goruntu uzerinden birlestir
+    {
+        TRACE_SPAN("gecmisleri kopyala");
+        beginSnapshotRead();
+        Customer* currentCustomer = readPointer(customerList);
+        while (currentCustomer != NULL) {
+            currentShipment = readPointer(currentCustomer->shipmentHistory);
+            if (isSpilledHistory(currentShipment)) {
+                // Diske tasinmis gecmis: kayitlar geri yuklenmeden dosyadan okunur
+                Shipment spilled[64];
+                uint32_t start = 0;
+                int count;
+                while ((count = readSpilledShipments(currentShipment, start, spilled, 64)) > 0) {
+                    for (int i = 0; i < count; i++) {
+                        prependVisibleShipment(&allShipments, &spilled[i]);
+                    }
+                    start += count;
+                }
+                currentShipment = NULL;
+            }
+            while (currentShipment != NULL) {
+                prependVisibleShipment(&allShipments, currentShipment);
+                currentShipment = readPointer(currentShipment->next);
+            }
+            currentCustomer = readPointer(currentCustomer->next);
         }
-        currentCustomer = currentCustomer->next;
+        endSnapshotRead();
     }
 
-    // Gonderimleri tarihe gore siralama
-    mergeSortShipments(&allShipments);
+    // En yeni gonderiler basta olacak sekilde (tarih, ID) sirasina diz
+    {
+        TRACE_SPAN("sirala");
+        shipmentsByDateIDDescendingSort(&allShipments);
+    }
 
-    // Son 5 kargoyu yazdir
-    printf("Son 5 gonderi:\n");
+    // Son limit kargoyu kopyala
     currentShipment = allShipments;
     int count = 0;
 
-    while (currentShipment != NULL && count < 5) {
-        printf("Gonderi ID: %d, Tarih: %s, Durum: %s, Teslim Suresi: %d gun\n",
-               currentShipment->shipmentID, currentShipment->date,
-               currentShipment->status, currentShipment->deliveryTime);
+    while (currentShipment != NULL && count < limit) {
+        out[count] = *currentShipment;
+        out[count].next = NULL;
 
         currentShipment = currentShipment->next;
         count++;
     }
 
     // Gecici birlesik listeyi serbest birak
-    while (allShipments != NULL) {
-        Shipment* temp = allShipments;
-        allShipments = allShipments->next;
-        free(temp);
+    {
+        TRACE_SPAN("listeyi serbest birak");
+        while (allShipments != NULL) {
+            Shipment* temp = allShipments;
+            allShipments = allShipments->next;
+            free(temp);
+        }
+    }
+    return count;
+}
+
+void displayLastFiveShipments() {
+    TRACE_SPAN("displayLastFiveShipments");
+    Shipment lastFive[5];
+    int count = collectLastShipments(lastFive, 5);
+
+    {
+        TRACE_SPAN("yazdir");
+        printf("Son 5 gonderi:\n");
+        for (int i = 0; i < count; i++) {
+            printf("Gonderi ID: %d, Tarih: %s, Durum: %s, Teslim Suresi: %d gun\n",
+                   lastFive[i].shipmentID, lastFive[i].date,
+                   lastFive[i].status, lastFive[i].deliveryTime);
+        }
     }
 }
 
 
 // Sehir Ekleme
-CityNode* createCityNode(int cityID, char* cityName) {
+CityNode* createCityNode(int cityID, const char* cityName) {
 	if (cityID > autoCityID) {
 		autoCityID = cityID;
 	}
 
-    CityNode* newNode = (CityNode*)malloc(sizeof(CityNode));
+    CityNode* newNode = (CityNode*)safeMalloc(sizeof(CityNode));
+    trackMemory(MEMORY_CITIES, sizeof(CityNode));
     newNode->cityID = cityID;
     strcpy(newNode->cityName, cityName);
     newNode->child = NULL;
     newNode->sibling = NULL;
+    newNode->version = beginWrite();
     return newNode;
 }
 
-void addCity(int parentCityID, int cityID, char* cityName, int deliveryTime) {
+// cityID'nin kaydi; sayfasi acilmamissa NULL (cityID 0..CITY_MAX_ID)
+CityIndexEntry* cityIndexEntry(const CityIndex* index, int cityID) {
+    if (index->pages == NULL || cityID < 0 || cityID > CITY_MAX_ID) {
+        return NULL;
+    }
+    CityIndexEntry* page = index->pages[cityID >> CITY_INDEX_PAGE_BITS];
+    return page != NULL ? &page[cityID & (CITY_INDEX_PAGE_SIZE - 1)] : NULL;
+}
+
+// cityID'nin sayfasini gerekirse acar ve kaydini doner
+CityIndexEntry* reserveCityIndex(CityIndex* index, int cityID) {
+    if (index->pages == NULL) {
+        index->pages = (CityIndexEntry**)safeMalloc(CITY_INDEX_PAGES * sizeof(CityIndexEntry*));
+        memset(index->pages, 0, CITY_INDEX_PAGES * sizeof(CityIndexEntry*));
+        trackMemory(MEMORY_CITIES, (long)CITY_INDEX_PAGES * (long)sizeof(CityIndexEntry*));
+    }
+    CityIndexEntry** page = &index->pages[cityID >> CITY_INDEX_PAGE_BITS];
+    if (*page == NULL) {
+        *page = (CityIndexEntry*)safeMalloc(CITY_INDEX_PAGE_SIZE * sizeof(CityIndexEntry));
+        memset(*page, 0, CITY_INDEX_PAGE_SIZE * sizeof(CityIndexEntry));
+        trackMemory(MEMORY_CITIES, (long)CITY_INDEX_PAGE_SIZE * (long)sizeof(CityIndexEntry));
+        index->pageCount++;
+    }
+    return &(*page)[cityID & (CITY_INDEX_PAGE_SIZE - 1)];
+}
+
+CityNode* findCityByID(int cityID) {
+    CityIndexEntry* entry = cityID > 0 ? cityIndexEntry(&cityIndex, cityID) : NULL;
+    return entry != NULL ? entry->city : NULL;
+}
+
+int addCity(int parentCityID, int cityID, char* cityName, int deliveryTime) {
+    TRACE_SPAN("addCity");
+	if (cityID == 0) {
+		// autoCityID kullanilmis olabilir (ornegin varsayilan sehirlerde); o zaman bir sonraki verilir
+		cityID = findCityByID(autoCityID) == NULL ? autoCityID : autoCityID + 1;
+	}
+    if (cityID <= 0 || cityID > CITY_MAX_ID || findCityByID(cityID) != NULL) {
+        printInfo("Sehir ID %d kullanilamaz (gecersiz veya zaten var).\n", cityID);
+        return 0;
+    }
+
+    if (root == NULL) {
+		// Kok dugum olusturuluyor
+        CityNode* newRoot = createCityNode(cityID, cityName);
+        newRoot->deliveryTime = deliveryTime;
+        CityIndexEntry* entry = reserveCityIndex(&cityIndex, cityID);
+        entry->city = newRoot;
+        entry->parentCityID = 0;
+        publishPointer(root, newRoot);
+        commitWrite();
+        if (__builtin_expect(opLogActive, 0)) {
+            logCityInsert(0, newRoot, NULL);
+        }
+        printInfo("Kargo merkezi olarak %s eklendi.\n", cityName);
+        return cityID;
+    }
+
+	// Ebeveyn dugumu bul
+    CityNode* parent;
+    {
+        TRACE_SPAN("ebeveyni bul");
+        parent = findCityByID(parentCityID);
+    }
+    if (parent == NULL) {
+        printInfo("Ebeveyn sehir ID %d bulunamadi.\n", parentCityID);
+        return 0;
+    }
+
+	// Yeni dugumu cocuk zincirinin sonuna ekle
+    {
+        TRACE_SPAN("kardes zincirine bagla");
+        CityNode* newNode = createCityNode(cityID, cityName);
+        newNode->deliveryTime = deliveryTime;
+        CityIndexEntry* entry = reserveCityIndex(&cityIndex, cityID);
+        entry->city = newNode;
+        entry->parentCityID = parentCityID;
+
+        CityIndexEntry* parentEntry = cityIndexEntry(&cityIndex, parentCityID);
+        CityNode* previousLastChild = parentEntry->lastChild;
+        if (previousLastChild == NULL) {
+            publishPointer(parent->child, newNode);
+        } else {
+            publishPointer(previousLastChild->sibling, newNode);
+        }
+        parentEntry->lastChild = newNode;
+        commitWrite();
+        if (__builtin_expect(opLogActive, 0)) {
+            logCityInsert(parentCityID, newNode, previousLastChild);
+        }
+    }
+
+    printInfo("Sehir %s (ID: %d), %s ebeveyn sehrine bagli olarak eklendi (Teslim Suresi: %d gun).\n", cityName, cityID, parent->cityName, deliveryTime);
+    return cityID;
+}
+
+// Eski surumler yalnizca karsilastirma olcumleri icindir; -DKARGO_LEGACY_BENCH
+// ile derlenmedikce ikili dosyaya girmez.
+#ifdef KARGO_LEGACY_BENCH
+// Dizinden onceki surum: ebeveyn tum agacta aranir, kardes zinciri sonuna
+// kadar yurunur (yalnizca --bench-cities karsilastirmasi icin)
+int legacyAddCity(int parentCityID, int cityID, char* cityName, int deliveryTime) {
+    TRACE_SPAN("legacyAddCity");
 	if (cityID == 0) {
 		cityID = autoCityID++;
 	}
@@ -763,34 +2695,45 @@ void addCity(int parentCityID, int cityID, char* cityName, int deliveryTime) {
 
     if (root == NULL) {
 		// Kok dugum olusturuluyor
-        root = createCityNode(cityID, cityName);
-        root->deliveryTime = deliveryTime;
-        printf("Kargo merkezi olarak %s eklendi.\n", cityName);
-        return;
+        CityNode* newRoot = createCityNode(cityID, cityName);
+        newRoot->deliveryTime = deliveryTime;
+        publishPointer(root, newRoot);
+        commitWrite();
+        printInfo("Kargo merkezi olarak %s eklendi.\n", cityName);
+        return cityID;
     }
 
 	// Ebeveyn dugumu bul
-    CityNode* parent = findCity(root, parentCityID);
+    CityNode* parent;
+    {
+        TRACE_SPAN("ebeveyni bul (agac taramasi)");
+        parent = findCity(root, parentCityID);
+    }
     if (parent == NULL) {
-        printf("Ebeveyn sehir ID %d bulunamadi.\n", parentCityID);
-        return;
+        printInfo("Ebeveyn sehir ID %d bulunamadi.\n", parentCityID);
+        return 0;
     }
 
 	// Yeni dugumu ekle
     CityNode* newNode = createCityNode(cityID, cityName);
     newNode->deliveryTime = deliveryTime;
 
-    if (parent->child == NULL) {
-        parent->child = newNode;
-    } else {
-        CityNode* sibling = parent->child;
-        while (sibling->sibling != NULL) {
-            sibling = sibling->sibling;
+    {
+        TRACE_SPAN("kardes zincirini yuru");
+        if (parent->child == NULL) {
+            publishPointer(parent->child, newNode);
+        } else {
+            CityNode* sibling = parent->child;
+            while (sibling->sibling != NULL) {
+                sibling = sibling->sibling;
+            }
+            publishPointer(sibling->sibling, newNode);
         }
-        sibling->sibling = newNode;
     }
+    commitWrite();
 
-    printf("Sehir %s (ID: %d), %s ebeveyn sehrine bagli olarak eklendi (Teslim Suresi: %d gun).\n", cityName, cityID, parent->cityName, deliveryTime);
+    printInfo("Sehir %s (ID: %d), %s ebeveyn sehrine bagli olarak eklendi (Teslim Suresi: %d gun).\n", cityName, cityID, parent->cityName, deliveryTime);
+    return cityID;
 }
 
 // Sehir Bulma
@@ -812,74 +2755,199 @@ CityNode* findCity(CityNode* node, int cityID) {
     // Kardeslerde ara
     return findCity(node->sibling, cityID);
 }
+#endif
 
 
-// Agac Yapisini Konsola Cizdirme
-void printTree(CityNode* node, int level) {
-    if (node == NULL) {
+// Sehir okuyucunun goruntusunde var mi. Kardesler ve cocuklar eklenme sirasiyla
+// baglandigindan, gorunmeyen ilk dugumden sonraki dugumler de gorunmez.
+int cityVisible(CityNode* node) {
+    return node != NULL && isVisible(node->version, 0);
+}
+
+// Ozyinelemesiz agac gezintisi (derin ya da genis yuklu aglarda yigin tasmaz).
+// Dugum cikinca once kardesi, sonra cocugu itilir; boylece sira ozyinelemeli
+// on-sirayla aynidir ve yigin yalnizca derinlik kadar buyur. Gorunmeyen dugum
+// itilmez; ardindaki kardesler de zaten gorunmez.
+typedef struct CityWalkEntry {
+    CityNode* node;
+    int level;
+} CityWalkEntry;
+
+typedef struct CityWalk {
+    CityWalkEntry* entries;
+    int top;
+    int capacity;
+} CityWalk;
+
+void cityWalkPush(CityWalk* walk, CityNode* node, int level) {
+    if (!cityVisible(node)) {
         return;
     }
-
-    // Dugumu yazdir
-    for (int i = 0; i < level; i++) {
-        printf("  ");
+    if (walk->top == walk->capacity) {
+        walk->capacity = walk->capacity ? walk->capacity * 2 : 64;
+        walk->entries = (CityWalkEntry*)safeRealloc(walk->entries, walk->capacity * sizeof(CityWalkEntry));
     }
-    printf("-> %s (ID: %d)\n", node->cityName, node->cityID);
+    walk->entries[walk->top].node = node;
+    walk->entries[walk->top].level = level;
+    walk->top++;
+}
+
+void openCityWalk(CityWalk* walk, CityNode* start, int level) {
+    walk->entries = NULL;
+    walk->top = walk->capacity = 0;
+    cityWalkPush(walk, start, level);
+}
 
-    // Cocuklari yazdir
-    printTree(node->child, level + 1);
+// Siradaki dugumu doner (bittiyse NULL, yigin serbest birakilir)
+CityNode* nextCityWalk(CityWalk* walk, int* level) {
+    if (walk->top == 0) {
+        free(walk->entries);
+        walk->entries = NULL;
+        return NULL;
+    }
+    CityWalkEntry entry = walk->entries[--walk->top];
+    cityWalkPush(walk, readPointer(entry.node->sibling), entry.level);
+    cityWalkPush(walk, readPointer(entry.node->child), entry.level + 1);
+    if (level != NULL) *level = entry.level;
+    return entry.node;
+}
 
-    // Kardesleri yazdir
-    printTree(node->sibling, level);
+// Agac Yapisini Konsola Cizdirme
+void printTree(CityNode* node, int level) {
+    CityWalk walk;
+    openCityWalk(&walk, node, level);
+    while ((node = nextCityWalk(&walk, &level)) != NULL) {
+        for (int i = 0; i < level; i++) {
+            printf("  ");
+        }
+        printf("-> %s (ID: %d)\n", node->cityName, node->cityID);
+    }
 }
 
-// Gonderim Ekleme (Push)
-void pushShipment(int shipmentID, char* date, char* status, int deliveryTime) {
-    ShipmentStackNode* newNode = (ShipmentStackNode*)malloc(sizeof(ShipmentStackNode));
+// Gonderim Ekleme (Push). Gonderi zaten stack'teyse 0 doner.
+int pushShipment(int shipmentID, char* date, char* status, int deliveryTime) {
+    if (shipmentDedupEnabled && !shipmentIDFilterInsert(&stackIDFilter, shipmentID)) {
+        printInfo("Gonderi ID %d zaten stack'te, tekrar eklenmedi.\n", shipmentID);
+        return 0;
+    }
+
+    ShipmentStackNode* newNode = (ShipmentStackNode*)safeMalloc(sizeof(ShipmentStackNode));
+    trackMemory(MEMORY_STACK, sizeof(ShipmentStackNode));
     newNode->shipmentID = shipmentID;
     strcpy(newNode->date, date);
     strcpy(newNode->status, status);
     newNode->deliveryTime = deliveryTime;
+    newNode->born = beginWrite();
+    newNode->died = 0;
 
-    newNode->next = shipmentStack; // Yeni dugumu tepeye ekle
+    newNode->next = shipmentStack; // Yeni dugumu tepeye ekle (zincirde olu dugumlerden sonra)
+    if (shipmentStackDeadTail != NULL) {
+        publishPointer(shipmentStackDeadTail->next, newNode);
+    } else {
+        publishPointer(shipmentStackChain, newNode);
+    }
     shipmentStack = newNode;
+    commitWrite();
 
-    printf("Gonderi ID %d stack'e eklendi.\n", shipmentID);
+    printInfo("Gonderi ID %d stack'e eklendi.\n", shipmentID);
+    return 1;
 }
 
-//Gonderim Cikartma (Pop)
-void popShipment() {
+// Stack'in tepesindeki gonderimi cikarip out'a kopyalar (stack bossa 0 doner)
+int takeStackTop(ShipmentStackNode* out) {
     if (shipmentStack == NULL) {
-        printf("Stack bos, cikartilacak gonderim yok.\n");
-        return;
+        return 0;
     }
 
     ShipmentStackNode* temp = shipmentStack;
-    printf("Gonderi ID %d cikariliyor. Tarih: %s, Durum: %s, Teslim Suresi: %d gun\n",
-           temp->shipmentID, temp->date, temp->status, temp->deliveryTime);
+    *out = *temp;
+    out->next = NULL;
 
+    __atomic_store_n(&temp->died, beginWrite(), __ATOMIC_RELAXED);
     shipmentStack = shipmentStack->next; // Tepeyi bir sonraki dugume tasi
-    free(temp); // Bellegi serbest birak
+    shipmentStackDeadTail = temp;
+    commitWrite();
+    shipmentIDFilterRemove(&stackIDFilter, out->shipmentID);
+
+    reclaimSnapshots(); // Artik gorunmeyen dugumlerin bellegini serbest birak
+    return 1;
+}
+
+//Gonderim Cikartma (Pop)
+void popShipment() {
+    ShipmentStackNode top;
+    if (!takeStackTop(&top)) {
+        printf("Stack bos, cikartilacak gonderim yok.\n");
+        return;
+    }
+
+    printf("Gonderi ID %d cikariliyor. Tarih: %s, Durum: %s, Teslim Suresi: %d gun\n",
+           top.shipmentID, top.date, top.status, top.deliveryTime);
 }
 
-// Stack'teki Gonderimleri Listeleme
+// Stack'teki Gonderimleri Listeleme (kilitsiz, tutarli goruntu uzerinden)
 void displayShipmentStack() {
-    if (shipmentStack == NULL) {
+    int printed = 0;
+    ByteBuffer buffer = { NULL, 0, 0 };
+    Shipment record;
+
+    // Satirlar tampona bicimlenir ve parti parti yazilir
+    beginSnapshotRead();
+    for (ShipmentStackNode* current = readPointer(shipmentStackChain); current != NULL;
+         current = readPointer(current->next)) {
+        if (!isVisible(current->born, readPointer(current->died))) {
+            continue;
+        }
+        if (printed++ == 0) {
+            printf("Stack'teki Gonderimler:\n");
+        }
+        record.shipmentID = current->shipmentID;
+        memcpy(record.date, current->date, sizeof(record.date));
+        memcpy(record.status, current->status, sizeof(record.status));
+        record.deliveryTime = current->deliveryTime;
+        appendExportRecord(&buffer, EXPORT_TEXT, 0, &record, 0);
+        if (buffer.length >= 65536) {
+            fwrite(buffer.data, 1, buffer.length, stdout);
+            buffer.length = 0;
+        }
+    }
+    endSnapshotRead();
+    if (buffer.length > 0) fwrite(buffer.data, 1, buffer.length, stdout);
+    bufferFree(&buffer);
+
+    if (printed == 0) {
         printf("Stack bos, goruntulenecek gonderim yok.\n");
-        return;
     }
+}
+
+// Teslim edilmis kargoyu once arsivde, sonra canli listede arar.
+// Arsivden bulunan kayit scratch'e cozulur ve scratch doner.
+Shipment* searchDeliveredShipments(Customer* customer, const char* targetDate, Shipment* scratch) {
+    if (searchArchivedShipments(customer, targetDate, scratch)) {
+        return scratch;
+    }
+    return searchDeliveredInList(customerHistory(customer), targetDate);
+}
 
-    printf("Stack'teki Gonderimler:\n");
-    ShipmentStackNode* current = shipmentStack;
-    while (current != NULL) {
-        printf("  Gonderi ID: %d, Tarih: %s, Durum: %s, Teslim Suresi: %d gun\n",
-               current->shipmentID, current->date, current->status, current->deliveryTime);
-        current = current->next;
+// Tarihe gore sirali listede hedef tarihin ilk kaydina ilerler ve o gunun
+// kayitlari arasinda teslim edilmis olani arar
+Shipment* searchDeliveredInList(Shipment* shipmentList, const char* targetDate) {
+    Shipment probe;
+    memset(probe.date, 0, sizeof(probe.date));
+    strncpy(probe.date, targetDate, sizeof(probe.date) - 1);
+
+    Shipment* shipment = shipmentsByDateLowerBound(shipmentList, &probe);
+    for (; shipment != NULL && shipmentDateKey(shipment, &probe) == 0; shipment = shipment->next) {
+        if (strcmp(shipment->status, "Teslim Edildi") == 0) {
+            return shipment;
+        }
     }
+    return NULL;
 }
 
-// Binary Search (Teslim Edilmis Kargolar icin)
-Shipment* searchDeliveredShipments(Shipment* shipmentList, const char* targetDate) {
+#ifdef KARGO_LEGACY_BENCH
+// Onceki liste uzerinde ikili arama (yalnizca --bench-sort karsilastirmasi icin)
+Shipment* legacySearchDeliveredInList(Shipment* shipmentList, const char* targetDate) {
     Shipment* start = shipmentList;
     Shipment* end = NULL;
 
@@ -909,156 +2977,6633 @@ Shipment* searchDeliveredShipments(Shipment* shipmentList, const char* targetDat
 
     return NULL; // Aranan teslim edilmis kargo bulunamadi
 }
+#endif
 
 
-// Siralama Algoritmasi (Teslim Edilmemis Kargolar icin)
-void mergeSortShipments(Shipment** headRef) {
-    Shipment* head = *headRef;
-    Shipment* a;
-    Shipment* b;
+// Tarih Donusumleri (1970-01-01'den itibaren gun sayisi)
+int daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yearOfEra = year - era * 400;
+    int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
 
-    if (!head || !head->next) return;
+int dateToDays(const char* date) {
+    int year, month, day;
+    if (sscanf(date, "%4d-%2d-%2d", &year, &month, &day) != 3) {
+        return 0;
+    }
+    return daysFromCivil(year, month, day);
+}
 
-    // Listeyi ortadan ikiye bol
-    splitList(head, &a, &b);
+// Yerel saate gore bugunun gun sayisi
+int currentDay() {
+    time_t now = time(NULL);
+    struct tm local;
+    localtime_r(&now, &local);
+    return daysFromCivil(local.tm_year + 1900, local.tm_mon + 1, local.tm_mday);
+}
 
-    // Bolumleri sirala
-    mergeSortShipments(&a);
-    mergeSortShipments(&b);
+// Gun sayisini YYYY-MM-DD formatina cevirir
+void daysToDate(int days, char* out) {
+    days += 719468;
+    int era = (days >= 0 ? days : days - 146096) / 146097;
+    int dayOfEra = days - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int monthIndex = (5 * dayOfYear + 2) / 153;
+    int day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    int month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    int year = yearOfEra + era * 400 + (month <= 2);
+    out[0] = (char)('0' + year / 1000 % 10);
+    out[1] = (char)('0' + year / 100 % 10);
+    out[2] = (char)('0' + year / 10 % 10);
+    out[3] = (char)('0' + year % 10);
+    out[4] = '-';
+    out[5] = (char)('0' + month / 10);
+    out[6] = (char)('0' + month % 10);
+    out[7] = '-';
+    out[8] = (char)('0' + day / 10);
+    out[9] = (char)('0' + day % 10);
+    out[10] = '\0';
+}
 
-    // Bolumleri birlestir
-    *headRef = sortedMerge(a, b);
+// Gunluk ve Duruma Gore Ozetler (Rollup)
+//
+// Her gonderi eklenirken gunune ve durumuna ait ozet guncellenir; analiz
+// sorgulari gonderileri gezmek yerine bu ozetleri okur (O(gun)).
+// Teslim suresi dagilimi log-dogrusal bir histogramla tutulur: 0-31 arasi
+// degerler tam, daha buyukleri her ikinin kuvveti araliginda 8 kovaya
+// bolunur (goreli hata en fazla %12.5). Kovalardan cikarma yapilabildigi
+// icin durum degisiklikleri de artimli islenir. Tam kovalarin disindaki
+// degerler ayrica (deger, adet) ciftleri olarak tutulur; boylece cikarma uc
+// degeri silse de yeni min/max kesin bulunur. Gunluk sorgular bugunden
+// geriye sayar.
+#define ROLLUP_EXACT_BUCKETS 32
+#define ROLLUP_BUCKETS (ROLLUP_EXACT_BUCKETS + 26 * 8)
+#define ROLLUP_PAGE_DAYS 64
+
+typedef struct RollupValueCount {
+    int value;
+    uint32_t count;
+} RollupValueCount;
+
+typedef struct DeliveryRollup {
+    uint32_t count;
+    int64_t sum;
+    int min;
+    int max;
+    uint32_t buckets[ROLLUP_BUCKETS];
+    RollupValueCount* outliers; // 0-31 disindaki degerler, degere gore sirali
+    uint32_t outlierCount;
+    uint32_t outlierCapacity;
+} DeliveryRollup;
+
+typedef struct StatusRollup {
+    char status[20];
+    DeliveryRollup stats;
+} StatusRollup;
+
+// Gunler 64'luk sayfalar halinde, yalnizca veri gelen araliklar icin ayrilir
+DeliveryRollup** rollupPages = NULL;
+int rollupFirstPage = 0;
+int rollupPageCount = 0;
+int rollupLastDay = INT_MIN; // Veri bulunan en yeni gun
+
+StatusRollup* statusRollups = NULL;
+int statusRollupCount = 0;
+
+int rollupBucket(int value) {
+    if (value < 0) value = 0;
+    if (value < ROLLUP_EXACT_BUCKETS) return value;
+    int octave = 31 - __builtin_clz((unsigned int)value); // >= 5
+    int sub = (value >> (octave - 3)) & 7;
+    return ROLLUP_EXACT_BUCKETS + (octave - 5) * 8 + sub;
 }
 
-Shipment* sortedMerge(Shipment* a, Shipment* b) {
-    Shipment* result = NULL;
+// Kovadaki en kucuk deger
+int rollupBucketLow(int bucket) {
+    if (bucket < ROLLUP_EXACT_BUCKETS) return bucket;
+    int octave = (bucket - ROLLUP_EXACT_BUCKETS) / 8 + 5;
+    int sub = (bucket - ROLLUP_EXACT_BUCKETS) % 8;
+    return (8 + sub) << (octave - 3);
+}
 
-    if (!a) return b;
-    if (!b) return a;
+// Tam kovalarin disindaki degerin outliers'taki yeri (yoksa eklenecegi yer)
+uint32_t rollupOutlierIndex(const DeliveryRollup* rollup, int value) {
+    uint32_t low = 0, high = rollup->outlierCount;
+    while (low < high) {
+        uint32_t mid = (low + high) / 2;
+        if (rollup->outliers[mid].value < value) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
 
-    // Karsilastirma: teslim suresi kucuk olan onde
-    if (strcmp(a->status, "Teslim Edilmedi") == 0 &&
-        strcmp(b->status, "Teslim Edilmedi") == 0 &&
-        a->deliveryTime <= b->deliveryTime) {
-        result = a;
-        result->next = sortedMerge(a->next, b);
-    } else {
-        result = b;
-        result->next = sortedMerge(a, b->next);
+void rollupAdd(DeliveryRollup* rollup, int value) {
+    if (rollup->count == 0 || value < rollup->min) rollup->min = value;
+    if (rollup->count == 0 || value > rollup->max) rollup->max = value;
+    rollup->count++;
+    rollup->sum += value;
+    rollup->buckets[rollupBucket(value)]++;
+    if (value >= 0 && value < ROLLUP_EXACT_BUCKETS) {
+        return;
     }
 
-    return result;
+    uint32_t index = rollupOutlierIndex(rollup, value);
+    if (index == rollup->outlierCount || rollup->outliers[index].value != value) {
+        if (rollup->outlierCount == rollup->outlierCapacity) {
+            rollup->outlierCapacity = rollup->outlierCapacity ? rollup->outlierCapacity * 2 : 4;
+            rollup->outliers = (RollupValueCount*)safeRealloc(rollup->outliers,
+                                                              rollup->outlierCapacity * sizeof(RollupValueCount));
+        }
+        memmove(&rollup->outliers[index + 1], &rollup->outliers[index],
+                (rollup->outlierCount - index) * sizeof(RollupValueCount));
+        rollup->outliers[index].value = value;
+        rollup->outliers[index].count = 0;
+        rollup->outlierCount++;
+    }
+    rollup->outliers[index].count++;
 }
 
-void splitList(Shipment* source, Shipment** frontRef, Shipment** backRef) {
-    Shipment* fast;
-    Shipment* slow;
-    slow = source;
-    fast = source->next;
+// Silinen deger sinirdaysa min/max tam kovalardan ve outliers'tan kesin olarak
+// yeniden bulunur. Negatif degerler 0 kovasinda da sayildigindan ayiklanir.
+void rollupRemove(DeliveryRollup* rollup, int value) {
+    rollup->count--;
+    rollup->sum -= value;
+    rollup->buckets[rollupBucket(value)]--;
+    if (value < 0 || value >= ROLLUP_EXACT_BUCKETS) {
+        uint32_t index = rollupOutlierIndex(rollup, value);
+        if (--rollup->outliers[index].count == 0) {
+            rollup->outlierCount--;
+            memmove(&rollup->outliers[index], &rollup->outliers[index + 1],
+                    (rollup->outlierCount - index) * sizeof(RollupValueCount));
+        }
+    }
+    if (rollup->count == 0) {
+        rollup->min = rollup->max = 0;
+        return;
+    }
 
-    // Hizli ve yavas pointer ile listeyi ikiye bol
-    while (fast) {
-        fast = fast->next;
-        if (fast) {
-            slow = slow->next;
-            fast = fast->next;
+    uint32_t negatives = 0;
+    for (uint32_t i = 0; i < rollup->outlierCount && rollup->outliers[i].value < 0; i++) {
+        negatives += rollup->outliers[i].count;
+    }
+    int exactLow = -1, exactHigh = -1;
+    for (int bucket = 0; bucket < ROLLUP_EXACT_BUCKETS; bucket++) {
+        uint32_t count = rollup->buckets[bucket] - (bucket == 0 ? negatives : 0);
+        if (count == 0) continue;
+        if (exactLow < 0) exactLow = bucket;
+        exactHigh = bucket;
+    }
+
+    if (value == rollup->min) {
+        if (negatives > 0 || exactLow < 0) {
+            rollup->min = rollup->outliers[0].value;
+        } else {
+            rollup->min = exactLow;
+        }
+    }
+    if (value == rollup->max) {
+        const RollupValueCount* last = rollup->outlierCount > 0 ? &rollup->outliers[rollup->outlierCount - 1] : NULL;
+        if (last != NULL && (last->value >= ROLLUP_EXACT_BUCKETS || exactHigh < 0)) {
+            rollup->max = last->value;
+        } else {
+            rollup->max = exactHigh;
         }
     }
+}
 
-    *frontRef = source;
-    *backRef = slow->next;
-    slow->next = NULL;
+void freeRollupOutliers(DeliveryRollup* rollup) {
+    free(rollup->outliers);
+    rollup->outliers = NULL;
+    rollup->outlierCount = rollup->outlierCapacity = 0;
 }
 
+// q (0-1) yuzdelik degeri; kovanin araligi min/max ile sinirlanir
+int rollupPercentile(const DeliveryRollup* rollup, double q) {
+    if (rollup->count == 0) return 0;
+    uint32_t rank = (uint32_t)(q * rollup->count + 0.999999);
+    if (rank == 0) rank = 1;
 
-// Teslimat Rotasinda Sehir Sayisini Bulma
-int countCities(CityNode* node) {
-    if (node == NULL) {
-        return 0; // Agacin sonuna ulasildi
+    uint32_t seen = 0;
+    int bucket = 0;
+    while (bucket < ROLLUP_BUCKETS - 1 && seen + rollup->buckets[bucket] < rank) {
+        seen += rollup->buckets[bucket++];
+    }
+
+    int value = rollupBucketLow(bucket);
+    if (bucket >= ROLLUP_EXACT_BUCKETS && bucket + 1 < ROLLUP_BUCKETS) {
+        value = (int)(((int64_t)value + rollupBucketLow(bucket + 1) - 1) / 2); // Kova ortasi
     }
-    return 1 + countCities(node->child) + countCities(node->sibling);
+    if (value < rollup->min) value = rollup->min;
+    if (value > rollup->max) value = rollup->max;
+    return value;
 }
 
-// En Uzun Teslimat Rotasini Hesaplama
-int calculateTreeDepth(CityNode* node) {
-    if (node == NULL) {
-        return 0;
+int floorDivide(int value, int divisor) {
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+// Gunun ozetini doner; create 0 ise ve sayfa yoksa NULL
+DeliveryRollup* dayRollup(int day, int create) {
+    int page = floorDivide(day, ROLLUP_PAGE_DAYS);
+    if (rollupPageCount == 0) {
+        if (!create) return NULL;
+        rollupPages = (DeliveryRollup**)safeMalloc(sizeof(DeliveryRollup*));
+        rollupPages[0] = NULL;
+        rollupFirstPage = page;
+        rollupPageCount = 1;
+    }
+
+    if (page < rollupFirstPage || page >= rollupFirstPage + rollupPageCount) {
+        if (!create) return NULL;
+        int first = page < rollupFirstPage ? page : rollupFirstPage;
+        int last = page >= rollupFirstPage + rollupPageCount ? page : rollupFirstPage + rollupPageCount - 1;
+        int newCount = last - first + 1;
+        DeliveryRollup** pages = (DeliveryRollup**)safeMalloc(newCount * sizeof(DeliveryRollup*));
+        memset(pages, 0, newCount * sizeof(DeliveryRollup*));
+        memcpy(pages + (rollupFirstPage - first), rollupPages, rollupPageCount * sizeof(DeliveryRollup*));
+        free(rollupPages);
+        rollupPages = pages;
+        rollupFirstPage = first;
+        rollupPageCount = newCount;
+    }
+
+    DeliveryRollup** slot = &rollupPages[page - rollupFirstPage];
+    if (*slot == NULL) {
+        if (!create) return NULL;
+        *slot = (DeliveryRollup*)safeMalloc(ROLLUP_PAGE_DAYS * sizeof(DeliveryRollup));
+        memset(*slot, 0, ROLLUP_PAGE_DAYS * sizeof(DeliveryRollup));
+    }
+    return &(*slot)[day - page * ROLLUP_PAGE_DAYS];
+}
+
+DeliveryRollup* statusRollup(const char* status, int create) {
+    for (int i = 0; i < statusRollupCount; i++) {
+        if (strcmp(statusRollups[i].status, status) == 0) {
+            return &statusRollups[i].stats;
+        }
     }
+    if (!create) return NULL;
+
+    statusRollups = (StatusRollup*)safeRealloc(statusRollups, (statusRollupCount + 1) * sizeof(StatusRollup));
+    StatusRollup* entry = &statusRollups[statusRollupCount++];
+    memset(entry, 0, sizeof(StatusRollup));
+    strcpy(entry->status, status);
+    return &entry->stats;
+}
+
+// Yeni gonderiyi musteri sayacina, gun ve durum ozetlerine ekler
+void recordShipmentRollup(int customerID, const Shipment* shipment) {
+    customerShipmentCounts[customerSlot(customerID)]++;
 
-    int childDepth = calculateTreeDepth(node->child);
-    int siblingDepth = calculateTreeDepth(node->sibling);
+    int day = dateToDays(shipment->date);
+    rollupAdd(dayRollup(day, 1), shipment->deliveryTime);
+    rollupAdd(statusRollup(shipment->status, 1), shipment->deliveryTime);
+    if (day > rollupLastDay) rollupLastDay = day;
+}
+
+// recordShipmentRollup'in tersi (geri alma). En yeni gun bosalirsa
+// rollupLastDay veri bulunan bir onceki gune cekilir.
+void forgetShipmentRollup(int customerID, const Shipment* shipment) {
+    customerShipmentCounts[customerSlot(customerID)]--;
+
+    int day = dateToDays(shipment->date);
+    rollupRemove(dayRollup(day, 0), shipment->deliveryTime);
+    rollupRemove(statusRollup(shipment->status, 0), shipment->deliveryTime);
+    if (day != rollupLastDay) {
+        return;
+    }
 
-    return (childDepth + 1 > siblingDepth) ? childDepth + 1 : siblingDepth;
+    int firstDay = rollupFirstPage * ROLLUP_PAGE_DAYS;
+    while (rollupLastDay >= firstDay) {
+        int page = floorDivide(rollupLastDay, ROLLUP_PAGE_DAYS);
+        if (rollupPages[page - rollupFirstPage] == NULL) {
+            rollupLastDay = page * ROLLUP_PAGE_DAYS - 1; // Bos sayfa tek adimda gecilir
+            continue;
+        }
+        if (dayRollup(rollupLastDay, 0)->count > 0) {
+            return;
+        }
+        rollupLastDay--;
+    }
+    rollupLastDay = INT_MIN;
 }
 
-// Gonderim Gecmisindeki Kargo Sayisini Bulma
-int countShipments(Shipment* shipment) {
-    if (shipment == NULL) {
+// Canli gecmisteki bir gonderinin durumunu degistirir (bulunamazsa 0).
+// Kayit kopyalanip yerine yayinlanir; surum korundugundan okuyucular kaydi
+// eski ya da yeni durumuyla gorur, hicbir zaman yarim yazilmis halde gormez.
+int updateShipmentStatus(int customerID, int shipmentID, const char* status) {
+    Customer* customer = findCustomer(customerID);
+    if (customer == NULL) {
+        return 0;
+    }
+
+    if (!loadCustomerHistory(customer)) {
+        return 0;
+    }
+    Shipment** link = &customer->shipmentHistory;
+    while (*link != NULL && (*link)->shipmentID != shipmentID) {
+        link = &(*link)->next;
+    }
+    Shipment* old = *link;
+    if (old == NULL) {
         return 0;
     }
-    return 1 + countShipments(shipment->next);
+    if (strcmp(old->status, status) == 0) {
+        return 1;
+    }
+
+    Shipment* updated = (Shipment*)safeMalloc(sizeof(Shipment));
+    *updated = *old;
+    strcpy(updated->status, status);
+    publishPointer(*link, updated);
+    bumpCommitVersion();
+    if (opLogActive) {
+        replaceLoggedShipment(old, updated);
+    }
+    retireMemory(old);
+
+    rollupRemove(statusRollup(old->status, 0), old->deliveryTime);
+    rollupAdd(statusRollup(status, 1), old->deliveryTime);
+    reclaimSnapshots();
+    return 1;
+}
+
+// endDay dahil son dayCount gunun ozetlerini out'a yazar (bos gunler count = 0).
+// Kopyalar outliers dizisini paylasmaz; min/max zaten kesindir.
+void collectDailyRollups(int endDay, int dayCount, DeliveryRollup* out) {
+    for (int i = 0; i < dayCount; i++) {
+        DeliveryRollup* rollup = dayRollup(endDay - dayCount + 1 + i, 0);
+        if (rollup != NULL) {
+            out[i] = *rollup;
+            out[i].outliers = NULL;
+            out[i].outlierCount = out[i].outlierCapacity = 0;
+        } else {
+            memset(&out[i], 0, sizeof(DeliveryRollup));
+        }
+    }
 }
 
-// Sehir Isimlerini Alfabetik Siralama
-void printCitiesAlphabetically(CityNode* node) {
-    if (node == NULL) {
+// Bugun dahil son dayCount gunun gunluk ozet tablosu
+void displayDailyRollups(int dayCount) {
+    if (rollupLastDay == INT_MIN) {
+        printf("Ozetlenecek gonderi yok.\n");
         return;
     }
 
-    // Cocuklari sirala
-    printCitiesAlphabetically(node->child);
+    int endDay = currentDay();
+    DeliveryRollup* days = (DeliveryRollup*)safeMalloc(dayCount * sizeof(DeliveryRollup));
+    collectDailyRollups(endDay, dayCount, days);
+
+    char date[11];
+    int shown = 0;
+    printf("Tarih       Adet    Ort.  Min  Max  p50  p95\n");
+    for (int i = 0; i < dayCount; i++) {
+        if (days[i].count == 0) continue;
+        daysToDate(endDay - dayCount + 1 + i, date);
+        printf("%s %6u %7.2f %4d %4d %4d %4d\n", date, days[i].count, (double)days[i].sum / days[i].count,
+               days[i].min, days[i].max, rollupPercentile(&days[i], 0.50), rollupPercentile(&days[i], 0.95));
+        shown++;
+    }
+    free(days);
+    if (shown == 0) {
+        printf("  Son %d gunde gonderi yok.\n", dayCount);
+    }
 
-    // Mevcut dugumu yazdir
-    printf("Sehir: %s (ID: %d)\n", node->cityName, node->cityID);
+    printf("Duruma gore:\n");
+    for (int i = 0; i < statusRollupCount; i++) {
+        DeliveryRollup* stats = &statusRollups[i].stats;
+        if (stats->count == 0) continue;
+        printf("  %-19s %6u adet, ort. %.2f gun, p95 %d gun\n", statusRollups[i].status, stats->count,
+               (double)stats->sum / stats->count, rollupPercentile(stats, 0.95));
+    }
+}
 
-    // Kardesleri sirala
-    printCitiesAlphabetically(node->sibling);
+void freeRollups() {
+    for (int i = 0; i < rollupPageCount; i++) {
+        if (rollupPages[i] == NULL) continue;
+        for (int day = 0; day < ROLLUP_PAGE_DAYS; day++) freeRollupOutliers(&rollupPages[i][day]);
+        free(rollupPages[i]);
+    }
+    free(rollupPages);
+    rollupPages = NULL;
+    rollupPageCount = 0;
+    rollupLastDay = INT_MIN;
+    for (int i = 0; i < statusRollupCount; i++) freeRollupOutliers(&statusRollups[i].stats);
+    free(statusRollups);
+    statusRollups = NULL;
+    statusRollupCount = 0;
 }
 
-// En Kisa Teslimat Suresi
-int calculateMinDeliveryTime(CityNode* node) {
-    if (node == NULL) {
-        return INT_MAX; // Sonsuz olarak varsayilan en buyuk deger
+// Toplu Islem Gunlugu (Geri Al / Yinele)
+//
+// beginBatch ile commitBatch arasindaki addShipment ve addCity cagrilari
+// gunluge ters islem olarak yazilir: gonderi icin musteri ve onceki dugum,
+// sehir icin ebeveyn ve ebeveynin onceki son cocugu. Eklenen dugum bu konumun
+// hemen arkasinda durdugundan geri alma tek baglanti degisikligidir; yineleme
+// ayni dugumu ayni yere geri baglar. Bir toplu islem O(islem sayisi) surede
+// geri alinir ya da yinelenir, hicbir kayit kopyalanmaz.
+//
+// Kayitlar ancak gunluk kendi eklemelerinin ustunde calistigi surece
+// gecerlidir: toplu islem disindaki ekleme, arsivleme, CSV aktarimi ve hub
+// kuyruklarinin kurulmasi gunlugu atar. Durum guncellemesi kaydi kopyalayarak
+// degistirdiginden gunlukteki isaretciler yenisine cevrilir (guncellemenin
+// kendisi geri alinmaz); gunlukteki musterilerin gecmisi diske tasinmaz.
+void appendOpLogEntry(int kind, int owner, void* node, void* before) {
+    if (opLog.end == opLog.capacity) {
+        opLog.capacity = opLog.capacity ? opLog.capacity * 2 : 256;
+        opLog.entries = (OpLogEntry*)safeRealloc(opLog.entries, opLog.capacity * sizeof(OpLogEntry));
+    }
+    if (kind == OPLOG_SHIPMENT) {
+        int slot = customerSlot(owner);
+        if (slot >= loggedShipmentCapacity) {
+            int newCapacity = customerTableCapacity > slot ? customerTableCapacity : slot + 1;
+            loggedShipmentCounts = (uint32_t*)safeRealloc(loggedShipmentCounts, newCapacity * sizeof(uint32_t));
+            memset(loggedShipmentCounts + loggedShipmentCapacity, 0,
+                   (newCapacity - loggedShipmentCapacity) * sizeof(uint32_t));
+            loggedShipmentCapacity = newCapacity;
+        }
+        loggedShipmentCounts[slot]++;
     }
+    OpLogEntry* entry = &opLog.entries[opLog.end++];
+    entry->kind = kind;
+    entry->owner = owner;
+    entry->node = node;
+    entry->before = before;
+    opLog.applied = opLog.end;
+}
 
-    int currentDeliveryTime = node->deliveryTime;
-    int childMinTime = calculateMinDeliveryTime(node->child);
-    int siblingMinTime = calculateMinDeliveryTime(node->sibling);
+// link, addShipment'in yeni gonderiyi yayinladigi baglantidir
+void logShipmentInsert(Customer* customer, Shipment* shipment, Shipment** link) {
+    if (opLog.openStart < 0) {
+        discardOpLog("toplu islem disinda ekleme yapildi");
+        return;
+    }
+    Shipment* before = link == &customer->shipmentHistory
+        ? NULL : (Shipment*)((char*)link - offsetof(Shipment, next));
+    appendOpLogEntry(OPLOG_SHIPMENT, customer->customerID, shipment, before);
+}
 
-    return currentDeliveryTime < childMinTime ?
-           (currentDeliveryTime < siblingMinTime ? currentDeliveryTime : siblingMinTime) :
-           (childMinTime < siblingMinTime ? childMinTime : siblingMinTime);
+void logCityInsert(int parentCityID, CityNode* city, CityNode* previousLastChild) {
+    if (opLog.openStart < 0) {
+        discardOpLog("toplu islem disinda ekleme yapildi");
+        return;
+    }
+    appendOpLogEntry(OPLOG_CITY, parentCityID, city, previousLastChild);
 }
 
-// Varsayilan Sehirler
-void initializeDefaultCities() {
-    // Istanbul'u kok olarak ekle
-    root = createCityNode(1, "Istanbul");
-    root->deliveryTime = 1;
-	printf("Kargo merkezi olarak Istanbul (ID: 1) eklendi.\n");
-
-    // Ilk seviye sehirler
-    addCity(1, 2, "Tekirdag", 2); // Istanbul'un altinda
-    addCity(1, 3, "Edirne", 3);   // Istanbul'un altinda
-    addCity(1, 4, "Kirklareli", 4); // Istanbul'un altinda
-
-    // Istanbul'dan daha uzak olan sehirler
-    addCity(1, 5, "Bursa", 5); // Istanbul'un altinda
-    addCity(5, 6, "Canakkale", 6); // Bursa'nin altinda
-    addCity(5, 7, "Balikesir", 4);     // Bursa'nin altinda
-    addCity(5, 11, "Bilecik", 5);   // Bursa'nin altinda
-
-    // Sakarya ve cevresi
-    addCity(1, 8, "Sakarya", 3);    // Istanbul'un altinda
-    addCity(8, 9, "Kocaeli", 2);    // Sakarya'nin altinda
-    addCity(9, 10, "Yalova", 3);    // Kocaeli'nin altinda
+void undoOpLogEntry(const OpLogEntry* entry) {
+    if (entry->kind == OPLOG_SHIPMENT) {
+        Customer* customer = findCustomer(entry->owner);
+        Shipment* shipment = (Shipment*)entry->node;
+        Shipment* before = (Shipment*)entry->before;
+        Shipment** link = before != NULL ? &before->next : &customer->shipmentHistory;
+        publishPointer(*link, shipment->next); // Okuyucu dugumdeyse next hala gecerli
+        bumpCommitVersion();
 
-    printf("Varsayilan sehirler ve iliskiler basariyla eklendi.\n");
+        forgetShipmentRollup(entry->owner, shipment);
+        return;
+    }
+
+    // Sonraki eklemeler once geri alindigindan sehir yapraktir ve son cocuktur
+    CityNode* city = (CityNode*)entry->node;
+    CityNode* before = (CityNode*)entry->before;
+    if (entry->owner == 0) {
+        publishPointer(root, NULL);
+    } else {
+        if (before == NULL) {
+            publishPointer(findCityByID(entry->owner)->child, NULL);
+        } else {
+            publishPointer(before->sibling, NULL);
+        }
+        cityIndexEntry(&cityIndex, entry->owner)->lastChild = before;
+    }
+    cityIndexEntry(&cityIndex, city->cityID)->city = NULL;
 }
 
-// Ana fonksiyon
-int main() {
-	initializeDefaultCities();
+void redoOpLogEntry(const OpLogEntry* entry) {
+    if (entry->kind == OPLOG_SHIPMENT) {
+        Customer* customer = findCustomer(entry->owner);
+        Shipment* shipment = (Shipment*)entry->node;
+        Shipment* before = (Shipment*)entry->before;
+        Shipment** link = before != NULL ? &before->next : &customer->shipmentHistory;
+        shipment->next = *link;
+        shipment->version = beginWrite();
+        publishPointer(*link, shipment);
+        commitWrite();
+        recordShipmentRollup(entry->owner, shipment);
+        return;
+    }
+
+    CityNode* city = (CityNode*)entry->node;
+    CityNode* before = (CityNode*)entry->before;
+    city->version = beginWrite();
+    CityIndexEntry* cityEntry = reserveCityIndex(&cityIndex, city->cityID);
+    cityEntry->city = city;
+    cityEntry->parentCityID = entry->owner;
+    if (entry->owner == 0) {
+        publishPointer(root, city);
+    } else {
+        if (before == NULL) {
+            publishPointer(findCityByID(entry->owner)->child, city);
+        } else {
+            publishPointer(before->sibling, city);
+        }
+        cityIndexEntry(&cityIndex, entry->owner)->lastChild = city;
+    }
+    commitWrite();
+}
+
+// Yinelenebilir kayitlarin dugumlerini serbest birakir (okuyucular bitince)
+void dropRedoEntries() {
+    if (opLog.applied == opLog.end) {
+        return;
+    }
+    for (int i = opLog.applied; i < opLog.end; i++) {
+        OpLogEntry* entry = &opLog.entries[i];
+        retireMemory(entry->node);
+        if (entry->kind == OPLOG_SHIPMENT) {
+            loggedShipmentCounts[customerSlot(entry->owner)]--;
+            trackMemory(MEMORY_HISTORIES, -(long)sizeof(Shipment));
+        } else {
+            trackMemory(MEMORY_CITIES, -(long)sizeof(CityNode));
+        }
+    }
+    opLog.end = opLog.applied;
+    opLog.batchEnd = opLog.appliedBatches;
+    reclaimSnapshots();
+}
+
+// Yeni toplu islem acar; zaten acik bir islem varsa 0 doner.
+// Yinelenebilir islemler atilir (yeni eklemeler onlarin yerini alir).
+int beginBatch() {
+    if (opLog.openStart >= 0) {
+        return 0;
+    }
+    dropRedoEntries();
+    opLog.openStart = opLog.end;
+    opLogActive = 1;
+    return 1;
+}
+
+// Acik toplu islemi kapatir ve kayit sayisini doner (acik islem yoksa -1).
+// Bos islem geri alma gecmisine yazilmaz.
+int commitBatch() {
+    if (opLog.openStart < 0) {
+        return -1;
+    }
+    int count = opLog.end - opLog.openStart;
+    if (count > 0) {
+        if (opLog.batchEnd == opLog.batchCapacity) {
+            opLog.batchCapacity = opLog.batchCapacity ? opLog.batchCapacity * 2 : 16;
+            opLog.batchStarts = (int*)safeRealloc(opLog.batchStarts, opLog.batchCapacity * sizeof(int));
+        }
+        opLog.batchStarts[opLog.batchEnd++] = opLog.openStart;
+        opLog.appliedBatches = opLog.batchEnd;
+    }
+    opLog.openStart = -1;
+    opLogActive = opLog.end > 0;
+    return count;
+}
+
+// Acik toplu islemin eklemelerini geri alip dugumlerini birakir (acik islem yoksa -1)
+int rollbackBatch() {
+    if (opLog.openStart < 0) {
+        return -1;
+    }
+    int count = opLog.end - opLog.openStart;
+    for (int i = opLog.end - 1; i >= opLog.openStart; i--) {
+        undoOpLogEntry(&opLog.entries[i]);
+    }
+    opLog.applied = opLog.openStart;
+    opLog.batchEnd = opLog.appliedBatches; // Acik islem batchStarts'a yazilmamisti
+    dropRedoEntries();
+    opLog.openStart = -1;
+    opLogActive = opLog.end > 0;
+    return count;
+}
+
+// Son uygulanan toplu islemi geri alir; kayit sayisini doner (yoksa ya da islem acikken -1)
+int undoBatch() {
+    if (opLog.openStart >= 0 || opLog.appliedBatches == 0) {
+        return -1;
+    }
+    int start = opLog.batchStarts[--opLog.appliedBatches];
+    int count = opLog.applied - start;
+    for (int i = opLog.applied - 1; i >= start; i--) {
+        undoOpLogEntry(&opLog.entries[i]);
+    }
+    opLog.applied = start;
+    return count;
+}
+
+// Son geri alinan toplu islemi yeniden uygular; kayit sayisini doner (yoksa -1)
+int redoBatch() {
+    if (opLog.openStart >= 0 || opLog.appliedBatches == opLog.batchEnd) {
+        return -1;
+    }
+    opLog.appliedBatches++;
+    int stop = opLog.appliedBatches < opLog.batchEnd ? opLog.batchStarts[opLog.appliedBatches] : opLog.end;
+    int count = stop - opLog.applied;
+    for (int i = opLog.applied; i < stop; i++) {
+        redoOpLogEntry(&opLog.entries[i]);
+    }
+    opLog.applied = stop;
+    return count;
+}
+
+// Durum guncellemesi old'u updated ile degistirdi; gunlukteki isaretcileri tasir
+void replaceLoggedShipment(const Shipment* old, Shipment* updated) {
+    for (int i = 0; i < opLog.end; i++) {
+        OpLogEntry* entry = &opLog.entries[i];
+        if (entry->kind != OPLOG_SHIPMENT) continue;
+        if (entry->node == old) entry->node = updated;
+        if (entry->before == old) entry->before = updated;
+    }
+}
+
+// Gunlukte gonderisi olan musterinin gecmisi diske tasinmamali
+int isLoggedCustomer(int customerID) {
+    int slot = customerSlot(customerID);
+    return slot < loggedShipmentCapacity && loggedShipmentCounts[slot] > 0;
+}
+
+// Gecmisi gunlugun bilmedigi bicimde degistiren islemlerden once cagrilir.
+// Uygulanmis eklemeler yerinde kalir, yalnizca geri alinamaz hale gelir.
+void discardOpLog(const char* reason) {
+    if (opLog.openStart >= 0) {
+        printf("Acik toplu islem kapatildi ve artik geri alinamaz (%s).\n", reason);
+    } else if (opLog.end > 0) {
+        printInfo("Geri alma gecmisi silindi (%s).\n", reason);
+    }
+    dropRedoEntries();
+    for (int i = 0; i < opLog.end; i++) {
+        if (opLog.entries[i].kind == OPLOG_SHIPMENT) {
+            loggedShipmentCounts[customerSlot(opLog.entries[i].owner)]--;
+        }
+    }
+    opLog.applied = opLog.end = 0;
+    opLog.appliedBatches = opLog.batchEnd = 0;
+    opLog.openStart = -1;
+    opLogActive = 0;
+}
+
+// Cikista: yinelenebilir dugumler hicbir yapiya bagli olmadigindan burada birakilir
+void freeOpLog() {
+    for (int i = opLog.applied; i < opLog.end; i++) {
+        free(opLog.entries[i].node);
+    }
+    free(opLog.entries);
+    free(opLog.batchStarts);
+    free(loggedShipmentCounts);
+    loggedShipmentCounts = NULL;
+    loggedShipmentCapacity = 0;
+    memset(&opLog, 0, sizeof(opLog));
+    opLog.openStart = -1;
+    opLogActive = 0;
+}
+
+// Arsiv Katmani (Teslim Edilmis Eski Gonderiler)
+//
+// Blok icindeki her kayit: [gun farki][zigzag ID farki][teslim suresi], hepsi varint.
+// Durum her zaman "Teslim Edildi" oldugu icin saklanmaz.
+uint32_t encodeVarint(unsigned char* out, uint32_t value) {
+    uint32_t length = 0;
+    while (value >= 0x80) {
+        out[length++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (unsigned char)value;
+    return length;
+}
+
+uint32_t decodeVarint(const unsigned char* data, uint32_t* offset) {
+    uint32_t value = 0;
+    int shift = 0;
+    unsigned char byte;
+    do {
+        byte = data[(*offset)++];
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return value;
+}
+
+// Siralanmis gonderilerden tek bir blok olusturur
+ArchiveBlock* encodeArchiveBlock(Shipment** shipments, int count) {
+    unsigned char buffer[ARCHIVE_BLOCK_CAPACITY * 15];
+    uint32_t length = 0;
+    int firstDay = dateToDays(shipments[0]->date);
+    int previousDay = firstDay;
+    int previousID = 0;
+
+    for (int i = 0; i < count; i++) {
+        int day = dateToDays(shipments[i]->date);
+        int idDelta = shipments[i]->shipmentID - previousID;
+        length += encodeVarint(buffer + length, (uint32_t)(day - previousDay));
+        length += encodeVarint(buffer + length, ((uint32_t)idDelta << 1) ^ (uint32_t)(idDelta >> 31));
+        length += encodeVarint(buffer + length, (uint32_t)shipments[i]->deliveryTime);
+        previousDay = day;
+        previousID = shipments[i]->shipmentID;
+    }
+
+    ArchiveBlock* block = (ArchiveBlock*)safeMalloc(sizeof(ArchiveBlock) + length);
+    block->firstDay = firstDay;
+    block->lastDay = previousDay;
+    block->count = count;
+    block->byteLength = length;
+    block->next = NULL;
+    memcpy(block->bytes, buffer, length);
+    return block;
+}
+
+ArchiveBlock** customerArchive(const Customer* customer) {
+    return customer->archive ? &archiveHeads[customer->archive] : NULL;
+}
+
+// Musteriye arsiv listesi atar (yoksa)
+ArchiveBlock** ensureCustomerArchive(Customer* customer) {
+    if (customer->archive == 0) {
+        if (archiveHeadCount == archiveHeadCapacity) {
+            archiveHeadCapacity = archiveHeadCapacity ? archiveHeadCapacity * 2 : 64;
+            archiveHeads = (ArchiveBlock**)safeRealloc(archiveHeads, archiveHeadCapacity * sizeof(ArchiveBlock*));
+            trackMemory(MEMORY_HISTORIES, (long)(archiveHeadCapacity - archiveHeadCount) * sizeof(ArchiveBlock*));
+            if (archiveHeadCount == 0) {
+                archiveHeads[archiveHeadCount++] = NULL; // 0 = arsiv yok
+            }
+        }
+        customer->archive = archiveHeadCount;
+        archiveHeads[archiveHeadCount++] = NULL;
+    }
+    return &archiveHeads[customer->archive];
+}
+
+// Blogu, ilk gune gore sirali arsiv listesine yerlestirir
+void insertArchiveBlock(ArchiveBlock** head, ArchiveBlock* block) {
+    while (*head != NULL && (*head)->firstDay <= block->firstDay) {
+        head = &(*head)->next;
+    }
+    block->next = *head;
+    *head = block;
+}
+
+// Teslim edilmis ve cutoffDate'ten eski gonderileri sikistirilmis bloklara tasir.
+// Arsivlenen gonderi sayisini doner.
+long archiveDeliveredShipments(const char* cutoffDate, size_t* freedBytes, size_t* archivedBytes) {
+    if (opLogActive) {
+        discardOpLog("arsivleme gecmisleri degistirdi");
+    }
+    int cutoffDay = dateToDays(cutoffDate);
+    Shipment** candidates = NULL;
+    int candidateCapacity = 0;
+    long archived = 0;
+
+    for (Customer* customer = customerList; customer != NULL; customer = customer->next) {
+        int candidateCount = 0;
+
+        // Uygun dugumleri canli listeden cikar. Diske tasinmis gecmisler atlanir:
+        // bellekte yer tutmazlar ve geri okumak tavani asardi; bellege
+        // dondukten sonraki ilk arsivlemede ele alinirlar.
+        if (isSpilledHistory(customer->shipmentHistory)) {
+            continue;
+        }
+        Shipment** link = &customer->shipmentHistory;
+        while (*link != NULL) {
+            Shipment* shipment = *link;
+            if (strcmp(shipment->status, "Teslim Edildi") == 0 && dateToDays(shipment->date) < cutoffDay) {
+                if (candidateCount == candidateCapacity) {
+                    candidateCapacity = candidateCapacity ? candidateCapacity * 2 : 256;
+                    candidates = (Shipment**)safeRealloc(candidates, candidateCapacity * sizeof(Shipment*));
+                }
+                candidates[candidateCount++] = shipment;
+                publishPointer(*link, shipment->next);
+            } else {
+                link = &shipment->next;
+            }
+        }
+
+        if (candidateCount == 0) {
+            continue;
+        }
+        bumpCommitVersion();
+
+        shipmentsByDateIDSortArray(candidates, (size_t)candidateCount);
+
+        ArchiveBlock** head = ensureCustomerArchive(customer);
+        for (int start = 0; start < candidateCount; start += ARCHIVE_BLOCK_CAPACITY) {
+            int count = candidateCount - start < ARCHIVE_BLOCK_CAPACITY ? candidateCount - start : ARCHIVE_BLOCK_CAPACITY;
+            ArchiveBlock* block = encodeArchiveBlock(candidates + start, count);
+            *archivedBytes += sizeof(ArchiveBlock) + block->byteLength;
+            trackMemory(MEMORY_HISTORIES, sizeof(ArchiveBlock) + block->byteLength);
+            insertArchiveBlock(head, block);
+            head = ensureCustomerArchive(customer); // archiveHeads yeniden ayrilmis olabilir
+        }
+
+        for (int i = 0; i < candidateCount; i++) {
+            retireMemory(candidates[i]); // Okuyucular bitince serbest birakilir
+        }
+        *freedBytes += (size_t)candidateCount * sizeof(Shipment);
+        trackMemory(MEMORY_HISTORIES, -(long)(candidateCount * sizeof(Shipment)));
+        archived += candidateCount;
+    }
+
+    free(candidates);
+    reclaimSnapshots();
+    return archived;
+}
+
+void openArchiveCursor(ArchiveCursor* cursor, const ArchiveBlock* block) {
+    cursor->block = block;
+    cursor->offset = 0;
+    cursor->index = 0;
+    cursor->day = block ? block->firstDay : 0;
+    cursor->shipmentID = 0;
+}
+
+// Siradaki arsiv kaydini out'a cozer; kayit kalmadiysa 0 doner
+int nextArchivedShipment(ArchiveCursor* cursor, Shipment* out) {
+    while (cursor->block != NULL && cursor->index == cursor->block->count) {
+        openArchiveCursor(cursor, cursor->block->next);
+    }
+    if (cursor->block == NULL) {
+        return 0;
+    }
+
+    const unsigned char* data = cursor->block->bytes;
+    cursor->day += (int)decodeVarint(data, &cursor->offset);
+    uint32_t zigzag = decodeVarint(data, &cursor->offset);
+    cursor->shipmentID += (int)((zigzag >> 1) ^ -(zigzag & 1));
+    cursor->index++;
+
+    out->shipmentID = cursor->shipmentID;
+    daysToDate(cursor->day, out->date);
+    strcpy(out->status, "Teslim Edildi");
+    out->deliveryTime = (int)decodeVarint(data, &cursor->offset);
+    out->next = NULL;
+    return 1;
+}
+
+// Tarih araligi hedefi kapsamayan bloklar cozulmeden atlanir
+int searchArchivedShipments(const Customer* customer, const char* targetDate, Shipment* out) {
+    ArchiveBlock** head = customerArchive(customer);
+    if (head == NULL) {
+        return 0;
+    }
+
+    int targetDay = dateToDays(targetDate);
+    for (ArchiveBlock* block = *head; block != NULL; block = block->next) {
+        if (block->firstDay > targetDay) {
+            break; // Bloklar ilk gune gore sirali
+        }
+        if (block->lastDay < targetDay) {
+            continue;
+        }
+
+        ArchiveCursor cursor;
+        openArchiveCursor(&cursor, block);
+        while (cursor.index < block->count && nextArchivedShipment(&cursor, out)) {
+            if (cursor.day == targetDay) {
+                return 1;
+            }
+            if (cursor.day > targetDay) {
+                break;
+            }
+        }
+    }
+    return 0;
+}
+
+int countArchivedShipments(const Customer* customer) {
+    ArchiveBlock** head = customerArchive(customer);
+    int count = 0;
+    for (ArchiveBlock* block = head ? *head : NULL; block != NULL; block = block->next) {
+        count += block->count;
+    }
+    return count;
+}
+
+// Canli ve arsivlenmis gonderilerin toplami
+// Arsivdekiler dahil toplam gonderi sayisi, O(1)
+int countCustomerShipments(const Customer* customer) {
+    return customerShipmentCounts[customerSlot(customer->customerID)];
+}
+
+void freeArchive() {
+    for (uint32_t i = 1; i < archiveHeadCount; i++) {
+        while (archiveHeads[i] != NULL) {
+            ArchiveBlock* temp = archiveHeads[i];
+            archiveHeads[i] = temp->next;
+            free(temp);
+        }
+    }
+    free(archiveHeads);
+    archiveHeads = NULL;
+    archiveHeadCount = archiveHeadCapacity = 0;
+}
+
+// Bellek Muhasebesi ve Disk Tasmasi (Spill)
+//
+// Tasinan gecmisin kayitlari sabit boyutlu SpillRecord olarak segment dosyasinin
+// sonuna eklenir ve Customer->shipmentHistory, en dusuk biti 1 olan ve
+// SpillExtent'i gosteren etiketli bir isaretciye cevrilir. Yazici gecmise
+// customerHistory ile erisir; tasinmis gecmis o anda geri okunur. Okuyucular
+// etiketi gorunce kayitlari pread ile dogrudan dosyadan okur.
+// Geri okunan kayitlarin yeri, okuyucular kapsamdan cikinca (bekleme listesi
+// etiketli kapsami serbest birakirken) bos araliklar listesine doner ve sonraki
+// tasimalarda ilk uyan aralik kullanilir. Dosya sonundaki bos aralik kirpilir.
+#define SPILL_TAG ((uintptr_t)1)
+#define SPILL_BATCH 256  // Tek pwrite/pread ile aktarilan en fazla kayit
+#define SPILL_VICTIMS 64 // Bir turda secilen en eski gecmis sayisi
+
+typedef struct SpillRecord {
+    int32_t shipmentID;
+    int32_t deliveryTime;
+    uint32_t version;
+    char date[11];
+    char status[20];
+} SpillRecord;
+
+typedef struct SpillExtent {
+    off_t offset;   // Ilk kaydin dosyadaki yeri
+    uint32_t count; // Ardisik kayit sayisi (tarih sirasinda)
+} SpillExtent;
+
+// Yeniden kullanilabilir kayit araligi; dizi ofset sirasinda, komsular birlesik
+typedef struct SpillHole {
+    off_t offset;
+    uint32_t count;
+} SpillHole;
+
+int spillFd = -1;
+const char* spillPath = NULL; // --spill-file (NULL: /tmp altinda adsiz gecici dosya)
+off_t spillFileSize = 0;
+off_t spillGarbageBytes = 0;  // Geri okunmus, artik kullanilmayan kayitlar (bos araliklar dahil)
+SpillHole* spillHoles = NULL;
+int spillHoleCount = 0;
+int spillHoleCapacity = 0;
+long spilledCustomers = 0;
+long spilledShipments = 0;
+long spillCount = 0;
+long pageInCount = 0;
+uint32_t accessClock = 0;
+
+void trackMemory(MemoryCategory category, long delta) {
+    memoryUsage[category] += (size_t)delta;
+}
+
+size_t totalMemoryUsage() {
+    size_t total = 0;
+    for (int i = 0; i < MEMORY_CATEGORY_COUNT; i++) total += memoryUsage[i];
+    return total;
+}
+
+int isSpilledHistory(const Shipment* history) {
+    return ((uintptr_t)history & SPILL_TAG) != 0;
+}
+
+SpillExtent* spillExtentOf(const Shipment* history) {
+    return (SpillExtent*)((uintptr_t)history & ~SPILL_TAG);
+}
+
+int openSpillSegment() {
+    if (spillFd >= 0) {
+        return 1;
+    }
+
+    int fd;
+    if (spillPath != NULL) {
+        fd = open(spillPath, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    } else {
+        char path[] = "/tmp/kargo-spill-XXXXXX";
+        fd = mkstemp(path);
+        if (fd >= 0) unlink(path); // Dosya kapaninca kendiliginden silinir
+    }
+    if (fd < 0) {
+        printError("Tasma dosyasi acilamadi.");
+        return 0;
+    }
+    __atomic_store_n(&spillFd, fd, __ATOMIC_RELEASE);
+    return 1;
+}
+
+// Kayitlari dosyaya yazar ya da dosyadan okur; kismi aktarimlarda devam eder
+int transferSpillRecords(int fd, SpillRecord* records, int count, off_t offset, int writing) {
+    char* bytes = (char*)records;
+    size_t remaining = (size_t)count * sizeof(SpillRecord);
+    while (remaining > 0) {
+        ssize_t done = writing ? pwrite(fd, bytes, remaining, offset) : pread(fd, bytes, remaining, offset);
+        if (done < 0 && errno == EINTR) continue;
+        if (done <= 0) return 0;
+        bytes += done;
+        offset += done;
+        remaining -= (size_t)done;
+    }
+    return 1;
+}
+
+// count kayitlik yer ayirir: ilk uyan bos aralik, yoksa dosya sonu
+off_t allocateSpillRange(uint32_t count) {
+    for (int i = 0; i < spillHoleCount; i++) {
+        SpillHole* hole = &spillHoles[i];
+        if (hole->count < count) continue;
+        off_t offset = hole->offset;
+        hole->offset += (off_t)(count * sizeof(SpillRecord));
+        hole->count -= count;
+        if (hole->count == 0) {
+            memmove(hole, hole + 1, (spillHoleCount - i - 1) * sizeof(SpillHole));
+            spillHoleCount--;
+        }
+        spillGarbageBytes -= (off_t)(count * sizeof(SpillRecord));
+        return offset;
+    }
+    off_t offset = spillFileSize;
+    spillFileSize += (off_t)(count * sizeof(SpillRecord));
+    return offset;
+}
+
+// Hicbir okuyucunun artik okuyamayacagi araligi bos listeye ekler (spillGarbageBytes'ta
+// zaten sayilmis olmali). Komsu araliklarla birlesir; dosya sonundaysa dosya kirpilir.
+void releaseSpillRange(off_t offset, uint32_t count) {
+    off_t end = offset + (off_t)(count * sizeof(SpillRecord));
+    int index = 0;
+    while (index < spillHoleCount && spillHoles[index].offset < offset) index++;
+
+    if (index > 0 && spillHoles[index - 1].offset + (off_t)(spillHoles[index - 1].count * sizeof(SpillRecord)) == offset) {
+        index--;
+        spillHoles[index].count += count;
+    } else {
+        if (spillHoleCount == spillHoleCapacity) {
+            spillHoleCapacity = spillHoleCapacity ? spillHoleCapacity * 2 : 64;
+            spillHoles = (SpillHole*)safeRealloc(spillHoles, spillHoleCapacity * sizeof(SpillHole));
+        }
+        memmove(&spillHoles[index + 1], &spillHoles[index], (spillHoleCount - index) * sizeof(SpillHole));
+        spillHoles[index].offset = offset;
+        spillHoles[index].count = count;
+        spillHoleCount++;
+    }
+    if (index + 1 < spillHoleCount && spillHoles[index + 1].offset == end) {
+        spillHoles[index].count += spillHoles[index + 1].count;
+        memmove(&spillHoles[index + 1], &spillHoles[index + 2], (spillHoleCount - index - 2) * sizeof(SpillHole));
+        spillHoleCount--;
+    }
+
+    SpillHole* last = &spillHoles[spillHoleCount - 1];
+    if (last->offset + (off_t)(last->count * sizeof(SpillRecord)) == spillFileSize) {
+        spillFileSize = last->offset;
+        spillGarbageBytes -= (off_t)(last->count * sizeof(SpillRecord));
+        spillHoleCount--;
+        if (ftruncate(spillFd, spillFileSize) != 0) {
+            // Kirpma yalnizca disk alanini geri verir; basarisizlik zararsizdir
+        }
+    }
+}
+
+void releaseSpillExtent(SpillExtent* extent) {
+    releaseSpillRange(extent->offset, extent->count);
+    free(extent);
+}
+
+// Bekleme listesi etiketli kapsami okuyucular cikinca buraya verir
+void releaseRetiredSpillExtent(void* tagged) {
+    releaseSpillExtent(spillExtentOf(tagged));
+}
+
+// Musterinin canli gecmisini segmente yazar; dugumler okuyucular bitince serbest kalir
+int spillCustomerHistory(Customer* customer) {
+    Shipment* history = customer->shipmentHistory;
+    if (history == NULL || isSpilledHistory(history) || !openSpillSegment()) {
+        return 0;
+    }
+
+    uint32_t total = 0;
+    for (Shipment* shipment = history; shipment != NULL; shipment = shipment->next) total++;
+    off_t start = allocateSpillRange(total);
+
+    SpillRecord batch[SPILL_BATCH];
+    int batchCount = 0;
+    uint32_t count = 0;
+    for (Shipment* shipment = history; shipment != NULL; shipment = shipment->next) {
+        SpillRecord* record = &batch[batchCount++];
+        memset(record, 0, sizeof(*record));
+        record->shipmentID = shipment->shipmentID;
+        record->deliveryTime = shipment->deliveryTime;
+        record->version = shipment->version;
+        memcpy(record->date, shipment->date, sizeof(record->date));
+        memcpy(record->status, shipment->status, sizeof(record->status));
+
+        if (batchCount == SPILL_BATCH || shipment->next == NULL) {
+            off_t offset = start + (off_t)(count * sizeof(SpillRecord));
+            if (!transferSpillRecords(spillFd, batch, batchCount, offset, 1)) {
+                printError("Tasma dosyasina yazilamadi.");
+                spillGarbageBytes += (off_t)(total * sizeof(SpillRecord));
+                releaseSpillRange(start, total); // Gecmis bellekte kalir; aralik sonraki tasimada ezilir
+                return 0;
+            }
+            count += batchCount;
+            batchCount = 0;
+        }
+    }
+
+    SpillExtent* extent = (SpillExtent*)safeMalloc(sizeof(SpillExtent));
+    extent->offset = start;
+    extent->count = count;
+    publishPointer(customer->shipmentHistory, (Shipment*)((uintptr_t)extent | SPILL_TAG));
+    bumpCommitVersion();
+
+    while (history != NULL) {
+        Shipment* next = history->next;
+        retireMemory(history);
+        history = next;
+    }
+
+    trackMemory(MEMORY_HISTORIES, (long)sizeof(SpillExtent) - (long)(count * sizeof(Shipment)));
+    spilledCustomers++;
+    spilledShipments += count;
+    spillCount++;
+    return 1;
+}
+
+// Tasinmis gecmisi dosyadan okuyup canli listeye geri cevirir. Okuma ya da
+// bellek ayirma basarisiz olursa 0 doner; gecmis tasinmis halde kalir.
+int pageInCustomerHistory(Customer* customer) {
+    SpillExtent* extent = spillExtentOf(customer->shipmentHistory);
+    uint32_t total = extent->count;
+    Shipment* head = NULL;
+    Shipment** tail = &head;
+    SpillRecord batch[SPILL_BATCH];
+
+    for (uint32_t done = 0; done < total; ) {
+        int count = total - done < SPILL_BATCH ? (int)(total - done) : SPILL_BATCH;
+        int ok = transferSpillRecords(spillFd, batch, count, extent->offset + (off_t)(done * sizeof(SpillRecord)), 0);
+        if (!ok) {
+            printError("Tasma dosyasi okunamadi.");
+        }
+        for (int i = 0; ok && i < count; i++) {
+            Shipment* shipment = (Shipment*)malloc(sizeof(Shipment));
+            if (shipment == NULL) {
+                printError("Gecmisi geri yuklemek icin bellek yetersiz.");
+                ok = 0;
+                break;
+            }
+            shipment->shipmentID = batch[i].shipmentID;
+            shipment->deliveryTime = batch[i].deliveryTime;
+            shipment->version = batch[i].version;
+            memcpy(shipment->date, batch[i].date, sizeof(shipment->date));
+            memcpy(shipment->status, batch[i].status, sizeof(shipment->status));
+            *tail = shipment;
+            tail = &shipment->next;
+        }
+        if (!ok) {
+            *tail = NULL;
+            freeShipmentHistory(head);
+            return 0;
+        }
+        done += count;
+    }
+    *tail = NULL;
+
+    publishPointer(customer->shipmentHistory, head);
+    bumpCommitVersion();
+    retireMemory((void*)((uintptr_t)extent | SPILL_TAG)); // Okuyucular hala dosyadan okuyor olabilir
+
+    trackMemory(MEMORY_HISTORIES, (long)(total * sizeof(Shipment)) - (long)sizeof(SpillExtent));
+    spillGarbageBytes += (off_t)(total * sizeof(SpillRecord));
+    spilledCustomers--;
+    spilledShipments -= total;
+    pageInCount++;
+    return 1;
+}
+
+// Okuyucular icin: tasinmis gecmisin start'tan itibaren en fazla max kaydini
+// out'a okur ve okunan sayiyi doner (bittiyse veya okuma hatasinda 0)
+int readSpilledShipments(const Shipment* history, uint32_t start, Shipment* out, int max) {
+    const SpillExtent* extent = spillExtentOf(history);
+    if (start >= extent->count) {
+        return 0;
+    }
+
+    SpillRecord batch[SPILL_BATCH];
+    int count = extent->count - start < (uint32_t)max ? (int)(extent->count - start) : max;
+    if (count > SPILL_BATCH) count = SPILL_BATCH;
+    int fd = __atomic_load_n(&spillFd, __ATOMIC_ACQUIRE);
+    if (!transferSpillRecords(fd, batch, count, extent->offset + (off_t)(start * sizeof(SpillRecord)), 0)) {
+        return 0;
+    }
+
+    for (int i = 0; i < count; i++) {
+        out[i].shipmentID = batch[i].shipmentID;
+        out[i].deliveryTime = batch[i].deliveryTime;
+        out[i].version = batch[i].version;
+        memcpy(out[i].date, batch[i].date, sizeof(out[i].date));
+        memcpy(out[i].status, batch[i].status, sizeof(out[i].status));
+        out[i].next = NULL;
+    }
+    return count;
+}
+
+// Yazicinin gecmise erisim noktasi: tasinmissa geri okur, LRU damgasini gunceller.
+// Tavan burada uygulanmaz; liste bir sonraki guvenli noktaya kadar bellekte
+// kalir ve o noktada da en son erisilen gecmis olarak tasinmaz. Gecmis geri
+// okunamazsa 0 doner; gecmisi degistirecek cagiranlar bunu sinamalidir.
+int loadCustomerHistory(Customer* customer) {
+    pinnedCustomer = customer;
+    customerLastAccess[customerSlot(customer->customerID)] = ++accessClock;
+    if (isSpilledHistory(customer->shipmentHistory)) {
+        return pageInCustomerHistory(customer);
+    }
+    return 1;
+}
+
+// Salt okuyan yazici yollari icin: geri okunamayan gecmis bos liste olarak gorulur
+Shipment* customerHistory(Customer* customer) {
+    return loadCustomerHistory(customer) ? customer->shipmentHistory : NULL;
+}
+
+int compareLastAccess(const void* a, const void* b) {
+    uint32_t x = customerLastAccess[customerSlot((*(Customer* const*)a)->customerID)];
+    uint32_t y = customerLastAccess[customerSlot((*(Customer* const*)b)->customerID)];
+    return (x > y) - (x < y);
+}
+
+// Toplam kullanim targetBytes'a inene kadar en eski gecmisleri tasir.
+// Her turda musteri tablosu bir kez taranir ve en eski SPILL_VICTIMS gecmis
+// secilir (damgaya gore max-yigin); boylece ek bellek ayrilmaz.
+long spillLeastRecentHistories(size_t targetBytes) {
+    long spilled = 0;
+    Customer* victims[SPILL_VICTIMS];
+    while (totalMemoryUsage() > targetBytes) {
+        int victimCount = 0;
+        int slotCount = customerSlot(autoCustomerID);
+        for (int slot = 1; slot < slotCount && slot < customerTableCapacity; slot++) {
+            Customer* customer = customerTable[slot];
+            if (customer == NULL || customer == pinnedCustomer || customer->shipmentHistory == NULL ||
+                isSpilledHistory(customer->shipmentHistory) ||
+                (opLogActive && isLoggedCustomer(customer->customerID))) { // Gunlukteki dugumler yerinde kalmali
+                continue;
+            }
+
+            uint32_t stamp = customerLastAccess[slot];
+            int index;
+            if (victimCount < SPILL_VICTIMS) {
+                index = victimCount++;
+                while (index > 0 && customerLastAccess[customerSlot(victims[(index - 1) / 2]->customerID)] < stamp) {
+                    victims[index] = victims[(index - 1) / 2];
+                    index = (index - 1) / 2;
+                }
+            } else if (stamp < customerLastAccess[customerSlot(victims[0]->customerID)]) {
+                index = 0;
+                while (1) {
+                    int child = 2 * index + 1;
+                    if (child >= victimCount) break;
+                    if (child + 1 < victimCount &&
+                        customerLastAccess[customerSlot(victims[child + 1]->customerID)] >
+                        customerLastAccess[customerSlot(victims[child]->customerID)]) {
+                        child++;
+                    }
+                    if (customerLastAccess[customerSlot(victims[child]->customerID)] <= stamp) break;
+                    victims[index] = victims[child];
+                    index = child;
+                }
+            } else {
+                continue;
+            }
+            victims[index] = customer;
+        }
+        if (victimCount == 0) {
+            break; // Tasinabilecek gecmis kalmadi
+        }
+
+        qsort(victims, victimCount, sizeof(Customer*), compareLastAccess);
+        long before = spilled;
+        for (int i = 0; i < victimCount && totalMemoryUsage() > targetBytes; i++) {
+            spilled += spillCustomerHistory(victims[i]);
+        }
+        if (spilled == before) {
+            break; // Dosyaya yazilamiyor
+        }
+        reclaimRetiredMemory(); // Bekleme listesi kisa kalsin, bellek tur tur geri donsun
+    }
+    return spilled;
+}
+
+// Toplam kullanim tavani asarsa en eski gecmisleri tavanin %90'ina inene kadar tasir.
+// Yalnizca guvenli noktalardan cagrilir: menu secimi, sunucu istegi ve toplu
+// aktarimin yazma penceresi kapandiktan sonra.
+void enforceMemoryCeiling() {
+    if (memoryCeiling == 0 || totalMemoryUsage() <= memoryCeiling) {
+        return;
+    }
+    spillLeastRecentHistories(memoryCeiling / 10 * 9);
+}
+
+void freeShipmentHistory(Shipment* history) {
+    if (isSpilledHistory(history)) {
+        SpillExtent* extent = spillExtentOf(history);
+        spillGarbageBytes += (off_t)(extent->count * sizeof(SpillRecord));
+        spilledCustomers--;
+        spilledShipments -= extent->count;
+        releaseSpillExtent(extent);
+        return;
+    }
+    while (history != NULL) {
+        Shipment* next = history->next;
+        free(history);
+        history = next;
+    }
+}
+
+void displayMemoryUsage() {
+    static const char* names[MEMORY_CATEGORY_COUNT] = {
+        "Musteriler", "Gonderim gecmisleri", "Priority Queue", "Stack", "Sehirler"
+    };
+
+    printf("Bellek kullanimi:\n");
+    for (int i = 0; i < MEMORY_CATEGORY_COUNT; i++) {
+        printf("  %-20s: %10.2f MB\n", names[i], memoryUsage[i] / 1048576.0);
+    }
+    printf("  %-20s: %10.2f MB", "Toplam", totalMemoryUsage() / 1048576.0);
+    if (memoryCeiling > 0) {
+        printf(" (tavan %.2f MB)\n", memoryCeiling / 1048576.0);
+    } else {
+        printf(" (tavan yok)\n");
+    }
+    printf("Diskteki gecmisler: %ld musteri, %ld gonderi\n", spilledCustomers, spilledShipments);
+    printf("Tasma dosyasi: %.2f MB (%.2f MB kullanilmiyor), %ld tasima, %ld geri okuma\n",
+           spillFileSize / 1048576.0, spillGarbageBytes / 1048576.0, spillCount, pageInCount);
+}
+
+// Program sonunda cagrilir (okuyucu kalmamis olmali)
+void freeSpillSegment() {
+    if (spillFd >= 0) {
+        close(spillFd);
+        if (spillPath != NULL) unlink(spillPath);
+        spillFd = -1;
+    }
+    spillFileSize = spillGarbageBytes = 0;
+    free(spillHoles);
+    spillHoles = NULL;
+    spillHoleCount = spillHoleCapacity = 0;
+}
+
+// Gonderim Gecmisi Disa Aktarimi (CSV / JSON Lines)
+//
+// Her musteride arsiv bloklari ve canli (veya diske tasinmis) liste ayri ayri
+// (tarih, gonderi ID) sirasinda okunup birlestirilir. Arsiv bloklari ilk
+// gune gore siralidir ama farkli arsivleme turlerinden gelen bloklarin
+// tarih araliklari cakisabilir; cakisan bloklar birlikte acilip birlestirilir.
+// Kayitlar ByteBuffer'a printf kullanilmadan yazilir.
+#define EXPORT_PAGE_RECORDS 4096    // Dosyaya her yazimda aktarilan kayit
+#define EXPORT_MAX_RECORD_BYTES 256 // Kacisli en uzun kayit icin ayrilan yer
+
+// Tek bir arsiv blogunun okuma durumu ve siradaki cozulmus kaydi
+typedef struct ArchiveRun {
+    ArchiveCursor cursor;
+    Shipment current;
+} ArchiveRun;
+
+typedef struct ArchiveMerge {
+    const ArchiveBlock* pending; // Henuz acilmamis ilk blok
+    int afterDay;                // Bu gunden once biten bloklar acilmaz
+    ArchiveRun* runs;            // Acik bloklar
+    int runCount;
+    int runCapacity;
+} ArchiveMerge;
+
+// Canli liste ya da diske tasinmis gecmis uzerinde sirali okuma
+typedef struct HistoryStream {
+    const Shipment* node;    // Bellekteki siradaki dugum
+    const Shipment* spilled; // Diske tasinmis gecmis (etiketli isaretci) ya da NULL
+    uint32_t spilledNext;    // Dosyadan okunacak siradaki kayit
+    Shipment batch[64];
+    int batchCount;
+    int batchIndex;
+} HistoryStream;
+
+// Kayit imlecten sonra mi geliyor: (tarih, ID) > (afterDate, afterShipmentID)
+int isAfterExportCursor(const Shipment* shipment, const ExportCursor* cursor) {
+    int result = strcmp(shipment->date, cursor->afterDate);
+    return result > 0 || (result == 0 && shipment->shipmentID > cursor->afterShipmentID);
+}
+
+// Blogun siradaki kaydini run->current'a cozer (blok bittiyse 0)
+int advanceArchiveRun(ArchiveRun* run) {
+    if (run->cursor.index == run->cursor.block->count) {
+        return 0; // nextArchivedShipment sonraki bloga gecmesin
+    }
+    return nextArchivedShipment(&run->cursor, &run->current);
+}
+
+void openArchiveMerge(ArchiveMerge* merge, const ArchiveBlock* head, const ExportCursor* cursor) {
+    memset(merge, 0, sizeof(*merge));
+    merge->pending = head;
+    merge->afterDay = cursor->afterDate[0] ? dateToDays(cursor->afterDate) : INT_MIN;
+}
+
+// Siradaki arsiv kaydini out'a yazar; imlece kadar olan kayitlar atlanir
+int nextArchiveMerge(ArchiveMerge* merge, const ExportCursor* cursor, Shipment* out) {
+    while (1) {
+        // En kucuk acik kayda kadar baslayan bloklari ac; tamamen imlecten
+        // once biten bloklar hic cozulmez
+        int best = -1;
+        for (int i = 0; i < merge->runCount; i++) {
+            if (best < 0 || shipmentDateIDKey(&merge->runs[i].current, &merge->runs[best].current) < 0) best = i;
+        }
+        if (merge->pending != NULL &&
+            (best < 0 || merge->pending->firstDay <= merge->runs[best].cursor.day)) {
+            const ArchiveBlock* block = merge->pending;
+            merge->pending = block->next;
+            if (block->lastDay < merge->afterDay) continue;
+
+            if (merge->runCount == merge->runCapacity) {
+                merge->runCapacity = merge->runCapacity ? merge->runCapacity * 2 : 4;
+                merge->runs = (ArchiveRun*)safeRealloc(merge->runs, merge->runCapacity * sizeof(ArchiveRun));
+            }
+            ArchiveRun* run = &merge->runs[merge->runCount];
+            openArchiveCursor(&run->cursor, block);
+            if (advanceArchiveRun(run)) merge->runCount++;
+            continue;
+        }
+        if (best < 0) {
+            return 0;
+        }
+
+        ArchiveRun* run = &merge->runs[best];
+        *out = run->current;
+        if (!advanceArchiveRun(run)) {
+            merge->runs[best] = merge->runs[--merge->runCount];
+        }
+        if (isAfterExportCursor(out, cursor)) {
+            return 1;
+        }
+    }
+}
+
+void closeArchiveMerge(ArchiveMerge* merge) {
+    free(merge->runs);
+    merge->runs = NULL;
+}
+
+// Tasinmis gecmis geri yuklenmez; kayitlar dosyadan parti parti okunur.
+// Imlecte gecerli bir ipucu varsa okuma bastan degil kalinan yerden baslar.
+void openHistoryStream(HistoryStream* stream, const Shipment* history, const ExportCursor* cursor) {
+    int resume = cursor->hintVersion != 0 &&
+                 cursor->hintVersion == __atomic_load_n(&commitVersion, __ATOMIC_SEQ_CST);
+    stream->node = isSpilledHistory(history) ? NULL : (resume ? cursor->hintNode : history);
+    stream->spilled = isSpilledHistory(history) ? history : NULL;
+    stream->spilledNext = resume ? cursor->hintSpilledNext : 0;
+    stream->batchCount = stream->batchIndex = 0;
+}
+
+// Siradaki okunacak kaydin konumunu ipucu olarak imlece yazar
+void markHistoryStream(const HistoryStream* stream, ExportCursor* cursor) {
+    cursor->hintNode = stream->node;
+    cursor->hintSpilledNext = stream->spilledNext - (uint32_t)(stream->batchCount - stream->batchIndex);
+}
+
+int nextHistoryStream(HistoryStream* stream, const ExportCursor* cursor, Shipment* out) {
+    while (1) {
+        if (stream->spilled != NULL) {
+            if (stream->batchIndex == stream->batchCount) {
+                stream->batchCount = readSpilledShipments(stream->spilled, stream->spilledNext, stream->batch, 64);
+                stream->batchIndex = 0;
+                stream->spilledNext += stream->batchCount;
+                if (stream->batchCount == 0) return 0;
+            }
+            *out = stream->batch[stream->batchIndex++];
+        } else {
+            if (stream->node == NULL) return 0;
+            *out = *stream->node;
+            stream->node = stream->node->next;
+        }
+        if (isAfterExportCursor(out, cursor)) {
+            return 1;
+        }
+    }
+}
+
+// Tamsayiyi onluk olarak p'ye yazar, yazilan sonun isaretcisini doner
+char* formatDecimal(char* p, long value) {
+    char digits[24];
+    int count = 0;
+    unsigned long magnitude = value < 0 ? 0UL - (unsigned long)value : (unsigned long)value;
+    do {
+        digits[count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0) *p++ = '-';
+    while (count > 0) *p++ = digits[--count];
+    return p;
+}
+
+// CSV alani: virgul, tirnak veya satir sonu iceriyorsa tirnak icine alinir
+char* formatCsvField(char* p, const char* text) {
+    if (strpbrk(text, ",\"\r\n") == NULL) {
+        size_t length = strlen(text);
+        memcpy(p, text, length);
+        return p + length;
+    }
+    *p++ = '"';
+    for (; *text; text++) {
+        if (*text == '"') *p++ = '"';
+        *p++ = *text;
+    }
+    *p++ = '"';
+    return p;
+}
+
+char* formatJsonString(char* p, const char* text) {
+    static const char hex[] = "0123456789abcdef";
+    *p++ = '"';
+    for (; *text; text++) {
+        unsigned char c = (unsigned char)*text;
+        if (c == '"' || c == '\\') {
+            *p++ = '\\';
+            *p++ = (char)c;
+        } else if (c < 0x20) {
+            memcpy(p, "\\u00", 4);
+            p[4] = hex[c >> 4];
+            p[5] = hex[c & 15];
+            p += 6;
+        } else {
+            *p++ = (char)c;
+        }
+    }
+    *p++ = '"';
+    return p;
+}
+
+#define appendLiteral(p, text) (memcpy((p), (text), sizeof(text) - 1), (p) + sizeof(text) - 1)
+
+void appendExportRecord(ByteBuffer* out, ExportFormat format, int customerID, const Shipment* shipment, int archived) {
+    bufferReserve(out, EXPORT_MAX_RECORD_BYTES);
+    char* start = (char*)out->data + out->length;
+    char* p = start;
+
+    switch (format) {
+        case EXPORT_CSV:
+            p = formatDecimal(p, customerID);
+            *p++ = ',';
+            p = formatDecimal(p, shipment->shipmentID);
+            *p++ = ',';
+            memcpy(p, shipment->date, 10);
+            p += 10;
+            *p++ = ',';
+            p = formatCsvField(p, shipment->status);
+            *p++ = ',';
+            p = formatDecimal(p, shipment->deliveryTime);
+            *p++ = ',';
+            *p++ = archived ? '1' : '0';
+            break;
+        case EXPORT_JSONL:
+            p = appendLiteral(p, "{\"customerID\":");
+            p = formatDecimal(p, customerID);
+            p = appendLiteral(p, ",\"shipmentID\":");
+            p = formatDecimal(p, shipment->shipmentID);
+            p = appendLiteral(p, ",\"date\":\"");
+            memcpy(p, shipment->date, 10);
+            p += 10;
+            p = appendLiteral(p, "\",\"status\":");
+            p = formatJsonString(p, shipment->status);
+            p = appendLiteral(p, ",\"deliveryTime\":");
+            p = formatDecimal(p, shipment->deliveryTime);
+            p = archived ? appendLiteral(p, ",\"archived\":true}") : appendLiteral(p, ",\"archived\":false}");
+            break;
+        case EXPORT_TEXT:
+            p = appendLiteral(p, "  Gonderi ID: ");
+            p = formatDecimal(p, shipment->shipmentID);
+            p = appendLiteral(p, ", Tarih: ");
+            memcpy(p, shipment->date, 10);
+            p += 10;
+            p = appendLiteral(p, ", Durum: ");
+            size_t length = strlen(shipment->status);
+            memcpy(p, shipment->status, length);
+            p += length;
+            p = appendLiteral(p, ", Teslim Suresi: ");
+            p = formatDecimal(p, shipment->deliveryTime);
+            p = archived ? appendLiteral(p, " gun (arsiv)") : appendLiteral(p, " gun");
+            break;
+    }
+    *p++ = '\n';
+    out->length += (size_t)(p - start);
+}
+
+void openExportCursor(ExportCursor* cursor, int customerID) {
+    memset(cursor, 0, sizeof(*cursor));
+    cursor->singleCustomer = customerID > 0;
+    cursor->customerID = customerID > 0 ? customerID : partitionIndex + 1;
+    if (cursor->customerID >= autoCustomerID) {
+        cursor->customerID = 0; // Disa aktarilacak musteri yok
+    }
+}
+
+// Anahtar metni yalnizca (musteri, tarih, ID) tasir; sunucu ve menu her
+// sayfada imleci yeniden kurdugundan son imleclerin ipuclari burada tutulur
+// ve ayni anahtar geldiginde geri verilir.
+#define EXPORT_HINT_SLOTS 8
+
+ExportCursor exportHintSlots[EXPORT_HINT_SLOTS];
+int nextExportHintSlot = 0;
+
+void rememberExportHint(const ExportCursor* cursor) {
+    exportHintSlots[nextExportHintSlot] = *cursor;
+    nextExportHintSlot = (nextExportHintSlot + 1) % EXPORT_HINT_SLOTS;
+}
+
+void restoreExportHint(ExportCursor* cursor) {
+    for (int i = 0; i < EXPORT_HINT_SLOTS; i++) {
+        const ExportCursor* slot = &exportHintSlots[i];
+        if (slot->hintVersion != 0 && slot->customerID == cursor->customerID &&
+            slot->afterShipmentID == cursor->afterShipmentID && strcmp(slot->afterDate, cursor->afterDate) == 0) {
+            cursor->hintVersion = slot->hintVersion;
+            cursor->hintNode = slot->hintNode;
+            cursor->hintSpilledNext = slot->hintSpilledNext;
+            return;
+        }
+    }
+}
+
+// Anahtar bicimi "musteriID:tarih:gonderiID" (musteri basindan icin tarih bos).
+// Bos anahtar bastan baslar. Gecersizse 0 doner.
+int parseExportToken(ExportCursor* cursor, const char* token, int customerID) {
+    openExportCursor(cursor, customerID);
+    if (token == NULL || token[0] == '\0') {
+        return 1;
+    }
+
+    int tokenCustomer, afterShipmentID = 0;
+    char afterDate[11] = "";
+    if (sscanf(token, "%d:%10[0-9-]:%d", &tokenCustomer, afterDate, &afterShipmentID) < 1) {
+        return 0;
+    }
+    if (tokenCustomer <= 0 || (customerID > 0 && tokenCustomer != customerID) ||
+        (idStride > 1 && (tokenCustomer - 1) % idStride != partitionIndex) ||
+        (afterDate[0] != '\0' && !isValidDate(afterDate))) {
+        return 0;
+    }
+
+    cursor->customerID = tokenCustomer < autoCustomerID ? tokenCustomer : 0;
+    strcpy(cursor->afterDate, afterDate);
+    cursor->afterShipmentID = afterShipmentID;
+    cursor->headerWritten = 1; // Devam sayfalarinda CSV basligi tekrarlanmaz
+    restoreExportHint(cursor);
+    return 1;
+}
+
+// Imleci anahtar metnine cevirir; disa aktarim bittiyse bos metin
+void formatExportToken(const ExportCursor* cursor, char* out, size_t capacity) {
+    if (cursor->customerID == 0) {
+        out[0] = '\0';
+        return;
+    }
+    snprintf(out, capacity, "%d:%s:%d", cursor->customerID, cursor->afterDate, cursor->afterShipmentID);
+}
+
+// Imlecten sonraki en fazla limit kaydi (0 = hepsi) out'a ekler ve imleci
+// ilerletir; yazilan kayit sayisini doner. Tasinmis gecmisler geri yuklenmez,
+// boylece tum filonun disa aktarimi bellek tavanini zorlamaz.
+long exportShipments(ExportCursor* cursor, long limit, ExportFormat format, ByteBuffer* out) {
+    long written = 0;
+    if (format == EXPORT_CSV && !cursor->headerWritten) {
+        static const char header[] = "customerID,shipmentID,date,status,deliveryTime,archived\n";
+        bufferAppend(out, header, sizeof(header) - 1);
+    }
+    cursor->headerWritten = 1;
+
+    while (cursor->customerID != 0 && (limit == 0 || written < limit)) {
+        Customer* customer = findCustomer(cursor->customerID);
+        int exhausted = 1;
+        if (customer != NULL) {
+            ArchiveMerge archive;
+            HistoryStream live;
+            ArchiveBlock** archiveHead = customerArchive(customer);
+            openArchiveMerge(&archive, archiveHead ? *archiveHead : NULL, cursor);
+            openHistoryStream(&live, customer->shipmentHistory, cursor);
+
+            Shipment archived, current;
+            int hasArchived = nextArchiveMerge(&archive, cursor, &archived);
+            markHistoryStream(&live, cursor);
+            int hasCurrent = nextHistoryStream(&live, cursor, &current);
+            while (hasArchived || hasCurrent) {
+                if (limit != 0 && written == limit) {
+                    // Sonraki sayfa current'i yeniden okuyarak buradan devam eder
+                    exhausted = 0;
+                    cursor->hintVersion = __atomic_load_n(&commitVersion, __ATOMIC_SEQ_CST);
+                    rememberExportHint(cursor);
+                    break;
+                }
+                int takeArchived = hasArchived && (!hasCurrent || shipmentDateIDKey(&archived, &current) < 0);
+                const Shipment* shipment = takeArchived ? &archived : &current;
+                appendExportRecord(out, format, customer->customerID, shipment, takeArchived);
+                strcpy(cursor->afterDate, shipment->date);
+                cursor->afterShipmentID = shipment->shipmentID;
+                written++;
+
+                if (takeArchived) {
+                    hasArchived = nextArchiveMerge(&archive, cursor, &archived);
+                } else {
+                    markHistoryStream(&live, cursor);
+                    hasCurrent = nextHistoryStream(&live, cursor, &current);
+                }
+            }
+            closeArchiveMerge(&archive);
+        }
+        if (!exhausted) {
+            break;
+        }
+
+        // Siradaki musteriye gec
+        cursor->afterDate[0] = '\0';
+        cursor->afterShipmentID = 0;
+        cursor->hintVersion = 0;
+        cursor->customerID += idStride;
+        if (cursor->singleCustomer || cursor->customerID >= autoCustomerID) {
+            cursor->customerID = 0;
+        }
+    }
+    return written;
+}
+
+int writeFully(int fd, const unsigned char* data, size_t length) {
+    while (length > 0) {
+        ssize_t done = write(fd, data, length);
+        if (done < 0 && errno == EINTR) continue;
+        if (done <= 0) return 0;
+        data += done;
+        length -= (size_t)done;
+    }
+    return 1;
+}
+
+// Gecmisleri path'e ("-" = standart cikti) EXPORT_PAGE_RECORDS'luk partilerle
+// yazar. limit > 0 ise en fazla limit kayit yazilir ve imlec devam icin
+// kullanilabilir. Yazilan kayit sayisini doner (dosya hatasinda -1).
+long exportToFile(const char* path, ExportFormat format, long limit, ExportCursor* cursor) {
+    int fd = strcmp(path, "-") == 0 ? STDOUT_FILENO : open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        printError("Disa aktarim dosyasi acilamadi.");
+        return -1;
+    }
+    if (fd == STDOUT_FILENO) fflush(stdout);
+
+    ByteBuffer buffer = { NULL, 0, 0 };
+    long total = 0;
+    int ok = 1;
+    do {
+        long page = limit == 0 || limit - total > EXPORT_PAGE_RECORDS ? EXPORT_PAGE_RECORDS : limit - total;
+        total += exportShipments(cursor, page, format, &buffer);
+        if (!writeFully(fd, buffer.data, buffer.length)) {
+            ok = 0;
+            break;
+        }
+        buffer.length = 0;
+    } while (cursor->customerID != 0 && (limit == 0 || total < limit));
+    bufferFree(&buffer);
+
+    if (fd != STDOUT_FILENO) close(fd);
+    if (!ok) {
+        printError("Disa aktarim dosyasina yazilamadi.");
+        return -1;
+    }
+    return total;
+}
+
+// Siralama Algoritmasi (Teslim Edilmemis Kargolar icin)
+//
+// Onceki ozyinelemeli birlestirme siralamasi. Cagri yerleri artik uretilmis
+// cekirdekleri kullanir; bu surum yalnizca --bench-sort karsilastirmasi icin
+// durur ve -DKARGO_LEGACY_BENCH olmadan derlenmez.
+#ifdef KARGO_LEGACY_BENCH
+void legacyMergeSortShipments(Shipment** headRef) {
+    Shipment* head = *headRef;
+    Shipment* a;
+    Shipment* b;
+
+    if (!head || !head->next) return;
+
+    // Listeyi ortadan ikiye bol
+    legacySplitList(head, &a, &b);
+
+    // Bolumleri sirala
+    legacyMergeSortShipments(&a);
+    legacyMergeSortShipments(&b);
+
+    // Bolumleri birlestir
+    *headRef = legacySortedMerge(a, b);
+}
+
+Shipment* legacySortedMerge(Shipment* a, Shipment* b) {
+    Shipment* result = NULL;
+
+    if (!a) return b;
+    if (!b) return a;
+
+    // Karsilastirma: teslim suresi kucuk olan onde
+    if (strcmp(a->status, "Teslim Edilmedi") == 0 &&
+        strcmp(b->status, "Teslim Edilmedi") == 0 &&
+        a->deliveryTime <= b->deliveryTime) {
+        result = a;
+        result->next = legacySortedMerge(a->next, b);
+    } else {
+        result = b;
+        result->next = legacySortedMerge(a, b->next);
+    }
+
+    return result;
+}
+
+void legacySplitList(Shipment* source, Shipment** frontRef, Shipment** backRef) {
+    Shipment* fast;
+    Shipment* slow;
+    slow = source;
+    fast = source->next;
+
+    // Hizli ve yavas pointer ile listeyi ikiye bol
+    while (fast) {
+        fast = fast->next;
+        if (fast) {
+            slow = slow->next;
+            fast = fast->next;
+        }
+    }
+
+    *frontRef = source;
+    *backRef = slow->next;
+    slow->next = NULL;
+}
+#endif
+
+
+// Teslimat Rotasinda Sehir Sayisini Bulma
+int countCities(CityNode* node) {
+    CityWalk walk;
+    int count = 0;
+    openCityWalk(&walk, node, 0);
+    while (nextCityWalk(&walk, NULL) != NULL) {
+        count++;
+    }
+    return count;
+}
+
+// En Uzun Teslimat Rotasini Hesaplama
+int calculateTreeDepth(CityNode* node) {
+    CityWalk walk;
+    int depth = 0, level;
+    openCityWalk(&walk, node, 1);
+    while (nextCityWalk(&walk, &level) != NULL) {
+        if (level > depth) depth = level;
+    }
+    return depth;
+}
+
+// Sehir Isimlerini Alfabetik Siralama
+// Sira ozyinelemeli surumle aynidir: once cocuklar, sonra dugum, sonra kardesler.
+// Yigindaki dugumun cocuklari yazilmistir; cikinca kendisi yazilir ve kardesine gecilir.
+void printCitiesAlphabetically(CityNode* node) {
+    CityWalk walk;
+    openCityWalk(&walk, NULL, 0);
+    while (1) {
+        for (; cityVisible(node); node = readPointer(node->child)) {
+            cityWalkPush(&walk, node, 0);
+        }
+        if (walk.top == 0) {
+            break;
+        }
+        node = walk.entries[--walk.top].node;
+        printf("Sehir: %s (ID: %d)\n", node->cityName, node->cityID);
+        node = readPointer(node->sibling);
+    }
+    free(walk.entries);
+}
+
+// En Kisa Teslimat Suresi (ag bossa INT_MAX)
+int calculateMinDeliveryTime(CityNode* node) {
+    CityWalk walk;
+    int minDeliveryTime = INT_MAX;
+    openCityWalk(&walk, node, 0);
+    while ((node = nextCityWalk(&walk, NULL)) != NULL) {
+        if (node->deliveryTime < minDeliveryTime) minDeliveryTime = node->deliveryTime;
+    }
+    return minDeliveryTime;
+}
+
+// Toplu Sehir Agi Yukleme
+//
+// Dosya bicimi (satir basina bir sehir, '#' ile baslayan satirlar yok sayilir):
+//   SehirID,EbeveynID,SehirAdi,TeslimSuresi
+// Kokun ebeveyni 0'dir. Satirlar herhangi bir sirada olabilir; bir sehrin
+// cocuklari dosyadaki siralariyla baglanir. Dugumler once bagimsiz olarak
+// olusturulur; dizin, cocuk zincirleri ve derinlik ardindan tek geciste
+// kurulur ve ag tek bir yazma olarak yayinlanir. Hatali dosyada mevcut ag
+// degismez. Mevcut agin yerine gecer; okuyucu yokken ve hub kuyruklari
+// kurulmadan once (baslangicta) cagrilmalidir.
+typedef struct CityNetworkRows {
+    CityNode** nodes;
+    int* parents;      // Ebeveyn sehir ID'si (kok icin 0)
+    int* lines;        // Hata mesajlari icin dosya satiri
+    int count, capacity;
+    int errorCount;
+} CityNetworkRows;
+
+void addCityRow(CityNetworkRows* rows, int cityID, int parentCityID, const char* cityName, int deliveryTime, int line) {
+    if (rows->count == rows->capacity) {
+        rows->capacity = rows->capacity ? rows->capacity * 2 : 64;
+        rows->nodes = (CityNode**)safeRealloc(rows->nodes, rows->capacity * sizeof(CityNode*));
+        rows->parents = (int*)safeRealloc(rows->parents, rows->capacity * sizeof(int));
+        rows->lines = (int*)safeRealloc(rows->lines, rows->capacity * sizeof(int));
+    }
+    CityNode* node = createCityNode(cityID, cityName);
+    node->deliveryTime = deliveryTime;
+    rows->nodes[rows->count] = node;
+    rows->parents[rows->count] = parentCityID;
+    rows->lines[rows->count] = line;
+    rows->count++;
+}
+
+// line 0: dosyanin tamamiyla ilgili hata
+void cityRowError(CityNetworkRows* rows, int line, const char* message) {
+    if (line > 0) {
+        printInfo("Satir %d: %s\n", line, message);
+    } else {
+        printInfo("%s\n", message);
+    }
+    rows->errorCount++;
+}
+
+void freeCityNetworkRows(CityNetworkRows* rows) {
+    free(rows->nodes);
+    free(rows->parents);
+    free(rows->lines);
+    memset(rows, 0, sizeof(*rows));
+}
+
+// Satirlardan agi kurar ve yayinlar. Basarida derinligi, hatada 0 doner (dugumler serbest birakilir).
+int buildCityNetwork(CityNetworkRows* rows, int previousAutoCityID) {
+    int maxCityID = 0;
+    for (int i = 0; i < rows->count; i++) {
+        if (rows->nodes[i]->cityID > maxCityID) maxCityID = rows->nodes[i]->cityID;
+    }
+
+    // Dizin: kopya ID'ler ve ebeveynler burada cozulur
+    CityIndex index = { NULL, 0 };
+    CityNode* newRoot = NULL;
+    for (int i = 0; i < rows->count; i++) {
+        CityNode* node = rows->nodes[i];
+        CityIndexEntry* entry = reserveCityIndex(&index, node->cityID);
+        if (entry->city != NULL) {
+            cityRowError(rows, rows->lines[i], "Sehir ID'si tekrar ediyor.");
+        } else {
+            entry->city = node;
+            entry->parentCityID = rows->parents[i];
+        }
+        if (rows->parents[i] == 0) {
+            if (newRoot != NULL) cityRowError(rows, rows->lines[i], "Agda yalnizca bir kok sehir olabilir.");
+            newRoot = node;
+        }
+    }
+    if (newRoot == NULL && rows->count > 0) {
+        cityRowError(rows, 0, "Kok sehir (ebeveyni 0) yok.");
+    }
+
+    // Cocuk zincirleri dosya sirasiyla kurulur
+    for (int i = 0; i < rows->count; i++) {
+        int parentCityID = rows->parents[i];
+        if (parentCityID == 0) continue;
+        CityIndexEntry* parent = cityIndexEntry(&index, parentCityID);
+        if (parent == NULL || parent->city == NULL) {
+            cityRowError(rows, rows->lines[i], "Ebeveyn sehir bulunamadi.");
+            continue;
+        }
+        if (parent->lastChild == NULL) {
+            parent->city->child = rows->nodes[i];
+        } else {
+            parent->lastChild->sibling = rows->nodes[i];
+        }
+        parent->lastChild = rows->nodes[i];
+    }
+
+    // Kokten erisilemeyen dugumler ebeveyn dongusundedir
+    int depth = 0;
+    if (rows->errorCount == 0 && rows->count > 0) {
+        CityNode** stack = (CityNode**)safeMalloc(rows->count * sizeof(CityNode*));
+        int* levels = (int*)safeMalloc(rows->count * sizeof(int));
+        int top = 0, reached = 0;
+        stack[top] = newRoot;
+        levels[top++] = 1;
+        while (top > 0) {
+            top--;
+            CityNode* node = stack[top];
+            int level = levels[top];
+            reached++;
+            if (level > depth) depth = level;
+            for (CityNode* child = node->child; child != NULL; child = child->sibling) {
+                stack[top] = child;
+                levels[top++] = level + 1;
+            }
+        }
+        free(stack);
+        free(levels);
+        if (reached != rows->count) {
+            cityRowError(rows, 0, "Bazi sehirler kok sehre baglanmiyor (ebeveyn dongusu).");
+        }
+    }
+
+    if (rows->errorCount > 0 || rows->count == 0) {
+        for (int i = 0; i < rows->count; i++) {
+            free(rows->nodes[i]);
+        }
+        trackMemory(MEMORY_CITIES, -(long)rows->count * (long)sizeof(CityNode));
+        freeCityIndex(&index);
+        autoCityID = previousAutoCityID;
+        return 0;
+    }
+
+    // Eski ag ve dizin birakilir, yenisi tek yazma olarak yayinlanir
+    uint32_t version = beginWrite();
+    for (int i = 0; i < rows->count; i++) rows->nodes[i]->version = version;
+    CityNode* oldRoot = root;
+    publishPointer(root, newRoot);
+    commitWrite();
+    freeCityTree(oldRoot);
+    freeCityIndex(&cityIndex);
+    cityIndex = index;
+    autoCityID = maxCityID;
+    return depth;
+}
+
+void parseCityLine(CityNetworkRows* rows, const char* line, const char* lineEnd, int lineNumber) {
+    char field[64], cityName[50];
+    const char* cursor = line;
+
+    if (lineEnd > line && lineEnd[-1] == '\r') lineEnd--;
+    if (lineEnd == line || *line == '#') return; // Bos satir veya yorum
+
+    readCsvField(&cursor, lineEnd, field, sizeof(field));
+    int cityID = parseCsvNumber(field);
+    if (!isPositiveNumber(cityID) || cityID > CITY_MAX_ID) {
+        cityRowError(rows, lineNumber, "Sehir ID'si 1 ile 16777215 arasinda olmalidir.");
+        return;
+    }
+    readCsvField(&cursor, lineEnd, field, sizeof(field));
+    int parentCityID = parseCsvNumber(field);
+    if (parentCityID < 0 || parentCityID > CITY_MAX_ID) {
+        cityRowError(rows, lineNumber, "Ebeveyn ID'si gecersiz (kok icin 0).");
+        return;
+    }
+    if (!readCsvField(&cursor, lineEnd, cityName, sizeof(cityName)) || !isValidName(cityName, 50)) {
+        cityRowError(rows, lineNumber, "Sehir adi 50 karakterden kisa olmalidir ve bos olmamalidir.");
+        return;
+    }
+    readCsvField(&cursor, lineEnd, field, sizeof(field));
+    int deliveryTime = parseCsvNumber(field);
+    if (!isPositiveNumber(deliveryTime)) {
+        cityRowError(rows, lineNumber, "Teslim suresi pozitif olmalidir.");
+        return;
+    }
+    addCityRow(rows, cityID, parentCityID, cityName, deliveryTime, lineNumber);
+}
+
+// Sehir agini dosyadan yukler; yuklenen sehir sayisini, hatada -1 doner
+int loadCityNetwork(const char* path) {
+    if (hubQueuesBuilt()) {
+        printError("Hub kuyruklari kurulduktan sonra sehir agi degistirilemez.");
+        return -1;
+    }
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        printError("Dosya acilamadi.");
+        return -1;
+    }
+    struct stat info;
+    if (fstat(fd, &info) < 0 || info.st_size == 0) {
+        close(fd);
+        printError("Sehir dosyasi bos veya okunamadi.");
+        return -1;
+    }
+    size_t size = (size_t)info.st_size;
+    const char* data = (const char*)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        printError("Dosya bellege eslenemedi.");
+        return -1;
+    }
+    madvise((void*)data, size, MADV_SEQUENTIAL);
+
+    CityNetworkRows rows;
+    memset(&rows, 0, sizeof(rows));
+    int previousAutoCityID = autoCityID;
+    const char* end = data + size;
+    int lineNumber = 0;
+    for (const char* line = data; line < end; ) {
+        const char* newline = memchr(line, '\n', (size_t)(end - line));
+        const char* lineEnd = newline ? newline : end;
+        parseCityLine(&rows, line, lineEnd, ++lineNumber);
+        line = newline ? newline + 1 : end;
+    }
+    munmap((void*)data, size);
+
+    int count = rows.count;
+    int depth = 0;
+    if (rows.errorCount == 0) {
+        depth = buildCityNetwork(&rows, previousAutoCityID);
+    } else {
+        for (int i = 0; i < rows.count; i++) free(rows.nodes[i]);
+        trackMemory(MEMORY_CITIES, -(long)rows.count * (long)sizeof(CityNode));
+        autoCityID = previousAutoCityID;
+    }
+    int errors = rows.errorCount;
+    freeCityNetworkRows(&rows);
+    if (errors > 0 || depth == 0) {
+        printError("Sehir agi yuklenemedi, mevcut ag korundu.");
+        return -1;
+    }
+    printInfo("%d sehir yuklendi (agac derinligi %d).\n", count, depth);
+    return count;
+}
+
+// Varsayilan Sehirler
+void initializeDefaultCities() {
+    static const struct {
+        int cityID;
+        int parentCityID;
+        const char* cityName;
+        int deliveryTime;
+    } defaults[] = {
+        { 1, 0, "Istanbul", 1 },   // Kargo merkezi
+        // Ilk seviye sehirler
+        { 2, 1, "Tekirdag", 2 },   // Istanbul'un altinda
+        { 3, 1, "Edirne", 3 },     // Istanbul'un altinda
+        { 4, 1, "Kirklareli", 4 }, // Istanbul'un altinda
+        // Istanbul'dan daha uzak olan sehirler
+        { 5, 1, "Bursa", 5 },      // Istanbul'un altinda
+        { 6, 5, "Canakkale", 6 },  // Bursa'nin altinda
+        { 7, 5, "Balikesir", 4 },  // Bursa'nin altinda
+        { 11, 5, "Bilecik", 5 },   // Bursa'nin altinda
+        // Sakarya ve cevresi
+        { 8, 1, "Sakarya", 3 },    // Istanbul'un altinda
+        { 9, 8, "Kocaeli", 2 },    // Sakarya'nin altinda
+        { 10, 9, "Yalova", 3 },    // Kocaeli'nin altinda
+    };
+
+    CityNetworkRows rows;
+    memset(&rows, 0, sizeof(rows));
+    for (size_t i = 0; i < sizeof(defaults) / sizeof(defaults[0]); i++) {
+        addCityRow(&rows, defaults[i].cityID, defaults[i].parentCityID, defaults[i].cityName,
+                   defaults[i].deliveryTime, (int)i + 1);
+    }
+    buildCityNetwork(&rows, autoCityID);
+    freeCityNetworkRows(&rows);
+
+    printf("Kargo merkezi Istanbul (ID: 1) ve %d sehir eklendi.\n", (int)(sizeof(defaults) / sizeof(defaults[0])) - 1);
+    printf("Varsayilan sehirler ve iliskiler basariyla eklendi.\n");
+}
+
+// Toplu CSV Aktarimi
+//
+// Dosya bicimi (satir basina bir kayit, '#' ile baslayan satirlar yok sayilir):
+//   C,Ad,Soyad
+//   S,MusteriID,YYYY-MM-DD,Durum,TeslimSuresi
+// Dosya mmap ile okunur, satir sinirlarinda parcalara bolunur ve parcalar
+// paralel olarak cozulup dogrulanir. Ardindan gonderiler musteri bazinda
+// tek bir sirali parti olarak mevcut gecmise birlestirilir.
+#define IMPORT_MAX_THREADS 64
+
+typedef struct ImportCustomerRow {
+    int line;
+    char firstName[50];
+    char lastName[50];
+} ImportCustomerRow;
+
+typedef struct ImportShipmentRow {
+    int line;
+    int customerID;
+    int deliveryTime;
+    int sequence;      // Parca icindeki sira (dosya sirasini korumak icin)
+    char date[11];
+    char status[20];
+} ImportShipmentRow;
+
+typedef struct ImportError {
+    int line;
+    const char* message;
+} ImportError;
+
+typedef struct ImportChunk {
+    const char* start;
+    const char* end;
+    int lineCount;
+    int lineBase;      // Onceki parcalardaki satir sayisi
+    ImportCustomerRow* customers;
+    int customerCount, customerCapacity;
+    ImportShipmentRow* shipments;
+    int shipmentCount, shipmentCapacity;
+    ImportError* errors;
+    int errorCount, errorCapacity;
+} ImportChunk;
+
+void addImportError(ImportChunk* chunk, int line, const char* message) {
+    if (chunk->errorCount == chunk->errorCapacity) {
+        chunk->errorCapacity = chunk->errorCapacity ? chunk->errorCapacity * 2 : 16;
+        chunk->errors = (ImportError*)safeRealloc(chunk->errors, chunk->errorCapacity * sizeof(ImportError));
+    }
+    chunk->errors[chunk->errorCount].line = line;
+    chunk->errors[chunk->errorCount].message = message;
+    chunk->errorCount++;
+}
+
+// Virgule veya satir sonuna kadar olan alani out'a kopyalar; sigmazsa 0 doner
+int readCsvField(const char** cursor, const char* lineEnd, char* out, size_t capacity) {
+    const char* start = *cursor;
+    const char* p = start;
+    while (p < lineEnd && *p != ',') p++;
+    size_t length = (size_t)(p - start);
+    *cursor = (p < lineEnd) ? p + 1 : p;
+    if (length >= capacity) {
+        out[0] = '\0';
+        return 0;
+    }
+    memcpy(out, start, length);
+    out[length] = '\0';
+    return 1;
+}
+
+// Pozitif tamsayi alani; gecersizse -1 doner
+int parseCsvNumber(const char* text) {
+    long value = 0;
+    if (*text == '\0') return -1;
+    for (; *text; text++) {
+        if (*text < '0' || *text > '9') return -1;
+        value = value * 10 + (*text - '0');
+        if (value > INT_MAX) return -1;
+    }
+    return (int)value;
+}
+
+void parseImportLine(ImportChunk* chunk, const char* line, const char* lineEnd, int lineNumber) {
+    char field[64];
+    const char* cursor = line;
+
+    if (lineEnd > line && lineEnd[-1] == '\r') lineEnd--;
+    if (lineEnd == line || *line == '#') return; // Bos satir veya yorum
+
+    readCsvField(&cursor, lineEnd, field, sizeof(field));
+
+    if (strcmp(field, "C") == 0) {
+        ImportCustomerRow row;
+        row.line = lineNumber;
+        if (!readCsvField(&cursor, lineEnd, row.firstName, sizeof(row.firstName)) || !isValidName(row.firstName, 50)) {
+            addImportError(chunk, lineNumber, "Ad 50 karakterden kisa olmalidir ve bos olmamalidir.");
+            return;
+        }
+        if (!readCsvField(&cursor, lineEnd, row.lastName, sizeof(row.lastName)) || !isValidName(row.lastName, 50)) {
+            addImportError(chunk, lineNumber, "Soyad 50 karakterden kisa olmalidir ve bos olmamalidir.");
+            return;
+        }
+        if (chunk->customerCount == chunk->customerCapacity) {
+            chunk->customerCapacity = chunk->customerCapacity ? chunk->customerCapacity * 2 : 64;
+            chunk->customers = (ImportCustomerRow*)safeRealloc(chunk->customers,
+                                   chunk->customerCapacity * sizeof(ImportCustomerRow));
+        }
+        chunk->customers[chunk->customerCount++] = row;
+        return;
+    }
+
+    if (strcmp(field, "S") == 0) {
+        ImportShipmentRow row;
+        row.line = lineNumber;
+        readCsvField(&cursor, lineEnd, field, sizeof(field));
+        row.customerID = parseCsvNumber(field);
+        if (!isPositiveNumber(row.customerID)) {
+            addImportError(chunk, lineNumber, "Musteri numarasi pozitif olmalidir.");
+            return;
+        }
+        if (!readCsvField(&cursor, lineEnd, row.date, sizeof(row.date)) || !isValidDate(row.date)) {
+            addImportError(chunk, lineNumber, "Tarih formati hatali. YYYY-MM-DD formatinda giriniz.");
+            return;
+        }
+        if (!readCsvField(&cursor, lineEnd, row.status, sizeof(row.status)) || !isValidName(row.status, 20)) {
+            addImportError(chunk, lineNumber, "Durum bilgisi 20 karakterden kisa olmalidir ve bos olmamalidir.");
+            return;
+        }
+        readCsvField(&cursor, lineEnd, field, sizeof(field));
+        row.deliveryTime = parseCsvNumber(field);
+        if (!isPositiveNumber(row.deliveryTime)) {
+            addImportError(chunk, lineNumber, "Teslim suresi pozitif olmalidir.");
+            return;
+        }
+        if (chunk->shipmentCount == chunk->shipmentCapacity) {
+            chunk->shipmentCapacity = chunk->shipmentCapacity ? chunk->shipmentCapacity * 2 : 256;
+            chunk->shipments = (ImportShipmentRow*)safeRealloc(chunk->shipments,
+                                   chunk->shipmentCapacity * sizeof(ImportShipmentRow));
+        }
+        row.sequence = chunk->shipmentCount;
+        chunk->shipments[chunk->shipmentCount++] = row;
+        return;
+    }
+
+    addImportError(chunk, lineNumber, "Bilinmeyen kayit turu (C veya S olmali).");
+}
+
+// Musteri ve tarihe gore
+int compareImportShipmentKeys(const ImportShipmentRow* x, const ImportShipmentRow* y) {
+    if (x->customerID != y->customerID) return (x->customerID > y->customerID) - (x->customerID < y->customerID);
+    return strcmp(x->date, y->date);
+}
+
+// Parca ici siralama: esit anahtarlarda dosya sirasi korunur
+int compareImportShipments(const void* a, const void* b) {
+    const ImportShipmentRow* x = (const ImportShipmentRow*)a;
+    const ImportShipmentRow* y = (const ImportShipmentRow*)b;
+    int result = compareImportShipmentKeys(x, y);
+    if (result != 0) return result;
+    return (x->sequence > y->sequence) - (x->sequence < y->sequence);
+}
+
+// Is parcacigi: parcayi satir satir cozer ve gonderileri siralar
+void* parseImportChunk(void* argument) {
+    ImportChunk* chunk = (ImportChunk*)argument;
+    const char* line = chunk->start;
+
+    while (line < chunk->end) {
+        const char* lineEnd = memchr(line, '\n', (size_t)(chunk->end - line));
+        if (lineEnd == NULL) lineEnd = chunk->end;
+        chunk->lineCount++;
+        parseImportLine(chunk, line, lineEnd, chunk->lineCount); // Yerel satir numarasi
+        line = lineEnd + 1;
+    }
+
+    qsort(chunk->shipments, chunk->shipmentCount, sizeof(ImportShipmentRow), compareImportShipments);
+    return NULL;
+}
+
+// Bir musterinin sirali parti gonderilerini mevcut gecmisle tek geciste birlestirir.
+// Acik yazma penceresinde cagrilir; gecmis onceden bellege alinmis olmalidir.
+void mergeShipmentBatch(Customer* customer, Shipment* batch) {
+    Shipment** link = &customer->shipmentHistory;
+    while (batch != NULL) {
+        link = shipmentsByDateInsertLink(link, batch);
+        Shipment* next = batch->next;
+        batch->next = *link;
+        publishPointer(*link, batch);
+        link = &batch->next;
+        batch = next;
+    }
+}
+
+// Siradaki en kucuk gonderi satirini tutan parca (hepsi bittiyse -1).
+// Esitlikte onceki parca secilir, boylece dosya sirasi korunur.
+int pickNextImportChunk(ImportChunk* chunks, const int* position, int threadCount) {
+    int best = -1;
+    for (int i = 0; i < threadCount; i++) {
+        if (position[i] < chunks[i].shipmentCount &&
+            (best < 0 || compareImportShipmentKeys(&chunks[i].shipments[position[i]],
+                                                   &chunks[best].shipments[position[best]]) < 0)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+int compareImportErrors(const void* a, const void* b) {
+    const ImportError* x = (const ImportError*)a;
+    const ImportError* y = (const ImportError*)b;
+    return (x->line > y->line) - (x->line < y->line);
+}
+
+void freeImportChunk(ImportChunk* chunk) {
+    free(chunk->customers);
+    free(chunk->shipments);
+    free(chunk->errors);
+}
+
+// CSV dosyasini threadCount is parcacigi ile aktarir. Hata sayisini doner (dosya acilamazsa -1)
+int importCsvFile(const char* path, int threadCount, long* importedCustomers, long* importedShipments) {
+    *importedCustomers = *importedShipments = 0;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        printError("Dosya acilamadi.");
+        return -1;
+    }
+    struct stat info;
+    if (fstat(fd, &info) < 0) {
+        close(fd);
+        printError("Dosya bilgisi okunamadi.");
+        return -1;
+    }
+    size_t size = (size_t)info.st_size;
+    if (size == 0) {
+        close(fd);
+        return 0;
+    }
+    const char* data = (const char*)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        printError("Dosya bellege eslenemedi.");
+        return -1;
+    }
+    madvise((void*)data, size, MADV_SEQUENTIAL);
+
+    if (threadCount < 1) threadCount = 1;
+    if (threadCount > IMPORT_MAX_THREADS) threadCount = IMPORT_MAX_THREADS;
+    if ((size_t)threadCount > size / 4096 + 1) threadCount = (int)(size / 4096 + 1);
+
+    // Parca sinirlarini bir sonraki satir basina kaydir
+    ImportChunk chunks[IMPORT_MAX_THREADS];
+    pthread_t threads[IMPORT_MAX_THREADS];
+    const char* end = data + size;
+    const char* start = data;
+    for (int i = 0; i < threadCount; i++) {
+        memset(&chunks[i], 0, sizeof(ImportChunk));
+        const char* chunkEnd = (i == threadCount - 1) ? end : data + size / threadCount * (i + 1);
+        if (chunkEnd < start) chunkEnd = start;
+        if (chunkEnd < end) {
+            const char* newline = memchr(chunkEnd, '\n', (size_t)(end - chunkEnd));
+            chunkEnd = newline ? newline + 1 : end;
+        }
+        chunks[i].start = start;
+        chunks[i].end = chunkEnd;
+        start = chunkEnd;
+    }
+
+    // Is parcacigi acilamazsa o parca da bu is parcacigi tarafindan islenir
+    int started[IMPORT_MAX_THREADS] = { 0 };
+    for (int i = 1; i < threadCount; i++) {
+        started[i] = pthread_create(&threads[i], NULL, parseImportChunk, &chunks[i]) == 0;
+    }
+    for (int i = 0; i < threadCount; i++) {
+        if (!started[i]) parseImportChunk(&chunks[i]);
+    }
+    for (int i = 1; i < threadCount; i++) {
+        if (started[i]) pthread_join(threads[i], NULL);
+    }
+
+    // Yerel satir numaralarini dosya geneline cevir
+    int lineBase = 0;
+    for (int i = 0; i < threadCount; i++) {
+        chunks[i].lineBase = lineBase;
+        lineBase += chunks[i].lineCount;
+        for (int j = 0; j < chunks[i].errorCount; j++) chunks[i].errors[j].line += chunks[i].lineBase;
+        for (int j = 0; j < chunks[i].shipmentCount; j++) chunks[i].shipments[j].line += chunks[i].lineBase;
+    }
+
+    // Musteriler dosya sirasiyla eklenir, boylece ID'leri ongorulebilir
+    int previousQuiet = quietMode;
+    quietMode = 1;
+    for (int i = 0; i < threadCount; i++) {
+        for (int j = 0; j < chunks[i].customerCount; j++) {
+            addCustomer(chunks[i].customers[j].firstName, chunks[i].customers[j].lastName);
+            (*importedCustomers)++;
+        }
+    }
+    quietMode = previousQuiet;
+
+    // Gonderi ID'leri dosya sirasina gore dagitilir
+    int shipmentIDBase[IMPORT_MAX_THREADS];
+    for (int i = 0; i < threadCount; i++) {
+        shipmentIDBase[i] = autoShipmentID;
+        autoShipmentID += chunks[i].shipmentCount;
+    }
+
+    // Tasinmis gecmisler pencere acilmadan bellege alinir: geri okuma surum
+    // yayimlar ve acik pencerede partinin bir kismini erken gosterirdi.
+    for (int i = 0; i < threadCount; i++) {
+        int previousID = -1;
+        for (int j = 0; j < chunks[i].shipmentCount; j++) {
+            int customerID = chunks[i].shipments[j].customerID;
+            if (customerID == previousID) continue;
+            previousID = customerID;
+            Customer* customer = findCustomer(customerID);
+            if (customer != NULL) loadCustomerHistory(customer);
+        }
+    }
+
+    // Parcalarin sirali gonderi dizilerini k-yollu birlestir, musteri basina bir parti.
+    // Tum parti tek bir surumle damgalanir; okuyucular aktarimi butun olarak gorur.
+    if (opLogActive) {
+        discardOpLog("CSV aktarimi gecmisleri degistirdi");
+    }
+    uint32_t batchVersion = beginWrite();
+    ImportError* lateErrors = NULL;
+    int lateErrorCount = 0, lateErrorCapacity = 0;
+    int position[IMPORT_MAX_THREADS] = { 0 };
+    while (1) {
+        int best = pickNextImportChunk(chunks, position, threadCount);
+        if (best < 0) break;
+
+        int customerID = chunks[best].shipments[position[best]].customerID;
+        Customer* customer = findCustomer(customerID);
+        const char* rowError = customer == NULL ? "Musteri bulunamadi."
+                             : isSpilledHistory(customer->shipmentHistory) ? "Musteri gecmisi diskten okunamadi."
+                             : NULL;
+        Shipment* batchHead = NULL;
+        Shipment** batchTail = &batchHead;
+
+        // Ayni musteriye ait tum satirlari sirayla tuket
+        while (best >= 0 && chunks[best].shipments[position[best]].customerID == customerID) {
+            ImportShipmentRow* row = &chunks[best].shipments[position[best]++];
+            if (rowError != NULL) {
+                if (lateErrorCount == lateErrorCapacity) {
+                    lateErrorCapacity = lateErrorCapacity ? lateErrorCapacity * 2 : 16;
+                    lateErrors = (ImportError*)safeRealloc(lateErrors, lateErrorCapacity * sizeof(ImportError));
+                }
+                lateErrors[lateErrorCount].line = row->line;
+                lateErrors[lateErrorCount].message = rowError;
+                lateErrorCount++;
+            } else {
+                Shipment* shipment = (Shipment*)safeMalloc(sizeof(Shipment));
+                shipment->shipmentID = shipmentIDBase[best] + row->sequence;
+                strcpy(shipment->date, row->date);
+                strcpy(shipment->status, row->status);
+                shipment->deliveryTime = row->deliveryTime;
+                shipment->version = batchVersion;
+                shipment->next = NULL;
+                trackMemory(MEMORY_HISTORIES, sizeof(Shipment));
+                *batchTail = shipment;
+                batchTail = &shipment->next;
+                recordShipmentRollup(customerID, shipment);
+                (*importedShipments)++;
+            }
+
+            best = pickNextImportChunk(chunks, position, threadCount);
+        }
+
+        if (rowError == NULL) {
+            mergeShipmentBatch(customer, batchHead);
+        }
+    }
+    commitWrite(); // Yeni surum eski disa aktarim ipuclarini da bir kerede gecersiz kilar
+    enforceMemoryCeiling(); // Tasima surum yayimlar; pencere kapandiktan sonra
+
+    // Hatalari satir sirasiyla raporla
+    qsort(lateErrors, lateErrorCount, sizeof(ImportError), compareImportErrors);
+    int errorCount = lateErrorCount;
+    for (int i = 0; i < threadCount; i++) errorCount += chunks[i].errorCount;
+
+    int lateIndex = 0;
+    for (int i = 0; i < threadCount; i++) {
+        for (int j = 0; j < chunks[i].errorCount; j++) {
+            while (lateIndex < lateErrorCount && lateErrors[lateIndex].line < chunks[i].errors[j].line) {
+                printInfo("Satir %d: %s\n", lateErrors[lateIndex].line, lateErrors[lateIndex].message);
+                lateIndex++;
+            }
+            printInfo("Satir %d: %s\n", chunks[i].errors[j].line, chunks[i].errors[j].message);
+        }
+    }
+    for (; lateIndex < lateErrorCount; lateIndex++) {
+        printInfo("Satir %d: %s\n", lateErrors[lateIndex].line, lateErrors[lateIndex].message);
+    }
+
+    free(lateErrors);
+    for (int i = 0; i < threadCount; i++) {
+        freeImportChunk(&chunks[i]);
+    }
+    munmap((void*)data, size);
+    return errorCount;
+}
+
+int defaultThreadCount() {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+}
+
+// Hub Kuyruklari ve Is Calan Isci Havuzu
+//
+// Her sehrin (hub) kendi oncelik kuyrugu vardir; kargo hedef sehrinin
+// kuyruguna girer. drainHubQueues bir isci havuzu baslatir: her isci kendi
+// hub'larini (indeks % isci sayisi) bosaltir, bosta kalinca once kendi
+// hub'larinin kardes ve ebeveynlerinden en kalabalik olani, o da yoksa agin
+// tamamindaki en kalabalik kuyrugu calar. Her kuyrugun kendi kilidi oldugundan
+// Istanbul gibi yogun bir hub diger hub'larin islenmesini bekletmez; kilit
+// trafigini azaltmak icin tek seferde HUB_TAKE_BATCH kargo alinir.
+//
+// Hub'lar sehre ilk kargo geldiginde tek tek acilir; kardesler ve ebeveyn
+// ayrica saklanmaz, calma sirasinda sehir agacindan yurunur.
+#define HUB_TAKE_BATCH 16
+
+typedef struct HubQueue {
+    pthread_mutex_t lock;
+    HubParcel* heap;   // deliveryTime'a gore ikili yigin
+    int count;         // Kilit altinda yazilir; calma karari icin kilitsiz okunur
+    int capacity;
+    uint32_t nextSequence;
+    CityNode* city;
+    CityNode* parentCity; // Kok icin NULL
+    long dispatched;   // Bu kuyruktan islenen kargo
+    long stolen;       // Bunlardan baska hub'larin iscilerince alinanlar
+} __attribute__((aligned(64))) HubQueue; // Kuyruklar ayri onbellek satirlarinda
+
+typedef struct HubWorker {
+    pthread_t thread;
+    int index;
+    int workerCount;
+    HubParcelHandler handler;
+    void* context;
+} HubWorker;
+
+HubQueue* hubQueues = NULL;
+int hubQueueCount = 0;
+int hubQueueCapacity = 0;
+int* hubByCityID = NULL; // Sehir ID'sinden hub indeksine (-1: yok)
+int hubByCityCapacity = 0;
+
+int hubQueuesBuilt() {
+    return hubQueueCount > 0;
+}
+
+int hubOfCity(int cityID) {
+    return cityID > 0 && cityID < hubByCityCapacity ? hubByCityID[cityID] : -1;
+}
+
+int hubParcelBefore(const HubParcel* a, const HubParcel* b) {
+    return a->deliveryTime < b->deliveryTime ||
+           (a->deliveryTime == b->deliveryTime && (int32_t)(a->sequence - b->sequence) < 0);
+}
+
+// Hub dizisini iki katina buyutur. Kilitler tasinamadigindan yeni dizide
+// yeniden kurulur; yiginlar ve sayaclar oldugu gibi aktarilir.
+void growHubQueues() {
+    int capacity = hubQueueCapacity ? hubQueueCapacity * 2 : 64;
+    HubQueue* queues = (HubQueue*)aligned_alloc(64, capacity * sizeof(HubQueue));
+    if (queues == NULL) {
+        printf("Bellek tahsisi basarisiz oldu.\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(queues, 0, capacity * sizeof(HubQueue));
+    for (int i = 0; i < hubQueueCount; i++) {
+        pthread_mutex_destroy(&hubQueues[i].lock);
+        queues[i] = hubQueues[i];
+        pthread_mutex_init(&queues[i].lock, NULL);
+    }
+    free(hubQueues);
+    hubQueues = queues;
+    hubQueueCapacity = capacity;
+}
+
+// Sehir icin hub acar ve indeksini doner; diger hub'lara dokunulmaz
+int addHubQueue(CityNode* city) {
+    if (opLogActive) {
+        discardOpLog("hub kuyruklari sehir agini sabitledi");
+    }
+    if (hubQueueCount == hubQueueCapacity) {
+        growHubQueues();
+    }
+    if (city->cityID >= hubByCityCapacity) {
+        int capacity = hubByCityCapacity ? hubByCityCapacity : 64;
+        while (capacity <= city->cityID) capacity *= 2;
+        hubByCityID = (int*)safeRealloc(hubByCityID, capacity * sizeof(int));
+        for (int i = hubByCityCapacity; i < capacity; i++) hubByCityID[i] = -1;
+        hubByCityCapacity = capacity;
+    }
+
+    int hub = hubQueueCount++;
+    HubQueue* queue = &hubQueues[hub];
+    pthread_mutex_init(&queue->lock, NULL);
+    queue->city = city;
+    queue->parentCity = findCityByID(cityIndexEntry(&cityIndex, city->cityID)->parentCityID);
+    hubByCityID[city->cityID] = hub;
+    return hub;
+}
+
+// Agdaki hub'i olmayan tum sehirlere hub acar (olcumler kuyruklari onceden
+// kurar). Agac yigitla ve on-sirayla dolasilir; bos agda kok ilk hub olur.
+void buildHubQueues() {
+    if (root == NULL) return;
+    int capacity = 64, top = 0;
+    CityNode** stack = (CityNode**)safeMalloc(capacity * sizeof(CityNode*));
+    stack[top++] = root;
+    while (top > 0) {
+        CityNode* node = stack[--top];
+        if (hubOfCity(node->cityID) < 0) addHubQueue(node);
+        if (top + 2 > capacity) {
+            capacity *= 2;
+            stack = (CityNode**)safeRealloc(stack, capacity * sizeof(CityNode*));
+        }
+        if (node->sibling != NULL) stack[top++] = node->sibling;
+        if (node->child != NULL) stack[top++] = node->child;
+    }
+    free(stack);
+}
+
+// Kargoyu hedef sehrin kuyruguna ekler (sehir yoksa 0 doner). Kuyruga ekleme
+// kilitlidir, fakat yeni bir sehrin hub'i acilirken hub dizisi buyuyebildiginden
+// drainHubQueues calisirken yeni sehirlere kargo eklenmemelidir.
+int enqueueHubParcel(int cityID, int shipmentID, int deliveryTime, const char* status) {
+    int hub = hubOfCity(cityID);
+    if (hub < 0) {
+        CityNode* city = findCityByID(cityID);
+        if (city == NULL) {
+            return 0;
+        }
+        hub = addHubQueue(city);
+    }
+
+    HubQueue* queue = &hubQueues[hub];
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count == queue->capacity) {
+        queue->capacity = queue->capacity ? queue->capacity * 2 : 64;
+        queue->heap = (HubParcel*)safeRealloc(queue->heap, queue->capacity * sizeof(HubParcel));
+    }
+
+    HubParcel parcel;
+    parcel.shipmentID = shipmentID;
+    parcel.deliveryTime = deliveryTime;
+    parcel.sequence = queue->nextSequence++;
+    strncpy(parcel.status, status, sizeof(parcel.status) - 1);
+    parcel.status[sizeof(parcel.status) - 1] = '\0';
+
+    int index = queue->count;
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (!hubParcelBefore(&parcel, &queue->heap[parent])) break;
+        queue->heap[index] = queue->heap[parent];
+        index = parent;
+    }
+    queue->heap[index] = parcel;
+    __atomic_store_n(&queue->count, queue->count + 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&queue->lock);
+    return 1;
+}
+
+// Kuyruktan oncelik sirasiyla en fazla max kargo alir
+int takeHubParcels(int hub, HubParcel* out, int max, int stealing) {
+    HubQueue* queue = &hubQueues[hub];
+    pthread_mutex_lock(&queue->lock);
+    int taken = 0;
+    while (taken < max && queue->count > 0) {
+        out[taken++] = queue->heap[0];
+
+        int count = queue->count - 1;
+        HubParcel last = queue->heap[count];
+        int index = 0;
+        while (1) {
+            int child = 2 * index + 1;
+            if (child >= count) break;
+            if (child + 1 < count && hubParcelBefore(&queue->heap[child + 1], &queue->heap[child])) {
+                child++;
+            }
+            if (!hubParcelBefore(&queue->heap[child], &last)) break;
+            queue->heap[index] = queue->heap[child];
+            index = child;
+        }
+        queue->heap[index] = last;
+        __atomic_store_n(&queue->count, count, __ATOMIC_RELAXED);
+    }
+    queue->dispatched += taken;
+    if (stealing) queue->stolen += taken;
+    pthread_mutex_unlock(&queue->lock);
+    return taken;
+}
+
+// Hub'un ebeveyni ve kardesleri (kok icin cocuklari) arasindan en kalabalik
+// kuyruk (hepsi bossa -1). Hub'i olmayan sehirlerin kuyrugu yoktur.
+int busiestNeighborHub(int hub) {
+    const HubQueue* queue = &hubQueues[hub];
+    int best = -1, bestCount = 0;
+    CityNode* node = readPointer(queue->city->child);
+    if (queue->parentCity != NULL) {
+        int parent = hubOfCity(queue->parentCity->cityID);
+        if (parent >= 0) {
+            bestCount = __atomic_load_n(&hubQueues[parent].count, __ATOMIC_RELAXED);
+            best = bestCount > 0 ? parent : -1;
+        }
+        node = readPointer(queue->parentCity->child);
+    }
+    for (; node != NULL; node = readPointer(node->sibling)) {
+        int candidate = hubOfCity(node->cityID);
+        if (candidate < 0 || candidate == hub) continue;
+        int count = __atomic_load_n(&hubQueues[candidate].count, __ATOMIC_RELAXED);
+        if (count > bestCount) {
+            best = candidate;
+            bestCount = count;
+        }
+    }
+    return best;
+}
+
+int busiestHubAnywhere() {
+    int best = -1, bestCount = 0;
+    for (int i = 0; i < hubQueueCount; i++) {
+        int count = __atomic_load_n(&hubQueues[i].count, __ATOMIC_RELAXED);
+        if (count > bestCount) {
+            best = i;
+            bestCount = count;
+        }
+    }
+    return best;
+}
+
+void* hubWorkerMain(void* argument) {
+    HubWorker* worker = (HubWorker*)argument;
+    HubParcel batch[HUB_TAKE_BATCH];
+    int next = worker->index;
+
+    while (1) {
+        int hub = -1, taken = 0;
+
+        // Kendi hub'lari, kaldigi yerden sirayla
+        for (int tried = 0; tried < hubQueueCount && taken == 0; tried += worker->workerCount) {
+            if (next >= hubQueueCount) next = worker->index;
+            if (next >= hubQueueCount) break;
+            hub = next;
+            next += worker->workerCount;
+            taken = takeHubParcels(hub, batch, HUB_TAKE_BATCH, 0);
+        }
+
+        // Calma: once kendi hub'larinin komsulari, sonra tum ag
+        if (taken == 0) {
+            int victim = -1;
+            for (int own = worker->index; own < hubQueueCount && victim < 0; own += worker->workerCount) {
+                victim = busiestNeighborHub(own);
+            }
+            if (victim < 0) victim = busiestHubAnywhere();
+            if (victim < 0) break; // Tum kuyruklar bos
+            hub = victim;
+            taken = takeHubParcels(hub, batch, HUB_TAKE_BATCH, 1);
+        }
+
+        for (int i = 0; i < taken; i++) {
+            worker->handler(hub, &batch[i], worker->context);
+        }
+    }
+    return NULL;
+}
+
+// Tum hub kuyruklarini threadCount isciyle bosaltir; islenen kargo sayisini doner.
+// handler her kargo icin isci is parcaciginda cagrilir. Isciler her kuyrugu bos
+// gordugunde cikar.
+long drainHubQueues(int threadCount, HubParcelHandler handler, void* context) {
+    if (threadCount < 1) threadCount = 1;
+    long before = 0, after = 0;
+    for (int i = 0; i < hubQueueCount; i++) before += hubQueues[i].dispatched;
+
+    HubWorker* workers = (HubWorker*)safeMalloc(threadCount * sizeof(HubWorker));
+    int* started = (int*)safeMalloc(threadCount * sizeof(int));
+    for (int i = 0; i < threadCount; i++) {
+        workers[i].index = i;
+        workers[i].workerCount = threadCount;
+        workers[i].handler = handler;
+        workers[i].context = context;
+        started[i] = pthread_create(&workers[i].thread, NULL, hubWorkerMain, &workers[i]) == 0;
+    }
+    // Acilamayan iscinin kuyruklari burada bosaltilir (digerleri de calarak yardim eder)
+    for (int i = 0; i < threadCount; i++) {
+        if (!started[i]) hubWorkerMain(&workers[i]);
+    }
+    for (int i = 0; i < threadCount; i++) {
+        if (started[i]) pthread_join(workers[i].thread, NULL);
+    }
+    free(started);
+    free(workers);
+
+    for (int i = 0; i < hubQueueCount; i++) after += hubQueues[i].dispatched;
+    return after - before;
+}
+
+// Menuden bosaltilan her kargo, isleyen iscide hub'i ile birlikte yazdirilir
+void printHubParcel(int hub, const HubParcel* parcel, void* context) {
+    (void)context;
+    printf("%-20s Kargo ID: %d, Teslim Suresi: %d gun, Durum: %s\n",
+           hubQueues[hub].city->cityName, parcel->shipmentID, parcel->deliveryTime, parcel->status);
+}
+
+void displayHubQueues() {
+    int printed = 0;
+    for (int i = 0; i < hubQueueCount; i++) {
+        HubQueue* queue = &hubQueues[i];
+        if (queue->count == 0 && queue->dispatched == 0) continue;
+        if (printed++ == 0) {
+            printf("Hub                  Bekleyen  Islenen  Calinan\n");
+        }
+        printf("%-20s %8d %8ld %8ld\n", queue->city->cityName, queue->count, queue->dispatched, queue->stolen);
+    }
+    if (printed == 0) {
+        printf("Hub kuyruklari bos.\n");
+    }
+}
+
+void freeHubQueues() {
+    for (int i = 0; i < hubQueueCount; i++) {
+        free(hubQueues[i].heap);
+        pthread_mutex_destroy(&hubQueues[i].lock);
+    }
+    free(hubQueues);
+    hubQueues = NULL;
+    hubQueueCount = 0;
+    hubQueueCapacity = 0;
+    free(hubByCityID);
+    hubByCityID = NULL;
+    hubByCityCapacity = 0;
+}
+
+// Sunucu Modu (Unix Domain Socket + epoll)
+//
+// Cerceve formati: [u32 uzunluk][govde]. Tum tamsayilar little-endian.
+// Istek govdesi: [u8 islem kodu][parametreler]
+// Yanit govdesi: [u8 durum kodu][sonuc alanlari]
+// Metinler [u8 uzunluk][bayt] olarak kodlanir. Bir baglanti uzerinden
+// birden fazla istek ardisik (pipeline) gonderilebilir; yanitlar istek
+// sirasiyla doner.
+#define SERVER_MAX_EVENTS 64
+#define SERVER_MAX_FRAME 65536
+#define SERVER_READ_CHUNK 16384
+#define SERVER_OUTPUT_LIMIT (4 * 1024 * 1024) // Gonderilmemis yanit bu boyutu asinca okuma durur
+
+enum ServerOpcode {
+    OP_ADD_CUSTOMER = 1,      // str ad, str soyad -> i32 musteriID
+    OP_ADD_SHIPMENT = 2,      // i32 musteriID, str tarih, str durum, i32 sure -> i32 gonderiID
+    OP_GET_SHIPMENTS = 3,     // i32 musteriID -> i32 adet, adet x gonderi
+    OP_QUEUE_ADD = 4,         // i32 kargoID, i32 sure, str durum (kuyruktaysa STATUS_DUPLICATE)
+    OP_QUEUE_PROCESS = 5,     // -> i32 kargoID, i32 sure, str durum
+    OP_QUEUE_LIST = 6,        // -> i32 adet, adet x (i32 kargoID, i32 sure, str durum)
+    OP_STACK_PUSH = 7,        // i32 gonderiID, str tarih, str durum, i32 sure (stack'teyse STATUS_DUPLICATE)
+    OP_STACK_POP = 8,         // -> gonderi
+    OP_STACK_LIST = 9,        // -> i32 adet, adet x gonderi
+    OP_CITY_ADD = 10,         // i32 ebeveynID, str sehir, i32 sure -> i32 sehirID
+    OP_CITY_STATS = 11,       // -> i32 sehir sayisi, i32 derinlik, i32 en kisa sure
+    OP_SEARCH_DELIVERED = 12, // i32 musteriID, str tarih -> gonderi
+    OP_COUNT_SHIPMENTS = 13,  // i32 musteriID -> i32 adet
+    OP_LAST_FIVE = 14,        // -> i32 adet, adet x gonderi
+    OP_FIND_BY_NAME = 15,     // str soyad, u8 onek, i32 baslangic, i32 limit
+                              // -> i32 toplam, i32 adet, adet x (i32 musteriID, str ad, str soyad)
+    OP_UPDATE_STATUS = 16,    // i32 musteriID, i32 gonderiID, str durum
+    OP_DAILY_ROLLUP = 17,     // i32 gun sayisi (bugun dahil) -> i32 adet, adet x (str tarih, i32 gonderi,
+                              //                   i32 ort. x100, i32 min, i32 max, i32 p50, i32 p95)
+    OP_EXPORT = 18,           // i32 musteriID (0 = tum), str anahtar ("" = bastan), u8 bicim (1 CSV, 2 JSONL),
+                              // i32 limit -> i32 adet, str sonraki anahtar ("" = bitti), i32 bayt, metin
+    OP_LAST_SHIPMENTS = 19,   // i32 k -> i32 adet, adet x gonderi (en yeni once)
+    OP_FLEET_TOTALS = 20,     // -> i32 musteri, i32 gonderi, i32 durum sayisi, n x (str durum, i32 adet)
+                              //    (durumlar ada gore sirali)
+    OP_ROLLUP_HISTOGRAMS = 21 // Bolumlu mod ic istegi: i32 gun sayisi, [i32 son gun (yoksa bugun)]
+                              //   -> i32 son gun, i32 adet, adet x
+                              //   (i32 gun, i32 adet, i32 toplam (alt), i32 toplam (ust), i32 min, i32 max,
+                              //    i32 dolu kova, n x (i32 kova, i32 adet)); veri yoksa STATUS_EMPTY
+};
+
+#define SERVER_MAX_EXPORT_RECORDS 10000 // OP_EXPORT sayfa siniri
+#define SERVER_MAX_LAST_SHIPMENTS 100   // OP_LAST_SHIPMENTS k siniri
+
+enum ServerStatus {
+    STATUS_OK = 0,
+    STATUS_NOT_FOUND = 1,
+    STATUS_INVALID = 2,
+    STATUS_EMPTY = 3,
+    STATUS_BAD_REQUEST = 4,
+    STATUS_DUPLICATE = 5,
+    STATUS_UNAVAILABLE = 6 // Bolum iscisi yanit vermiyor; sunucu kapaniyor
+};
+
+// Istek govdesini sinir kontrolu ile okuyan yardimci yapi
+typedef struct ByteReader {
+    const unsigned char* data;
+    size_t length;
+    size_t offset;
+    int failed;
+} ByteReader;
+
+// Istemci baglantisi
+typedef struct ClientConnection {
+    int fd;
+    ByteBuffer input;
+    ByteBuffer output;
+    size_t outputSent;
+    uint32_t events;  // epoll'a kayitli olay maskesi
+    int readClosed;   // Istemci yazmayi bitirdi; yanitlar gonderilince kapatilir
+    int hungUp;       // Karsi taraf tamamen kapandi; kalan girdi yine de islenir
+} ClientConnection;
+
+// Istemci yanitlari okumadan istek gondermeye devam ederse cikis tamponu
+// sinirsiz buyumesin diye okuma ve cerceve isleme durdurulur; EPOLLOUT ile
+// tampon bosaldikca devam edilir. Istemci yazmayi bitirdiyse (ya da
+// baglanti koptuysa) yeni girdi gelmeyecegi icin sinir uygulanmaz.
+int clientOutputFull(const ClientConnection* client) {
+    return !client->readClosed && !client->hungUp &&
+           client->output.length - client->outputSent > SERVER_OUTPUT_LIMIT;
+}
+
+volatile sig_atomic_t serverStopRequested = 0;
+
+void bufferReserve(ByteBuffer* buffer, size_t extra) {
+    if (buffer->length + extra <= buffer->capacity) {
+        return;
+    }
+    size_t newCapacity = buffer->capacity ? buffer->capacity : 256;
+    while (newCapacity < buffer->length + extra) {
+        newCapacity *= 2;
+    }
+    buffer->data = (unsigned char*)safeRealloc(buffer->data, newCapacity);
+    buffer->capacity = newCapacity;
+}
+
+void bufferAppend(ByteBuffer* buffer, const void* bytes, size_t count) {
+    bufferReserve(buffer, count);
+    memcpy(buffer->data + buffer->length, bytes, count);
+    buffer->length += count;
+}
+
+void bufferAppendU8(ByteBuffer* buffer, unsigned int value) {
+    unsigned char byte = (unsigned char)value;
+    bufferAppend(buffer, &byte, 1);
+}
+
+void bufferAppendInt32(ByteBuffer* buffer, int32_t value) {
+    uint32_t v = (uint32_t)value;
+    unsigned char bytes[4] = { v & 0xFF, (v >> 8) & 0xFF, (v >> 16) & 0xFF, (v >> 24) & 0xFF };
+    bufferAppend(buffer, bytes, 4);
+}
+
+void bufferAppendString(ByteBuffer* buffer, const char* text) {
+    size_t length = strlen(text);
+    if (length > 255) length = 255;
+    bufferAppendU8(buffer, (unsigned int)length);
+    bufferAppend(buffer, text, length);
+}
+
+void bufferFree(ByteBuffer* buffer) {
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->length = buffer->capacity = 0;
+}
+
+uint32_t decodeU32(const unsigned char* bytes) {
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) |
+           ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+int32_t readInt32(ByteReader* reader) {
+    if (reader->failed || reader->length - reader->offset < 4) {
+        reader->failed = 1;
+        return 0;
+    }
+    int32_t value = (int32_t)decodeU32(reader->data + reader->offset);
+    reader->offset += 4;
+    return value;
+}
+
+// Metni out'a NUL ile sonlandirarak kopyalar; kapasiteye sigmazsa okuma basarisiz olur
+void readString(ByteReader* reader, char* out, size_t capacity) {
+    out[0] = '\0';
+    if (reader->failed || reader->offset >= reader->length) {
+        reader->failed = 1;
+        return;
+    }
+    size_t length = reader->data[reader->offset++];
+    if (length >= capacity || reader->length - reader->offset < length) {
+        reader->failed = 1;
+        return;
+    }
+    memcpy(out, reader->data + reader->offset, length);
+    out[length] = '\0';
+    reader->offset += length;
+}
+
+void appendShipmentRecord(ByteBuffer* out, int shipmentID, const char* date, const char* status, int deliveryTime) {
+    bufferAppendInt32(out, shipmentID);
+    bufferAppendString(out, date);
+    bufferAppendString(out, status);
+    bufferAppendInt32(out, deliveryTime);
+}
+
+// OP_DAILY_ROLLUP yaniti: endDay'de biten dayCount gunun bos olmayanlari
+void appendDailyRollups(ByteBuffer* out, int endDay, int dayCount, const DeliveryRollup* days) {
+    char date[11];
+    int nonEmpty = 0;
+    for (int i = 0; i < dayCount; i++) nonEmpty += days[i].count > 0;
+
+    bufferAppendU8(out, STATUS_OK);
+    bufferAppendInt32(out, nonEmpty);
+    for (int i = 0; i < dayCount; i++) {
+        if (days[i].count == 0) continue;
+        daysToDate(endDay - dayCount + 1 + i, date);
+        bufferAppendString(out, date);
+        bufferAppendInt32(out, (int32_t)days[i].count);
+        bufferAppendInt32(out, (int32_t)(days[i].sum * 100 / days[i].count));
+        bufferAppendInt32(out, days[i].min);
+        bufferAppendInt32(out, days[i].max);
+        bufferAppendInt32(out, rollupPercentile(&days[i], 0.50));
+        bufferAppendInt32(out, rollupPercentile(&days[i], 0.95));
+    }
+}
+
+// Tek bir istegi isler ve yanit govdesini out'a yazar
+void handleServerRequest(ByteReader* request, ByteBuffer* out) {
+    char firstName[50], lastName[50], date[11], status[20], cityName[50];
+    int opcode = -1;
+
+    if (request->length > 0) {
+        opcode = request->data[request->offset++];
+    }
+
+    switch (opcode) {
+        case OP_ADD_CUSTOMER: {
+            readString(request, firstName, sizeof(firstName));
+            readString(request, lastName, sizeof(lastName));
+            if (request->failed) break;
+            if (!isValidName(firstName, 50) || !isValidName(lastName, 50)) {
+                bufferAppendU8(out, STATUS_INVALID);
+                return;
+            }
+            bufferAppendU8(out, STATUS_OK);
+            bufferAppendInt32(out, addCustomer(firstName, lastName));
+            return;
+        }
+        case OP_ADD_SHIPMENT: {
+            int customerID = readInt32(request);
+            readString(request, date, sizeof(date));
+            readString(request, status, sizeof(status));
+            int deliveryTime = readInt32(request);
+            if (request->failed) break;
+            if (!isValidDate(date) || !isValidName(status, 20) || !isPositiveNumber(deliveryTime)) {
+                bufferAppendU8(out, STATUS_INVALID);
+                return;
+            }
+            if (findCustomer(customerID) == NULL) {
+                bufferAppendU8(out, STATUS_NOT_FOUND);
+                return;
+            }
+            bufferAppendU8(out, STATUS_OK);
+            bufferAppendInt32(out, addShipment(customerID, date, status, deliveryTime));
+            return;
+        }
+        case OP_GET_SHIPMENTS: {
+            int customerID = readInt32(request);
+            if (request->failed) break;
+            Customer* customer = findCustomer(customerID);
+            if (customer == NULL) {
+                bufferAppendU8(out, STATUS_NOT_FOUND);
+                return;
+            }
+            bufferAppendU8(out, STATUS_OK);
+            bufferAppendInt32(out, countCustomerShipments(customer));
+
+            Shipment archived;
+            ArchiveCursor cursor;
+            ArchiveBlock** archive = customerArchive(customer);
+            openArchiveCursor(&cursor, archive ? *archive : NULL);
+            while (nextArchivedShipment(&cursor, &archived)) {
+                appendShipmentRecord(out, archived.shipmentID, archived.date, archived.status, archived.deliveryTime);
+            }
+            for (Shipment* s = customerHistory(customer); s != NULL; s = s->next) {
+                appendShipmentRecord(out, s->shipmentID, s->date, s->status, s->deliveryTime);
+            }
+            return;
+        }
+        case OP_QUEUE_ADD: {
+            int shipmentID = readInt32(request);
+            int deliveryTime = readInt32(request);
+            readString(request, status, sizeof(status));
+            if (request->failed) break;
+            if (!isPositiveNumber(shipmentID) || !isPositiveNumber(deliveryTime) || !isValidName(status, 20)) {
+                bufferAppendU8(out, STATUS_INVALID);
+                return;
+            }
+            bufferAppendU8(out, addToPriorityQueue(shipmentID, deliveryTime, status) ? STATUS_OK : STATUS_DUPLICATE);
+            return;
+        }
+        case OP_QUEUE_PROCESS: {
+            PriorityQueueNode head;
+            if (!takePriorityQueueHead(&head)) {
+                bufferAppendU8(out, STATUS_EMPTY);
+                return;
+            }
+            bufferAppendU8(out, STATUS_OK);
+            bufferAppendInt32(out, head.shipmentID);
+            bufferAppendInt32(out, head.deliveryTime);
+            bufferAppendString(out, head.status);
+            return;
+        }
+        case OP_QUEUE_LIST: {
+            int count = 0;
+            for (PriorityQueueNode* node = priorityQueue; node != NULL; node = node->next) count++;
+            bufferAppendU8(out, STATUS_OK);
+            bufferAppendInt32(out, count);
+            for (PriorityQueueNode* node = priorityQueue; node != NULL; node = node->next) {
+                bufferAppendInt32(out, node->shipmentID);
+                bufferAppendInt32(out, node->deliveryTime);
+                bufferAppendString(out, node->status);
+            }
+            return;
+        }
+        case OP_STACK_PUSH: {
+            int shipmentID = readInt32(request);
+            readString(request, date, sizeof(date));
+            readString(request, status, sizeof(status));
+            int deliveryTime = readInt32(request);
+            if (request->failed) break;
+            if (!isPositiveNumber(shipmentID) || !isValidDate(date) ||
+                !isValidName(status, 20) || !isPositiveNumber(deliveryTime)) {
+                bufferAppendU8(out, STATUS_INVALID);
+                return;
+            }
+            bufferAppendU8(out, pushShipment(shipmentID, date, status, deliveryTime) ? STATUS_OK : STATUS_DUPLICATE);
+            return;
+        }
+        case OP_STACK_POP: {
+            ShipmentStackNode top;
+            if (!takeStackTop(&top)) {
+                bufferAppendU8(out, STATUS_EMPTY);
+                return;
+            }
+            bufferAppendU8(out, STATUS_OK);
+            appendShipmentRecord(out, top.shipmentID, top.date, top.status, top.deliveryTime);
+            return;
+        }
+        case OP_STACK_LIST: {
+            int count = 0;
+            for (ShipmentStackNode* node = shipmentStack; node != NULL; node = node->next) count++;
+            bufferAppendU8(out, STATUS_OK);
+            bufferAppendInt32(out, count);
+            for (ShipmentStackNode* node = shipmentStack; node != NULL; node = node->next) {
+                appendShipmentRecord(out, node->shipmentID, node->date, node->status, node->deliveryTime);
+            }
+            return;
+        }
+        case OP_CITY_ADD: {
+            int parentCityID = readInt32(request);
+            readString(request, cityName, sizeof(cityName));
+            int deliveryTime = readInt32(request);
+            if (request->failed) break;
+            if (!isPositiveNumber(parentCityID) || !isValidName(cityName, 50) || !isPositiveNumber(deliveryTime)) {
+                bufferAppendU8(out, STATUS_INVALID);
+                return;
+            }
+            int cityID = addCity(parentCityID, 0, cityName, deliveryTime);
+            if (cityID == 0) {
+                bufferAppendU8(out, STATUS_NOT_FOUND);
+                return;
+            }
+            bufferAppendU8(out, STATUS_OK);
+            bufferAppendInt32(out, cityID);
+            return;
+        }
+        case OP_CITY_STATS: {
+            int minDeliveryTime = calculateMinDeliveryTime(root);
+            bufferAppendU8(out, STATUS_OK);
+            bufferAppendInt32(out, countCities(root));
+            bufferAppendInt32(out, calculateTreeDepth(root));
+            bufferAppendInt32(out, minDeliveryTime == INT_MAX ? 0 : minDeliveryTime);
+            return;
+        }
+        case OP_SEARCH_DELIVERED: {
+            int customerID = readInt32(request);
+            readString(request, date, sizeof(date));
+            if (request->failed) break;
+            if (!isValidDate(date)) {
+                bufferAppendU8(out, STATUS_INVALID);
+                return;
+            }
+            Customer* customer = findCustomer(customerID);
+            Shipment scratch;
+            Shipment* result = customer ? searchDeliveredShipments(customer, date, &scratch) : NULL;
+            if (result == NULL) {
+                bufferAppendU8(out, STATUS_NOT_FOUND);
+                return;
+            }
+            bufferAppendU8(out, STATUS_OK);
+            appendShipmentRecord(out, result->shipmentID, result->date, result->status, result->deliveryTime);
+            return;
+        }
+        case OP_COUNT_SHIPMENTS: {
+            int customerID = readInt32(request);
+            if (request->failed) break;
+            Customer* customer = findCustomer(customerID);
+            if (customer == NULL) {
+                bufferAppendU8(out, STATUS_NOT_FOUND);
+                return;
+            }
+            bufferAppendU8(out, STATUS_OK);
+            bufferAppendInt32(out, countCustomerShipments(customer));
+            return;
+        }
+        case OP_FIND_BY_NAME: {
+            char lastNameQuery[50];
+            Customer* page[64];
+            int total = 0;
+            readString(request, lastNameQuery, sizeof(lastNameQuery));
+            int prefix = 0;
+            if (!request->failed && request->offset < request->length) {
+                prefix = request->data[request->offset++];
+            } else {
+                request->failed = 1;
+            }
+            int offset = readInt32(request);
+            int limit = readInt32(request);
+            if (request->failed) break;
+            if (offset < 0 || limit <= 0 || limit > 64) {
+                bufferAppendU8(out, STATUS_INVALID);
+                return;
+            }
+            int count = searchCustomersByName(lastNameQuery, NULL, prefix, offset, limit, page, &total);
+            bufferAppendU8(out, STATUS_OK);
+            bufferAppendInt32(out, total);
+            bufferAppendInt32(out, count);
+            for (int i = 0; i < count; i++) {
+                bufferAppendInt32(out, page[i]->customerID);
+                bufferAppendString(out, customerFirstName(page[i]));
+                bufferAppendString(out, customerLastName(page[i]));
+            }
+            return;
+        }
+        case OP_UPDATE_STATUS: {
+            int customerID = readInt32(request);
+            int shipmentID = readInt32(request);
+            readString(request, status, sizeof(status));
+            if (request->failed) break;
+            if (!isValidName(status, 20)) {
+                bufferAppendU8(out, STATUS_INVALID);
+                return;
+            }
+            bufferAppendU8(out, updateShipmentStatus(customerID, shipmentID, status) ? STATUS_OK : STATUS_NOT_FOUND);
+            return;
+        }
+        case OP_DAILY_ROLLUP: {
+            int dayCount = readInt32(request);
+            if (request->failed) break;
+            if (dayCount <= 0 || dayCount > ROLLUP_MAX_QUERY_DAYS) {
+                bufferAppendU8(out, STATUS_INVALID);
+                return;
+            }
+            if (rollupLastDay == INT_MIN) {
+                bufferAppendU8(out, STATUS_EMPTY);
+                return;
+            }
+
+            int endDay = currentDay();
+            DeliveryRollup* days = (DeliveryRollup*)safeMalloc(dayCount * sizeof(DeliveryRollup));
+            collectDailyRollups(endDay, dayCount, days);
+            appendDailyRollups(out, endDay, dayCount, days);
+            free(days);
+            return;
+        }
+        case OP_ROLLUP_HISTOGRAMS: {
+            int dayCount = readInt32(request);
+            int endDay = request->offset < request->length ? readInt32(request) : currentDay();
+            if (request->failed) break;
+            if (dayCount <= 0 || dayCount > ROLLUP_MAX_QUERY_DAYS) {
+                bufferAppendU8(out, STATUS_INVALID);
+                return;
+            }
+            if (rollupLastDay == INT_MIN) {
+                bufferAppendU8(out, STATUS_EMPTY);
+                return;
+            }
+
+            DeliveryRollup* days = (DeliveryRollup*)safeMalloc(dayCount * sizeof(DeliveryRollup));
+            collectDailyRollups(endDay, dayCount, days);
+            int nonEmpty = 0;
+            for (int i = 0; i < dayCount; i++) nonEmpty += days[i].count > 0;
+            bufferAppendU8(out, STATUS_OK);
+            bufferAppendInt32(out, endDay);
+            bufferAppendInt32(out, nonEmpty);
+            for (int i = 0; i < dayCount; i++) {
+                if (days[i].count == 0) continue;
+                bufferAppendInt32(out, endDay - dayCount + 1 + i);
+                bufferAppendInt32(out, (int32_t)days[i].count);
+                bufferAppendInt32(out, (int32_t)(uint32_t)days[i].sum);
+                bufferAppendInt32(out, (int32_t)(uint32_t)((uint64_t)days[i].sum >> 32));
+                bufferAppendInt32(out, days[i].min);
+                bufferAppendInt32(out, days[i].max);
+                int used = 0;
+                for (int b = 0; b < ROLLUP_BUCKETS; b++) used += days[i].buckets[b] != 0;
+                bufferAppendInt32(out, used);
+                for (int b = 0; b < ROLLUP_BUCKETS; b++) {
+                    if (days[i].buckets[b] == 0) continue;
+                    bufferAppendInt32(out, b);
+                    bufferAppendInt32(out, (int32_t)days[i].buckets[b]);
+                }
+            }
+            free(days);
+            return;
+        }
+        case OP_EXPORT: {
+            int customerID = readInt32(request);
+            char token[48];
+            readString(request, token, sizeof(token));
+            int format = 0;
+            if (!request->failed && request->offset < request->length) {
+                format = request->data[request->offset++];
+            } else {
+                request->failed = 1;
+            }
+            int limit = readInt32(request);
+            if (request->failed) break;
+
+            ExportCursor cursor;
+            if (customerID < 0 || (format != 1 && format != 2) || limit <= 0 || limit > SERVER_MAX_EXPORT_RECORDS ||
+                !parseExportToken(&cursor, token, customerID)) {
+                bufferAppendU8(out, STATUS_INVALID);
+                return;
+            }
+            if (customerID > 0 && findCustomer(customerID) == NULL) {
+                bufferAppendU8(out, STATUS_NOT_FOUND);
+                return;
+            }
+
+            ByteBuffer text = { NULL, 0, 0 };
+            int count = (int)exportShipments(&cursor, limit, format == 1 ? EXPORT_CSV : EXPORT_JSONL, &text);
+            formatExportToken(&cursor, token, sizeof(token));
+            bufferAppendU8(out, STATUS_OK);
+            bufferAppendInt32(out, count);
+            bufferAppendString(out, token);
+            bufferAppendInt32(out, (int32_t)text.length);
+            if (text.length > 0) bufferAppend(out, text.data, text.length);
+            bufferFree(&text);
+            return;
+        }
+        case OP_LAST_FIVE: {
+            Shipment lastFive[5];
+            int count = collectLastShipments(lastFive, 5);
+            bufferAppendU8(out, STATUS_OK);
+            bufferAppendInt32(out, count);
+            for (int i = 0; i < count; i++) {
+                appendShipmentRecord(out, lastFive[i].shipmentID, lastFive[i].date,
+                                     lastFive[i].status, lastFive[i].deliveryTime);
+            }
+            return;
+        }
+        case OP_LAST_SHIPMENTS: {
+            int limit = readInt32(request);
+            if (request->failed) break;
+            if (limit <= 0 || limit > SERVER_MAX_LAST_SHIPMENTS) {
+                bufferAppendU8(out, STATUS_INVALID);
+                return;
+            }
+            Shipment latest[SERVER_MAX_LAST_SHIPMENTS];
+            int count = collectLastShipments(latest, limit);
+            bufferAppendU8(out, STATUS_OK);
+            bufferAppendInt32(out, count);
+            for (int i = 0; i < count; i++) {
+                appendShipmentRecord(out, latest[i].shipmentID, latest[i].date, latest[i].status, latest[i].deliveryTime);
+            }
+            return;
+        }
+        case OP_FLEET_TOTALS: {
+            // Gonderi toplami durum ozetlerinden (arsivlenenler dahil) alinir
+            int order[statusRollupCount > 0 ? statusRollupCount : 1];
+            int shipments = 0;
+            for (int i = 0; i < statusRollupCount; i++) {
+                int j = i;
+                for (; j > 0 && strcmp(statusRollups[order[j - 1]].status, statusRollups[i].status) > 0; j--) {
+                    order[j] = order[j - 1];
+                }
+                order[j] = i;
+                shipments += (int)statusRollups[i].stats.count;
+            }
+            bufferAppendU8(out, STATUS_OK);
+            bufferAppendInt32(out, customerSlot(autoCustomerID) - 1);
+            bufferAppendInt32(out, shipments);
+            bufferAppendInt32(out, statusRollupCount);
+            for (int i = 0; i < statusRollupCount; i++) {
+                bufferAppendString(out, statusRollups[order[i]].status);
+                bufferAppendInt32(out, (int32_t)statusRollups[order[i]].stats.count);
+            }
+            return;
+        }
+    }
+
+    bufferAppendU8(out, STATUS_BAD_REQUEST);
+}
+
+// Cerceve basina ayrilan uzunluk alanini doldurur
+void patchFrameLength(ByteBuffer* buffer, size_t lengthSlot) {
+    uint32_t length = (uint32_t)(buffer->length - lengthSlot - 4);
+    unsigned char* slot = buffer->data + lengthSlot;
+    slot[0] = length & 0xFF;
+    slot[1] = (length >> 8) & 0xFF;
+    slot[2] = (length >> 16) & 0xFF;
+    slot[3] = (length >> 24) & 0xFF;
+}
+
+// Bolumlu Mod (Musteri ID'sine Gore Isci Surecler)
+//
+// --partitions N ile sunucu N isci sureci fork eder. Isci p, (ID - 1) mod N == p
+// olan musterileri tutar; ID'leri bu kurala gore kendisi urettigi icin (bkz.
+// idStride) on surecin yonlendirme tablosuna ihtiyaci yoktur. Yeni musteriler
+// iscilere sirayla verilir, boylece ID'ler tek surecli moddakiyle aynidir.
+//
+// On surec ile her isci arasinda paylasimli bellekte iki tek ureticili/tek
+// tuketicili bayt halkasi vardir (istekler, yanitlar). Halkadan soket
+// protokolunun cerceveleri aynen gecer ve isci istegi handleServerRequest ile
+// isler. Yanitlar her iscide istek sirasiyla doner; on surec bir istemcinin
+// ardisik isteklerini once iscilere dagitir, sonra yanitlari sirayla toplar.
+//
+// Tek musterili istekler musterinin iscisine, kuyruk/stack/sehir istekleri bu
+// yapilari tutan 0. isciye gider. Son K gonderi ve toplamlar tum iscilere
+// sorulup birlestirilir; isim aramasi ve tum filonun disa aktarimi birden fazla
+// tur gerektirdigi icin bekleyen istekler bittikten sonra tek basina islenir.
+// Disa aktarim bolum bolum ilerler (anahtardaki musteri ID'si bolumu belirler).
+// Gunluk ozetlerde iscilerin histogramlari on surecte toplanir.
+//
+// Bir isci olur ya da PARTITION_REPLY_TIMEOUT_MS boyunca ilerlemezse bekleyen
+// yanitlar STATUS_UNAVAILABLE olur ve sunucu EXIT_FAILURE ile kapanir.
+// Halka ve surecler arasi aktarim maliyeti nedeniyle tek CPU'da bolumlu mod tek
+// surecten yavastir (--bench-partitions); kazanc yalnizca cok cekirdekte beklenir.
+#define PARTITION_MAX 64
+#define PARTITION_RING_BYTES (1 << 20)
+#define PARTITION_PIPELINE 256    // On surecte ayni anda bekleyen en fazla istek
+#define PARTITION_SPIN_ROUNDS 256 // Uyumadan once halkanin kac kez yoklanacagi
+#define PARTITION_FAN_OUT -1
+#define PARTITION_ALONE -2        // Bekleyen istekler bittikten sonra on surecte islenir
+#define PARTITION_REPLY_TIMEOUT_MS 10000 // Iscinin bu sure ilerleme gostermemesi kayip sayilir
+
+typedef struct PartitionRing {
+    uint64_t head __attribute__((aligned(64))); // Tuketicinin okudugu toplam bayt
+    uint64_t tail __attribute__((aligned(64))); // Ureticinin yazdigi toplam bayt
+    pthread_mutex_t lock __attribute__((aligned(64))); // Yalnizca uyuma/uyandirma icin
+    pthread_cond_t dataReady;
+    pthread_cond_t spaceReady;
+    int consumerWaiting;
+    int producerWaiting;
+    unsigned char data[PARTITION_RING_BYTES] __attribute__((aligned(64)));
+} PartitionRing;
+
+typedef struct PartitionChannel {
+    PartitionRing requests;  // On surec -> isci
+    PartitionRing responses; // Isci -> on surec
+} PartitionChannel;
+
+// On surecte yaniti beklenen istek
+typedef struct PartitionPending {
+    int opcode;
+    int target; // Isci indeksi veya PARTITION_FAN_OUT
+    int limit;  // Son K birlestirmesinde K
+} PartitionPending;
+
+int requestedPartitions = 1;   // --partitions
+int partitionCount = 1;        // Calisan isci sayisi (1: istekler surec icinde islenir)
+PartitionChannel* partitionChannels = NULL;
+int partitionChannelCount = 0; // Eslenen kanal sayisi
+pid_t partitionPids[PARTITION_MAX];
+ByteBuffer partitionInbox[PARTITION_MAX]; // Halkadan alinmis, henuz islenmemis yanit baytlari
+size_t partitionInboxNext[PARTITION_MAX]; // Gelen kutusunda siradaki cercevenin konumu
+int nextPartition = 0; // Yeni musterinin verilecegi isci
+int partitionFailed = 0; // Bir isci oldu ya da yanit vermedi; sunucu kapaniyor
+
+int partitionOfCustomer(int customerID) {
+    return customerID > 0 ? (customerID - 1) % partitionCount : 0;
+}
+
+void initPartitionRing(PartitionRing* ring) {
+    pthread_mutexattr_t mutexAttributes;
+    pthread_condattr_t condAttributes;
+    pthread_mutexattr_init(&mutexAttributes);
+    pthread_mutexattr_setpshared(&mutexAttributes, PTHREAD_PROCESS_SHARED);
+    pthread_condattr_init(&condAttributes);
+    pthread_condattr_setpshared(&condAttributes, PTHREAD_PROCESS_SHARED);
+    pthread_condattr_setclock(&condAttributes, CLOCK_MONOTONIC);
+
+    ring->head = 0;
+    ring->tail = 0;
+    pthread_mutex_init(&ring->lock, &mutexAttributes);
+    pthread_cond_init(&ring->dataReady, &condAttributes);
+    pthread_cond_init(&ring->spaceReady, &condAttributes);
+    ring->consumerWaiting = 0;
+    ring->producerWaiting = 0;
+
+    pthread_condattr_destroy(&condAttributes);
+    pthread_mutexattr_destroy(&mutexAttributes);
+}
+
+// Karsi tarafin uyudugunu goren taraf onu uyandirir. Bekleme bayragi ile
+// konum alanlari SEQ_CST erisildigi icin iki taraftan biri digerinin
+// degisikligini mutlaka gorur.
+void wakePartitionPeer(PartitionRing* ring, int* waiting, pthread_cond_t* condition) {
+    if (__atomic_load_n(waiting, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_lock(&ring->lock);
+        pthread_cond_signal(condition);
+        pthread_mutex_unlock(&ring->lock);
+    }
+}
+
+// Halkaya sigan kadarini yazar, yazilan bayt sayisini doner (beklemez)
+size_t pushPartitionBytes(PartitionRing* ring, const unsigned char* bytes, size_t count) {
+    uint64_t tail = ring->tail;
+    size_t space = PARTITION_RING_BYTES - (size_t)(tail - __atomic_load_n(&ring->head, __ATOMIC_SEQ_CST));
+    if (count > space) count = space;
+    if (count == 0) return 0;
+
+    size_t start = (size_t)(tail % PARTITION_RING_BYTES);
+    size_t first = PARTITION_RING_BYTES - start < count ? PARTITION_RING_BYTES - start : count;
+    memcpy(ring->data + start, bytes, first);
+    memcpy(ring->data, bytes + first, count - first);
+    __atomic_store_n(&ring->tail, tail + count, __ATOMIC_SEQ_CST);
+    wakePartitionPeer(ring, &ring->consumerWaiting, &ring->dataReady);
+    return count;
+}
+
+// Halkadaki tum baytlari into'ya ekler, alinan bayt sayisini doner (beklemez)
+size_t pullPartitionBytes(PartitionRing* ring, ByteBuffer* into) {
+    uint64_t head = ring->head;
+    size_t count = (size_t)(__atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST) - head);
+    if (count == 0) return 0;
+
+    bufferReserve(into, count);
+    size_t start = (size_t)(head % PARTITION_RING_BYTES);
+    size_t first = PARTITION_RING_BYTES - start < count ? PARTITION_RING_BYTES - start : count;
+    memcpy(into->data + into->length, ring->data + start, first);
+    memcpy(into->data + into->length + first, ring->data, count - first);
+    into->length += count;
+    __atomic_store_n(&ring->head, head + count, __ATOMIC_SEQ_CST);
+    wakePartitionPeer(ring, &ring->producerWaiting, &ring->spaceReady);
+    return count;
+}
+
+int partitionRingReady(PartitionRing* ring, int wantData) {
+    uint64_t used = __atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST) - __atomic_load_n(&ring->head, __ATOMIC_SEQ_CST);
+    return wantData ? used > 0 : used < PARTITION_RING_BYTES;
+}
+
+// Isci icin peer on surectir (ebeveyn); on surec icin peer bir iscidir (cocuk)
+int partitionPeerAlive(pid_t peer) {
+    if (peer == getppid()) return 1;
+    return waitpid(peer, NULL, WNOHANG) == 0;
+}
+
+// Okunacak veri (wantData) ya da yazacak yer olana kadar bekler. Once kisa
+// bir sure yoklar, sonra kosul degiskeninde uyur. timeoutMillis < 0 ise
+// sinirsiz bekler. Hazirsa 1, sure dolduysa 0, karsi surec yoksa -1 doner.
+int waitPartitionRing(PartitionRing* ring, int wantData, pid_t peer, int timeoutMillis) {
+    for (int spin = 0; spin < PARTITION_SPIN_ROUNDS; spin++) {
+        if (partitionRingReady(ring, wantData)) return 1;
+    }
+
+    int* waiting = wantData ? &ring->consumerWaiting : &ring->producerWaiting;
+    pthread_cond_t* condition = wantData ? &ring->dataReady : &ring->spaceReady;
+    double deadline = timeoutMillis < 0 ? 0 : monotonicSeconds() + timeoutMillis / 1000.0;
+    int result = 1;
+
+    pthread_mutex_lock(&ring->lock);
+    __atomic_store_n(waiting, 1, __ATOMIC_SEQ_CST);
+    while (!partitionRingReady(ring, wantData)) {
+        // Karsi surecin olup olmadigini denetlemek icin en fazla 100 ms uyunur
+        double now = monotonicSeconds();
+        double until = now + 0.1;
+        if (timeoutMillis >= 0 && deadline < until) until = deadline;
+        if (timeoutMillis >= 0 && now >= deadline) {
+            result = 0;
+            break;
+        }
+        struct timespec wakeAt;
+        clock_gettime(CLOCK_MONOTONIC, &wakeAt);
+        long nanoseconds = wakeAt.tv_nsec + (long)((until - now) * 1e9);
+        wakeAt.tv_sec += nanoseconds / 1000000000L;
+        wakeAt.tv_nsec = nanoseconds % 1000000000L;
+        if (pthread_cond_timedwait(condition, &ring->lock, &wakeAt) == ETIMEDOUT && !partitionPeerAlive(peer)) {
+            result = -1;
+            break;
+        }
+    }
+    __atomic_store_n(waiting, 0, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&ring->lock);
+    return result;
+}
+
+// Isci kaybi: bekleyen ve gelecek tum isci yanitlari STATUS_UNAVAILABLE olur,
+// olay dongusu durur ve runServer EXIT_FAILURE doner. Isciler durdurulurken
+// kapatma cercevesi beklenmeden sonlandirilir.
+void partitionWorkerLost(int worker, const char* reason) {
+    if (!partitionFailed) {
+        fprintf(stderr, "Bolum iscisi %d %s; sunucu kapatiliyor.\n", worker, reason);
+    }
+    partitionFailed = 1;
+    serverStopRequested = 1;
+}
+
+// Yanit yerine kullanilan cerceve (uzunluk alani dahil)
+static const unsigned char partitionUnavailableFrame[5] = { 1, 0, 0, 0, STATUS_UNAVAILABLE };
+
+// On surecte iscinin yanit halkasini gelen kutusuna bosaltir
+size_t drainPartitionResponses(int worker) {
+    return pullPartitionBytes(&partitionChannels[worker].responses, &partitionInbox[worker]);
+}
+
+// Cerceveyi (uzunluk alani dahil) isciye gonderir. Istek halkasi doluyken
+// iscinin yanitlari gelen kutusuna alinir; boylece isci yanit yazarken, on
+// surec istek yazarken birbirini beklemez. Isci kayipsa 0 doner.
+int sendPartitionFrame(int worker, const unsigned char* frame, size_t length) {
+    PartitionRing* ring = &partitionChannels[worker].requests;
+    double stalledSince = monotonicSeconds();
+    while (length > 0 && !partitionFailed) {
+        size_t written = pushPartitionBytes(ring, frame, length);
+        frame += written;
+        length -= written;
+        if (written > 0) stalledSince = monotonicSeconds();
+        if (length == 0 || drainPartitionResponses(worker) > 0) continue;
+        int ready = waitPartitionRing(ring, 0, partitionPids[worker], 1);
+        if (ready < 0) {
+            partitionWorkerLost(worker, "beklenmedik sekilde sonlandi");
+        } else if (ready == 0 && monotonicSeconds() - stalledSince > PARTITION_REPLY_TIMEOUT_MS / 1000.0) {
+            partitionWorkerLost(worker, "istekleri almiyor");
+        }
+    }
+    return !partitionFailed;
+}
+
+// Iscinin siradaki yanit cercevesini bekler; reader govdeyi gosterir ve
+// bir sonraki cagriya kadar gecerlidir. Isci olduyse ya da
+// PARTITION_REPLY_TIMEOUT_MS boyunca yanit gelmediyse reader tek baytlik
+// STATUS_UNAVAILABLE yanitini gosterir ve 0 doner.
+int receivePartitionFrame(int worker, ByteReader* reader) {
+    ByteBuffer* inbox = &partitionInbox[worker];
+    size_t read = partitionInboxNext[worker];
+    if (read == inbox->length) {
+        inbox->length = 0;
+        read = 0;
+    } else if (read > 65536 && read > inbox->length / 2) {
+        memmove(inbox->data, inbox->data + read, inbox->length - read);
+        inbox->length -= read;
+        read = 0;
+    }
+
+    while (!partitionFailed &&
+           (inbox->length - read < 4 || inbox->length - read - 4 < decodeU32(inbox->data + read))) {
+        if (drainPartitionResponses(worker) > 0) continue;
+        int ready = waitPartitionRing(&partitionChannels[worker].responses, 1, partitionPids[worker],
+                                      PARTITION_REPLY_TIMEOUT_MS);
+        if (ready < 0) {
+            partitionWorkerLost(worker, "beklenmedik sekilde sonlandi");
+        } else if (ready == 0) {
+            partitionWorkerLost(worker, "yanit vermedi");
+        }
+    }
+
+    reader->offset = 0;
+    reader->failed = 0;
+    partitionInboxNext[worker] = read;
+    if (partitionFailed) {
+        reader->data = partitionUnavailableFrame + 4;
+        reader->length = 1;
+        return 0;
+    }
+    uint32_t length = decodeU32(inbox->data + read);
+    reader->data = inbox->data + read + 4;
+    reader->length = length;
+    partitionInboxNext[worker] = read + 4 + length;
+    return 1;
+}
+
+// Isci dongusu: istekleri handleServerRequest ile isler. Sifir uzunluklu
+// cerceve kapatma istegidir.
+void runPartitionWorker(int index) {
+    PartitionChannel* channel = &partitionChannels[index];
+    pid_t front = getppid();
+    ByteBuffer input = { NULL, 0, 0 };
+    ByteBuffer output = { NULL, 0, 0 };
+    size_t consumed = 0;
+
+    while (1) {
+        while (input.length - consumed < 4 || input.length - consumed - 4 < decodeU32(input.data + consumed)) {
+            if (pullPartitionBytes(&channel->requests, &input) == 0 &&
+                waitPartitionRing(&channel->requests, 1, front, -1) < 0) {
+                goto done; // On surec yok
+            }
+        }
+        uint32_t frameLength = decodeU32(input.data + consumed);
+        if (frameLength == 0) {
+            break;
+        }
+
+        output.length = 0;
+        bufferAppendInt32(&output, 0);
+        ByteReader request = { input.data + consumed + 4, frameLength, 0, 0 };
+        handleServerRequest(&request, &output);
+        patchFrameLength(&output, 0);
+        enforceMemoryCeiling();
+
+        consumed += 4 + frameLength;
+        if (consumed == input.length) {
+            input.length = 0;
+            consumed = 0;
+        }
+
+        const unsigned char* bytes = output.data;
+        size_t remaining = output.length;
+        while (remaining > 0) {
+            size_t written = pushPartitionBytes(&channel->responses, bytes, remaining);
+            bytes += written;
+            remaining -= written;
+            if (remaining > 0 && waitPartitionRing(&channel->responses, 0, front, -1) < 0) goto done;
+        }
+    }
+done:
+    bufferFree(&input);
+    bufferFree(&output);
+}
+
+// count isci sureci baslatir; basarisizsa 0 doner
+int startPartitionWorkers(int count) {
+    if (count < 2 || count > PARTITION_MAX) {
+        printError("Bolum sayisi 2 ile 64 arasinda olmalidir.");
+        return 0;
+    }
+    partitionChannels = (PartitionChannel*)mmap(NULL, count * sizeof(PartitionChannel), PROT_READ | PROT_WRITE,
+                                                MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (partitionChannels == MAP_FAILED) {
+        partitionChannels = NULL;
+        perror("mmap");
+        return 0;
+    }
+    partitionChannelCount = count;
+    for (int i = 0; i < count; i++) {
+        initPartitionRing(&partitionChannels[i].requests);
+        initPartitionRing(&partitionChannels[i].responses);
+        partitionInbox[i].length = 0;
+        partitionInboxNext[i] = 0;
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    pid_t front = getpid();
+    for (int i = 0; i < count; i++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            partitionCount = i;
+            stopPartitionWorkers();
+            return 0;
+        }
+        if (pid == 0) {
+            // On surec olurse isci de sonlanir; Ctrl-C'yi on surec yonetir
+            prctl(PR_SET_PDEATHSIG, SIGTERM);
+            if (getppid() != front) _exit(1);
+            signal(SIGINT, SIG_IGN);
+            signal(SIGTERM, SIG_DFL);
+            quietMode = 1;
+            idStride = count;
+            partitionIndex = i;
+            autoCustomerID = i + 1;
+            autoShipmentID = i + 1;
+            if (spillPath != NULL) {
+                static char workerSpillPath[4096];
+                snprintf(workerSpillPath, sizeof(workerSpillPath), "%s.%d", spillPath, i);
+                spillPath = workerSpillPath;
+            }
+            runPartitionWorker(i);
+            cleanup();
+            _exit(0);
+        }
+        partitionPids[i] = pid;
+    }
+    partitionCount = count;
+    nextPartition = 0;
+    return 1;
+}
+
+void stopPartitionWorkers() {
+    static const unsigned char shutdownFrame[4] = { 0, 0, 0, 0 };
+    for (int i = 0; i < partitionCount; i++) {
+        if (partitionPeerAlive(partitionPids[i])) {
+            // Kayiptan sonra halkalardaki yarim cercevelere guvenilmez
+            if (partitionFailed || !sendPartitionFrame(i, shutdownFrame, sizeof(shutdownFrame))) {
+                kill(partitionPids[i], SIGKILL);
+            }
+            waitpid(partitionPids[i], NULL, 0);
+        }
+        bufferFree(&partitionInbox[i]);
+    }
+    if (partitionChannels != NULL) {
+        munmap(partitionChannels, (size_t)partitionChannelCount * sizeof(PartitionChannel));
+    }
+    partitionChannels = NULL;
+    partitionChannelCount = 0;
+    partitionCount = 1;
+}
+
+// Istegin hangi isciye gidecegini belirler
+int planPartitionRequest(const unsigned char* body, size_t length, PartitionPending* entry) {
+    entry->opcode = body[0];
+    entry->limit = 0;
+    int customerID = length >= 5 ? (int32_t)decodeU32(body + 1) : 0;
+
+    switch (entry->opcode) {
+        case OP_ADD_CUSTOMER:
+            entry->target = nextPartition;
+            nextPartition = (nextPartition + 1) % partitionCount;
+            break;
+        case OP_ADD_SHIPMENT:
+        case OP_GET_SHIPMENTS:
+        case OP_SEARCH_DELIVERED:
+        case OP_COUNT_SHIPMENTS:
+        case OP_UPDATE_STATUS:
+            entry->target = partitionOfCustomer(customerID);
+            break;
+        case OP_EXPORT:
+            entry->target = customerID > 0 ? partitionOfCustomer(customerID) : PARTITION_ALONE;
+            break;
+        case OP_LAST_FIVE:
+            entry->target = PARTITION_FAN_OUT;
+            entry->limit = 5;
+            break;
+        case OP_LAST_SHIPMENTS:
+            entry->target = PARTITION_FAN_OUT;
+            entry->limit = customerID; // Ilk i32 alan k'dir
+            break;
+        case OP_FLEET_TOTALS:
+            entry->target = PARTITION_FAN_OUT;
+            break;
+        case OP_FIND_BY_NAME:
+        case OP_DAILY_ROLLUP:
+            entry->target = PARTITION_ALONE;
+            break;
+        default:
+            entry->target = 0; // Kuyruk, stack, sehirler ve bilinmeyen istekler
+            break;
+    }
+    return entry->target;
+}
+
+// Ilk basarisiz durumu cevaba yazar; tum iscilerin yanitlari okunmus olmalidir
+int appendFirstFailure(const int* statuses, ByteBuffer* out) {
+    for (int i = 0; i < partitionCount; i++) {
+        if (statuses[i] != STATUS_OK) {
+            bufferAppendU8(out, (unsigned int)statuses[i]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void readShipmentRecord(ByteReader* reader, Shipment* out) {
+    out->shipmentID = readInt32(reader);
+    readString(reader, out->date, sizeof(out->date));
+    readString(reader, out->status, sizeof(out->status));
+    out->deliveryTime = readInt32(reader);
+    out->next = NULL;
+}
+
+// Dagitilmis istegin yanitlarini birlestirip out'a yazar
+void mergePartitionResponses(const PartitionPending* entry, ByteBuffer* out) {
+    int statuses[PARTITION_MAX];
+    ByteReader reader;
+
+    if (entry->opcode == OP_FLEET_TOTALS) {
+        typedef struct StatusTotal {
+            char status[20];
+            int count;
+        } StatusTotal;
+        int customers = 0, shipments = 0, statusCount = 0;
+        StatusTotal* merged = NULL;
+        for (int i = 0; i < partitionCount; i++) {
+            receivePartitionFrame(i, &reader);
+            statuses[i] = reader.length > 0 ? reader.data[reader.offset++] : STATUS_BAD_REQUEST;
+            if (statuses[i] != STATUS_OK) continue;
+            customers += readInt32(&reader);
+            shipments += readInt32(&reader);
+            int count = readInt32(&reader);
+            for (int j = 0; j < count && !reader.failed; j++) {
+                char status[20];
+                readString(&reader, status, sizeof(status));
+                int statusTotal = readInt32(&reader);
+                int k = 0;
+                while (k < statusCount && strcmp(merged[k].status, status) != 0) k++;
+                if (k == statusCount) {
+                    merged = (StatusTotal*)safeRealloc(merged, (statusCount + 1) * sizeof(StatusTotal));
+                    strcpy(merged[statusCount].status, status);
+                    merged[statusCount++].count = 0;
+                }
+                merged[k].count += statusTotal;
+            }
+        }
+        if (!appendFirstFailure(statuses, out)) {
+            // Iscilerin listeleri ada gore sirali geldigi icin burada da siralanir
+            for (int i = 1; i < statusCount; i++) {
+                StatusTotal item = merged[i];
+                int j = i;
+                for (; j > 0 && strcmp(merged[j - 1].status, item.status) > 0; j--) merged[j] = merged[j - 1];
+                merged[j] = item;
+            }
+            bufferAppendU8(out, STATUS_OK);
+            bufferAppendInt32(out, customers);
+            bufferAppendInt32(out, shipments);
+            bufferAppendInt32(out, statusCount);
+            for (int i = 0; i < statusCount; i++) {
+                bufferAppendString(out, merged[i].status);
+                bufferAppendInt32(out, merged[i].count);
+            }
+        }
+        free(merged);
+        return;
+    }
+
+    // Son K: her iscinin en yeni K kaydi toplanip (tarih, ID) sirasina dizilir
+    Shipment* all = (Shipment*)safeMalloc((size_t)partitionCount * SERVER_MAX_LAST_SHIPMENTS * sizeof(Shipment));
+    Shipment* list = NULL;
+    int total = 0;
+    for (int i = 0; i < partitionCount; i++) {
+        receivePartitionFrame(i, &reader);
+        statuses[i] = reader.length > 0 ? reader.data[reader.offset++] : STATUS_BAD_REQUEST;
+        if (statuses[i] != STATUS_OK) continue;
+        int count = readInt32(&reader);
+        for (int j = 0; j < count && j < SERVER_MAX_LAST_SHIPMENTS && !reader.failed; j++) {
+            readShipmentRecord(&reader, &all[total]);
+            all[total].next = list;
+            list = &all[total++];
+        }
+    }
+    if (!appendFirstFailure(statuses, out)) {
+        shipmentsByDateIDDescendingSort(&list);
+        int count = total < entry->limit ? total : entry->limit;
+        bufferAppendU8(out, STATUS_OK);
+        bufferAppendInt32(out, count);
+        for (int i = 0; i < count; i++, list = list->next) {
+            appendShipmentRecord(out, list->shipmentID, list->date, list->status, list->deliveryTime);
+        }
+    }
+    free(all);
+}
+
+// Bekleyen isteklerin yanitlarini istek sirasiyla out'a yazar
+void completePartitionRequests(PartitionPending* pending, int count, ByteBuffer* out) {
+    ByteReader reader;
+    for (int i = 0; i < count; i++) {
+        size_t lengthSlot = out->length;
+        if (pending[i].target == PARTITION_FAN_OUT) {
+            bufferAppendInt32(out, 0);
+            mergePartitionResponses(&pending[i], out);
+            patchFrameLength(out, lengthSlot);
+        } else {
+            receivePartitionFrame(pending[i].target, &reader);
+            bufferAppend(out, reader.data - 4, reader.length + 4); // Cerceve aynen aktarilir
+        }
+    }
+}
+
+// Isim aramasinda bir iscinin sonuc akisi
+typedef struct NameStream {
+    ByteBuffer page;   // Isciden gelen sayfanin kayitlari (i32 ID, str ad, str soyad)
+    size_t offset;     // Siradaki kaydin sayfadaki konumu
+    int remaining;     // Sayfada okunmamis kayit
+    int fetched;       // Isciden alinan toplam kayit
+    int total;         // Iscideki toplam eslesme
+    int headID;        // Siradaki kayit (remaining > 0 iken gecerli)
+    char headFirst[50];
+    char headLast[50];
+    size_t headEnd;
+} NameStream;
+
+void loadNameHead(NameStream* stream) {
+    if (stream->remaining == 0) return;
+    ByteReader reader = { stream->page.data, stream->page.length, stream->offset, 0 };
+    stream->headID = readInt32(&reader);
+    readString(&reader, stream->headFirst, sizeof(stream->headFirst));
+    readString(&reader, stream->headLast, sizeof(stream->headLast));
+    stream->headEnd = reader.offset;
+    if (reader.failed) stream->remaining = 0;
+}
+
+int compareNameHeads(const NameStream* a, const NameStream* b) {
+    int result = strcmp(a->headLast, b->headLast);
+    if (result == 0) result = strcmp(a->headFirst, b->headFirst);
+    if (result == 0) result = (a->headID > b->headID) - (a->headID < b->headID);
+    return result;
+}
+
+// Isim aramasi: iscilerden (soyad, ad, ID) sirali 64'luk sayfalar cekilip
+// k yollu birlestirilir; baslangica kadar olan kayitlar atlanir
+void findPartitionedCustomers(ByteReader* request, ByteBuffer* out) {
+    char lastName[50];
+    readString(request, lastName, sizeof(lastName));
+    int prefix = 0;
+    if (!request->failed && request->offset < request->length) {
+        prefix = request->data[request->offset++];
+    } else {
+        request->failed = 1;
+    }
+    int offset = readInt32(request);
+    int limit = readInt32(request);
+    if (request->failed) {
+        bufferAppendU8(out, STATUS_BAD_REQUEST);
+        return;
+    }
+    if (offset < 0 || limit <= 0 || limit > 64) {
+        bufferAppendU8(out, STATUS_INVALID);
+        return;
+    }
+
+    NameStream streams[PARTITION_MAX];
+    ByteBuffer frame = { NULL, 0, 0 };
+    ByteReader reader;
+    size_t start = out->length; // Sonraki turlarda hata olursa yazilan kayitlar geri alinir
+    size_t countSlot = 0;
+    int count = 0;
+    int failure = STATUS_OK;
+    memset(streams, 0, sizeof(NameStream) * partitionCount);
+
+    for (int round = 0;; round++) {
+        int asked[PARTITION_MAX];
+        for (int i = 0; i < partitionCount; i++) {
+            NameStream* stream = &streams[i];
+            asked[i] = stream->remaining == 0 && (round == 0 || stream->fetched < stream->total);
+            if (!asked[i]) continue;
+            frame.length = 0;
+            bufferAppendInt32(&frame, 0);
+            bufferAppendU8(&frame, OP_FIND_BY_NAME);
+            bufferAppendString(&frame, lastName);
+            bufferAppendU8(&frame, (unsigned int)prefix);
+            bufferAppendInt32(&frame, stream->fetched);
+            bufferAppendInt32(&frame, 64);
+            patchFrameLength(&frame, 0);
+            sendPartitionFrame(i, frame.data, frame.length);
+        }
+        for (int i = 0; i < partitionCount; i++) {
+            if (!asked[i]) continue;
+            NameStream* stream = &streams[i];
+            receivePartitionFrame(i, &reader);
+            if (reader.length == 0 || reader.data[0] != STATUS_OK) {
+                if (failure == STATUS_OK) failure = reader.length > 0 ? reader.data[0] : STATUS_BAD_REQUEST;
+                continue;
+            }
+            reader.offset = 1;
+            stream->total = readInt32(&reader);
+            stream->remaining = readInt32(&reader);
+            if (reader.failed || stream->remaining <= 0) {
+                stream->remaining = 0;
+                stream->total = stream->fetched; // Bos sayfa: akis bitti
+                continue;
+            }
+            stream->fetched += stream->remaining;
+            stream->page.length = 0;
+            bufferAppend(&stream->page, reader.data + reader.offset, reader.length - reader.offset);
+            stream->offset = 0;
+            loadNameHead(stream);
+        }
+        if (failure != STATUS_OK) {
+            out->length = start;
+            bufferAppendU8(out, (unsigned int)failure);
+            break;
+        }
+        if (round == 0) {
+            int total = 0;
+            for (int i = 0; i < partitionCount; i++) total += streams[i].total;
+            bufferAppendU8(out, STATUS_OK);
+            bufferAppendInt32(out, total);
+            countSlot = out->length;
+            bufferAppendInt32(out, 0); // Adet sonda doldurulur
+        }
+
+        // Sayfasi bitmis ama devami olan bir akis varsa once o doldurulur
+        int refill = 0;
+        while (count < limit && !refill) {
+            NameStream* best = NULL;
+            for (int i = 0; i < partitionCount && !refill; i++) {
+                NameStream* stream = &streams[i];
+                if (stream->remaining == 0) {
+                    refill = stream->fetched < stream->total;
+                } else if (best == NULL || compareNameHeads(stream, best) < 0) {
+                    best = stream;
+                }
+            }
+            if (refill || best == NULL) break;
+
+            if (offset > 0) {
+                offset--;
+            } else {
+                bufferAppend(out, best->page.data + best->offset, best->headEnd - best->offset);
+                count++;
+            }
+            best->offset = best->headEnd;
+            best->remaining--;
+            loadNameHead(best);
+        }
+        if (!refill) {
+            unsigned char* slot = out->data + countSlot;
+            slot[0] = count & 0xFF;
+            slot[1] = (count >> 8) & 0xFF;
+            slot[2] = (count >> 16) & 0xFF;
+            slot[3] = (count >> 24) & 0xFF;
+            break;
+        }
+    }
+
+    for (int i = 0; i < partitionCount; i++) bufferFree(&streams[i].page);
+    bufferFree(&frame);
+}
+
+// Tum filonun disa aktarimi: bolumler sirayla gezilir. Anahtardaki musteri
+// ID'si bolumu belirler; bir bolum bitince anahtar sonraki bolumun ilk
+// musterisine ("<ID>::0") gecer.
+void exportPartitionedShipments(ByteReader* request, ByteBuffer* out) {
+    char token[48];
+    readInt32(request);
+    readString(request, token, sizeof(token));
+    int format = 0;
+    if (!request->failed && request->offset < request->length) {
+        format = request->data[request->offset++];
+    } else {
+        request->failed = 1;
+    }
+    int limit = readInt32(request);
+    if (request->failed) {
+        bufferAppendU8(out, STATUS_BAD_REQUEST);
+        return;
+    }
+    int tokenCustomer = token[0] == '\0' ? 1 : atoi(token);
+    if (tokenCustomer <= 0) {
+        bufferAppendU8(out, STATUS_INVALID);
+        return;
+    }
+
+    ByteBuffer frame = { NULL, 0, 0 };
+    ByteBuffer text = { NULL, 0, 0 };
+    ByteReader reader;
+    int partition = partitionOfCustomer(tokenCustomer);
+    int count = 0;
+
+    while (1) {
+        frame.length = 0;
+        bufferAppendInt32(&frame, 0);
+        bufferAppendU8(&frame, OP_EXPORT);
+        bufferAppendInt32(&frame, 0);
+        bufferAppendString(&frame, token);
+        bufferAppendU8(&frame, (unsigned int)format);
+        bufferAppendInt32(&frame, limit - count);
+        patchFrameLength(&frame, 0);
+        sendPartitionFrame(partition, frame.data, frame.length);
+        receivePartitionFrame(partition, &reader);
+        if (reader.length == 0 || reader.data[0] != STATUS_OK) {
+            // Ilk sayfadaki hata (gecersiz anahtar, limit) aynen iletilir
+            bufferAppend(out, reader.data, reader.length);
+            goto done;
+        }
+
+        reader.offset = 1;
+        count += readInt32(&reader);
+        readString(&reader, token, sizeof(token));
+        int textLength = readInt32(&reader);
+        if (reader.failed || textLength < 0 || reader.length - reader.offset < (size_t)textLength) {
+            bufferAppendU8(out, STATUS_BAD_REQUEST);
+            goto done;
+        }
+        bufferAppend(&text, reader.data + reader.offset, (size_t)textLength);
+
+        if (token[0] == '\0' && partition + 1 < partitionCount) {
+            partition++;
+            snprintf(token, sizeof(token), "%d::0", partition + 1);
+        }
+        if (token[0] == '\0' || count >= limit) break;
+    }
+
+    bufferAppendU8(out, STATUS_OK);
+    bufferAppendInt32(out, count);
+    bufferAppendString(out, token);
+    bufferAppendInt32(out, (int32_t)text.length);
+    bufferAppend(out, text.data, text.length);
+done:
+    bufferFree(&frame);
+    bufferFree(&text);
+}
+
+// Gunluk ozet: her isci kendi son gunune kadar olan histogramlarini gonderir,
+// on surec bunlari en yeni gune gore hizalayip toplar. Log-dogrusal kovalar
+// toplanabildiginden sonuc tek surecli modla aynidir.
+void dailyRollupPartitioned(ByteReader* request, ByteBuffer* out) {
+    int dayCount = readInt32(request);
+    if (request->failed) {
+        bufferAppendU8(out, STATUS_BAD_REQUEST);
+        return;
+    }
+    if (dayCount <= 0 || dayCount > ROLLUP_MAX_QUERY_DAYS) {
+        bufferAppendU8(out, STATUS_INVALID);
+        return;
+    }
+
+    // Pencere burada sabitlenir; bolumler gece yarisinda farkli gun gormez
+    int endDay = currentDay();
+    ByteBuffer frame = { NULL, 0, 0 };
+    bufferAppendInt32(&frame, 0);
+    bufferAppendU8(&frame, OP_ROLLUP_HISTOGRAMS);
+    bufferAppendInt32(&frame, dayCount);
+    bufferAppendInt32(&frame, endDay);
+    patchFrameLength(&frame, 0);
+    for (int i = 0; i < partitionCount; i++) sendPartitionFrame(i, frame.data, frame.length);
+    bufferFree(&frame);
+
+    // Tum bolumler ayni pencereyi dondugu icin yanitlar geldikce birlestirilir
+    DeliveryRollup* days = (DeliveryRollup*)safeMalloc(dayCount * sizeof(DeliveryRollup));
+    memset(days, 0, dayCount * sizeof(DeliveryRollup));
+    int status = STATUS_EMPTY;
+    ByteReader reader;
+    for (int i = 0; i < partitionCount; i++) {
+        receivePartitionFrame(i, &reader);
+        int workerStatus = reader.length > 0 ? reader.data[0] : STATUS_BAD_REQUEST;
+        if (workerStatus == STATUS_EMPTY) continue;
+        if (workerStatus != STATUS_OK) {
+            if (status == STATUS_OK || status == STATUS_EMPTY) status = workerStatus;
+            continue;
+        }
+        if (status == STATUS_EMPTY) status = STATUS_OK;
+        if (status != STATUS_OK) continue;
+
+        ByteReader body = { reader.data + 1, reader.length - 1, 0, 0 };
+        readInt32(&body);
+        int nonEmpty = readInt32(&body);
+        for (int d = 0; d < nonEmpty && !body.failed; d++) {
+            int day = readInt32(&body);
+            DeliveryRollup part;
+            part.count = (uint32_t)readInt32(&body);
+            uint32_t low = (uint32_t)readInt32(&body);
+            uint32_t high = (uint32_t)readInt32(&body);
+            part.sum = (int64_t)(((uint64_t)high << 32) | low);
+            part.min = readInt32(&body);
+            part.max = readInt32(&body);
+            int used = readInt32(&body);
+            int index = day - (endDay - dayCount + 1);
+            DeliveryRollup* target = index >= 0 && index < dayCount ? &days[index] : NULL;
+            for (int b = 0; b < used && !body.failed; b++) {
+                int bucket = readInt32(&body);
+                int bucketCount = readInt32(&body);
+                if (target != NULL && bucket >= 0 && bucket < ROLLUP_BUCKETS) target->buckets[bucket] += (uint32_t)bucketCount;
+            }
+            if (target == NULL || part.count == 0) continue;
+            if (target->count == 0 || part.min < target->min) target->min = part.min;
+            if (target->count == 0 || part.max > target->max) target->max = part.max;
+            target->count += part.count;
+            target->sum += part.sum;
+        }
+        if (body.failed) status = STATUS_BAD_REQUEST;
+    }
+
+    if (status == STATUS_OK) {
+        appendDailyRollups(out, endDay, dayCount, days);
+    } else {
+        bufferAppendU8(out, (unsigned int)status);
+    }
+    free(days);
+}
+
+// Sirayla islenmesi gereken istegi on surecte yanitlar
+void handlePartitionedAlone(const unsigned char* body, size_t length, ByteBuffer* out) {
+    ByteReader request = { body, length, 1, 0 };
+    switch (body[0]) {
+        case OP_FIND_BY_NAME:
+            findPartitionedCustomers(&request, out);
+            return;
+        case OP_EXPORT:
+            exportPartitionedShipments(&request, out);
+            return;
+        case OP_DAILY_ROLLUP:
+            dailyRollupPartitioned(&request, out);
+            return;
+        default:
+            bufferAppendU8(out, STATUS_INVALID);
+            return;
+    }
+}
+
+// processClientFrames'in bolumlu hali: istemcinin cercevelerini iscilere
+// dagitir, yanitlari istek sirasiyla cikisa yazar; protokol hatasinda 0 doner
+int routeClientFrames(ClientConnection* client) {
+    static PartitionPending pending[PARTITION_PIPELINE];
+    int pendingCount = 0;
+    size_t offset = 0;
+    int valid = 1;
+
+    while (client->input.length - offset >= 4 && !clientOutputFull(client)) {
+        uint32_t frameLength = decodeU32(client->input.data + offset);
+        if (frameLength == 0 || frameLength > SERVER_MAX_FRAME) {
+            valid = 0;
+            break;
+        }
+        if (client->input.length - offset - 4 < frameLength) {
+            break; // Cercevenin geri kalani henuz gelmedi
+        }
+
+        const unsigned char* frame = client->input.data + offset;
+        PartitionPending entry;
+        int target = planPartitionRequest(frame + 4, frameLength, &entry);
+        if (target == PARTITION_ALONE || pendingCount == PARTITION_PIPELINE) {
+            completePartitionRequests(pending, pendingCount, &client->output);
+            pendingCount = 0;
+        }
+
+        if (target == PARTITION_ALONE) {
+            size_t lengthSlot = client->output.length;
+            bufferAppendInt32(&client->output, 0);
+            handlePartitionedAlone(frame + 4, frameLength, &client->output);
+            patchFrameLength(&client->output, lengthSlot);
+        } else if (target == PARTITION_FAN_OUT) {
+            for (int i = 0; i < partitionCount; i++) sendPartitionFrame(i, frame, 4 + frameLength);
+            pending[pendingCount++] = entry;
+        } else {
+            sendPartitionFrame(target, frame, 4 + frameLength);
+            pending[pendingCount++] = entry;
+        }
+        offset += 4 + frameLength;
+    }
+    completePartitionRequests(pending, pendingCount, &client->output);
+
+    // Islenen cerceveleri tampondan at
+    if (offset > 0) {
+        memmove(client->input.data, client->input.data + offset, client->input.length - offset);
+        client->input.length -= offset;
+    }
+    return valid;
+}
+
+// Girdi tamponundaki tum tam cerceveleri isler; protokol hatasinda 0 doner
+int processClientFrames(ClientConnection* client) {
+    size_t offset = 0;
+
+    if (partitionCount > 1) {
+        return routeClientFrames(client);
+    }
+
+    while (client->input.length - offset >= 4 && !clientOutputFull(client)) {
+        uint32_t frameLength = decodeU32(client->input.data + offset);
+        if (frameLength == 0 || frameLength > SERVER_MAX_FRAME) {
+            return 0;
+        }
+        if (client->input.length - offset - 4 < frameLength) {
+            break; // Cercevenin geri kalani henuz gelmedi
+        }
+
+        // Yanit uzunlugunu sonradan doldurmak icin yer ayir
+        size_t lengthSlot = client->output.length;
+        bufferAppendInt32(&client->output, 0);
+
+        ByteReader request = { client->input.data + offset + 4, frameLength, 0, 0 };
+        handleServerRequest(&request, &client->output);
+        patchFrameLength(&client->output, lengthSlot);
+        enforceMemoryCeiling();
+
+        offset += 4 + frameLength;
+    }
+
+    // Islenen cerceveleri tampondan at
+    if (offset > 0) {
+        memmove(client->input.data, client->input.data + offset, client->input.length - offset);
+        client->input.length -= offset;
+    }
+    return 1;
+}
+
+// Bekleyen yanitlari gonderir; baglanti kapanmissa 0 doner
+int flushClientOutput(ClientConnection* client) {
+    while (client->outputSent < client->output.length) {
+        ssize_t written = write(client->fd, client->output.data + client->outputSent,
+                                client->output.length - client->outputSent);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 1;
+            return 0;
+        }
+        client->outputSent += (size_t)written;
+    }
+    client->output.length = 0;
+    client->outputSent = 0;
+    return 1;
+}
+
+void closeClient(int epollFd, ClientConnection* client) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, client->fd, NULL);
+    close(client->fd);
+    bufferFree(&client->input);
+    bufferFree(&client->output);
+    free(client);
+}
+
+// Olay maskesini baglantinin durumuna gore gunceller: cikis doluyken ya da
+// istemci yazmayi bitirdiyse EPOLLIN, bekleyen yanit varsa EPOLLOUT istenir
+void updateClientEvents(int epollFd, ClientConnection* client) {
+    uint32_t events = 0;
+    if (!client->readClosed && !clientOutputFull(client)) events |= EPOLLIN;
+    if (client->outputSent < client->output.length) events |= EPOLLOUT;
+    if (events == client->events) {
+        return;
+    }
+    struct epoll_event event;
+    event.events = events;
+    event.data.ptr = client;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, client->fd, &event);
+    client->events = events;
+}
+
+// Girdinin son cerceveleri islenip yanitlar gonderildiyse baglanti biter
+int clientFinished(const ClientConnection* client) {
+    return client->readClosed && client->output.length == 0;
+}
+
+// Istemciden gelen veriyi okur ve isler; baglanti kapatilmalidir ise 0 doner
+int serviceClientRead(ClientConnection* client) {
+    while (!client->readClosed && !clientOutputFull(client)) {
+        bufferReserve(&client->input, SERVER_READ_CHUNK);
+        ssize_t received = read(client->fd, client->input.data + client->input.length, SERVER_READ_CHUNK);
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return 0;
+        }
+        if (received == 0) {
+            client->readClosed = 1; // Okunmus istekler yine de yanitlanir
+            break;
+        }
+        client->input.length += (size_t)received;
+        if (!processClientFrames(client)) {
+            return 0;
+        }
+    }
+    // Istemci yazmayi bitirdiyse sinir kalkar; tamponda kalan cerceveler islenir
+    if (!processClientFrames(client) || !flushClientOutput(client)) {
+        return 0;
+    }
+    return !clientFinished(client);
+}
+
+// Bekleyen yanitlari gonderir; tampon sinirin altina indiyse okuma
+// durdugunda islenmeden kalan cerceveleri de isler
+int serviceClientWrite(ClientConnection* client) {
+    if (!flushClientOutput(client)) {
+        return 0;
+    }
+    if (clientOutputFull(client)) {
+        return 1;
+    }
+    if (!processClientFrames(client) || !flushClientOutput(client)) {
+        return 0;
+    }
+    return !clientFinished(client);
+}
+
+void acceptClients(int epollFd, int listenFd) {
+    while (1) {
+        int fd = accept4(listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return; // EAGAIN veya gecici hata
+        }
+
+        ClientConnection* client = (ClientConnection*)safeMalloc(sizeof(ClientConnection));
+        memset(client, 0, sizeof(ClientConnection));
+        client->fd = fd;
+        client->events = EPOLLIN;
+
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = client;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            close(fd);
+            free(client);
+        }
+    }
+}
+
+void handleServerSignal(int signalNumber) {
+    (void)signalNumber;
+    serverStopRequested = 1;
+}
+
+int runServer(const char* socketPath) {
+    struct sockaddr_un address;
+    if (strlen(socketPath) >= sizeof(address.sun_path)) {
+        printError("Soket yolu cok uzun.");
+        return 1;
+    }
+    // Isciler soket ve sinyal ayarlarindan once baslatilir, bunlari devralmazlar
+    if (requestedPartitions > 1 && !startPartitionWorkers(requestedPartitions)) {
+        return 1;
+    }
+
+    int listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        perror("socket");
+        stopPartitionWorkers();
+        return 1;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socketPath);
+    unlink(socketPath);
+
+    if (bind(listenFd, (struct sockaddr*)&address, sizeof(address)) < 0 || listen(listenFd, SOMAXCONN) < 0) {
+        perror("bind/listen");
+        close(listenFd);
+        stopPartitionWorkers();
+        return 1;
+    }
+
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event listenEvent;
+    listenEvent.events = EPOLLIN;
+    listenEvent.data.ptr = NULL; // NULL: dinleyen soket
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &listenEvent);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handleServerSignal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    if (partitionCount > 1) {
+        printf("Sunucu %s uzerinde %d bolumle dinliyor.\n", socketPath, partitionCount);
+    } else {
+        printf("Sunucu %s uzerinde dinliyor.\n", socketPath);
+    }
+    fflush(stdout);
+    quietMode = 1;
+
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    while (!serverStopRequested) {
+        int ready = epoll_wait(epollFd, events, SERVER_MAX_EVENTS, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            break;
+        }
+
+        for (int i = 0; i < ready; i++) {
+            ClientConnection* client = (ClientConnection*)events[i].data.ptr;
+            if (client == NULL) {
+                acceptClients(epollFd, listenFd);
+                continue;
+            }
+
+            // EPOLLHUP'ta once okunabilecek girdi okunur ve islenir; karsi taraf
+            // yanitlari alamayacagindan baglanti bundan sonra kapatilir
+            int alive = !(events[i].events & EPOLLERR);
+            if (alive && (events[i].events & EPOLLHUP)) {
+                client->hungUp = 1;
+            }
+            if (alive && (events[i].events & EPOLLOUT)) {
+                alive = serviceClientWrite(client);
+            }
+            if (alive && (events[i].events & (EPOLLIN | EPOLLHUP))) {
+                alive = serviceClientRead(client);
+            }
+            if (client->hungUp) {
+                alive = 0;
+            }
+
+            if (alive) {
+                updateClientEvents(epollFd, client);
+            } else {
+                closeClient(epollFd, client);
+            }
+        }
+    }
+
+    quietMode = 0;
+    close(epollFd);
+    close(listenFd);
+    unlink(socketPath);
+    int failed = partitionFailed;
+    stopPartitionWorkers();
+    if (failed) {
+        printf("Sunucu bolum iscisi kaybi nedeniyle kapatildi.\n");
+        return EXIT_FAILURE;
+    }
+    printf("Sunucu kapatildi.\n");
+    return 0;
+}
+
+// Performans Olcumleri
+
+// Surecin bellekte tuttugu bayt miktari (/proc/self/statm)
+long residentBytes() {
+    long pages = 0, resident = 0;
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (file == NULL) return 0;
+    if (fscanf(file, "%ld %ld", &pages, &resident) != 2) resident = 0;
+    fclose(file);
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+// Sentetik isimlerle musteri ekler ve bellek raporunu yazdirir
+void runCustomerBenchmark(long customerCount) {
+    static const char* firstNames[] = {
+        "Ali", "Ayse", "Mehmet", "Fatma", "Mustafa", "Emine", "Ahmet", "Hatice",
+        "Huseyin", "Zeynep", "Hasan", "Elif", "Ibrahim", "Meryem", "Ismail", "Sultan",
+        "Osman", "Hacer", "Yusuf", "Merve", "Murat", "Esra", "Omer", "Zehra",
+        "Ramazan", "Hanife", "Halil", "Havva", "Suleyman", "Kubra", "Abdullah", "Rabia"
+    };
+    static const char* lastNames[] = {
+        "Yilmaz", "Kaya", "Demir", "Sahin", "Celik", "Yildiz", "Yildirim", "Ozturk",
+        "Aydin", "Ozdemir", "Arslan", "Dogan", "Kilic", "Aslan", "Cetin", "Kara",
+        "Koc", "Kurt", "Ozkan", "Simsek", "Polat", "Ozcan", "Korkmaz", "Cakir"
+    };
+    int firstCount = sizeof(firstNames) / sizeof(firstNames[0]);
+    int lastCount = sizeof(lastNames) / sizeof(lastNames[0]);
+    char lastName[50];
+
+    long before = residentBytes();
+    quietMode = 1;
+    for (long i = 0; i < customerCount; i++) {
+        // Soyadlarina ek vererek ~100 bin farkli soyad uret
+        snprintf(lastName, sizeof(lastName), "%s%ld", lastNames[i % lastCount], (i / lastCount) % 4096);
+        addCustomer((char*)firstNames[(i * 7) % firstCount], lastName);
+    }
+    quietMode = 0;
+    long after = residentBytes();
+
+    printCustomerMemoryReport();
+    printf("Olculen RSS artisi: %.1f MB (%.1f bayt/musteri)\n",
+           (after - before) / 1048576.0, customerCount ? (double)(after - before) / customerCount : 0.0);
+}
+
+// Her musteriye yillara yayilmis teslim edilmis gonderiler ekler,
+// eskilerini arsivler ve bellek kullanimini karsilastirir
+void runArchiveBenchmark(long customerCount, int shipmentsPerCustomer) {
+    char date[11];
+    int startDay = daysFromCivil(2015, 1, 1);
+
+    quietMode = 1;
+    for (long i = 0; i < customerCount; i++) {
+        int customerID = addCustomer("Ali", "Yilmaz");
+        for (int j = 0; j < shipmentsPerCustomer; j++) {
+            daysToDate(startDay + j * 3 + (int)(i % 3), date);
+            addShipment(customerID, date, (j % 10 == 9) ? "Teslim Edilmedi" : "Teslim Edildi", 1 + (j * 7 + (int)i) % 9);
+        }
+    }
+    quietMode = 0;
+
+    long totalShipments = customerCount * shipmentsPerCustomer;
+    size_t before = mallinfo2().uordblks;
+
+    size_t freedBytes = 0, archivedBytes = 0;
+    long archived = archiveDeliveredShipments("2023-01-01", &freedBytes, &archivedBytes);
+    size_t after = mallinfo2().uordblks;
+
+    // Arsivden geri okunan kayitlarin dogrulugu
+    long decoded = 0;
+    for (Customer* c = customerList; c != NULL; c = c->next) {
+        decoded += countArchivedShipments(c);
+    }
+
+    printf("Toplam gonderi: %ld, arsivlenen: %ld (dogrulanan %ld)\n", totalShipments, archived, decoded);
+    printf("Gecmis bellegi: %.1f MB -> %.1f MB (%.1fx), gonderi basina %.1f -> %.1f bayt\n",
+           freedBytes / 1048576.0, archivedBytes / 1048576.0,
+           archivedBytes ? (double)freedBytes / archivedBytes : 0.0,
+           archived ? (double)freedBytes / archived : 0.0,
+           archived ? (double)archivedBytes / archived : 0.0);
+    printf("Heap kullanimi (malloc basliklari dahil): %.1f MB -> %.1f MB\n", before / 1048576.0, after / 1048576.0);
+}
+
+double monotonicSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Tavan altinda gonderi yukler; diske tasinan gecmislerin geri okununca
+// eksiksiz ve tarih sirali geldigini dogrular
+void runMemoryBenchmark(long customerCount, int shipmentsPerCustomer, double limitMegabytes) {
+    char date[11];
+    int startDay = daysFromCivil(2020, 1, 1);
+    memoryCeiling = (size_t)(limitMegabytes * 1048576);
+    size_t heapBefore = mallinfo2().uordblks;
+
+    quietMode = 1;
+    double start = monotonicSeconds();
+    for (long i = 0; i < customerCount; i++) {
+        int customerID = addCustomer("Ali", "Yilmaz");
+        for (int j = 0; j < shipmentsPerCustomer; j++) {
+            // Tarihler karisik sirada eklenir, liste yine de sirali kalmali
+            daysToDate(startDay + (j * 37) % shipmentsPerCustomer, date);
+            addShipment(customerID, date, (j % 4 == 3) ? "Teslim Edilmedi" : "Teslim Edildi", 1 + (j + (int)i) % 9);
+        }
+        enforceMemoryCeiling();
+    }
+    double loadSeconds = monotonicSeconds() - start;
+    quietMode = 0;
+    long spillsDuringLoad = spillCount;
+    size_t heapAfter = mallinfo2().uordblks;
+
+    printf("%ld musteri x %d gonderi, tavan %.1f MB: yukleme %.2f s (%ld gecmis tasindi)\n",
+           customerCount, shipmentsPerCustomer, limitMegabytes, loadSeconds, spillsDuringLoad);
+    printf("Muhasebedeki toplam %.1f MB, heap artisi %.1f MB (malloc basliklari dahil)\n",
+           totalMemoryUsage() / 1048576.0, (heapAfter - heapBefore) / 1048576.0);
+
+    // Okuyucu yolu: tasinmis gecmisler geri yuklenmeden dosyadan okunur
+    long verified = 0, errors = 0, readerRecords = 0;
+    Shipment spilled[64];
+    beginSnapshotRead();
+    for (Customer* customer = readPointer(customerList); customer != NULL; customer = readPointer(customer->next)) {
+        Shipment* history = readPointer(customer->shipmentHistory);
+        if (!isSpilledHistory(history)) continue;
+        int count, total = 0;
+        while ((count = readSpilledShipments(history, total, spilled, 64)) > 0) total += count;
+        if (total != shipmentsPerCustomer) errors++;
+        readerRecords += total;
+    }
+    endSnapshotRead();
+
+    // Yazici yolu: her gecmis sirayla geri okunur (oncekiler tavan icin tekrar tasinir)
+    long pageInsBefore = pageInCount;
+    start = monotonicSeconds();
+    for (int id = 1; id <= customerCount; id++) {
+        Customer* customer = findCustomer(id);
+        int count = 0;
+        for (Shipment* s = customerHistory(customer); s != NULL; s = s->next) {
+            if (s->next != NULL && strcmp(s->date, s->next->date) > 0) errors++;
+            count++;
+        }
+        if (count != shipmentsPerCustomer || count != customerShipmentCounts[id]) errors++;
+        verified += count;
+        enforceMemoryCeiling(); // Musteri basina bir guvenli nokta
+    }
+    double verifySeconds = monotonicSeconds() - start;
+
+    printf("Dogrulama: %ld gonderi (%ld tanesi okuyucu yolundan dosyadan), %ld hata\n", verified, readerRecords, errors);
+    printf("Tam tarama: %.2f s, %ld geri okuma (%.1f us/musteri)\n", verifySeconds, pageInCount - pageInsBefore,
+           customerCount ? verifySeconds * 1e6 / customerCount : 0.0);
+    displayMemoryUsage();
+    printf("RSS: %.1f MB\n", residentBytes() / 1048576.0);
+}
+
+// Tum filonun CSV disa aktarimi: kayit basina fprintf ile tamponlu disa aktarimi
+// karsilastirir; anahtarla sayfa sayfa alinan ciktinin tek seferlik ciktiyla
+// ayni oldugunu dogrular. Cakisan arsiv bloklari icin iki arsivleme turu yapilir.
+void runExportBenchmark(long customerCount, int shipmentsPerCustomer) {
+    char date[11];
+    int startDay = daysFromCivil(2018, 1, 1);
+    size_t freedBytes = 0, archivedBytes = 0;
+
+    quietMode = 1;
+    for (long i = 0; i < customerCount; i++) {
+        int customerID = addCustomer("Ali", "Yilmaz");
+        for (int j = 0; j < shipmentsPerCustomer; j++) {
+            daysToDate(startDay + (j * 5) % 2000, date);
+            addShipment(customerID, date, (j % 4 == 3) ? "Teslim Edilmedi" : "Teslim Edildi", 1 + (j + (int)i) % 9);
+        }
+    }
+    archiveDeliveredShipments("2020-01-01", &freedBytes, &archivedBytes);
+    for (long i = 1; i <= customerCount; i++) {
+        daysToDate(startDay + 3 + (int)(i % 50), date); // Ilk arsivle ayni gunler
+        addShipment((int)i, date, "Teslim Edildi", 2);
+    }
+    archiveDeliveredShipments("2020-01-01", &freedBytes, &archivedBytes);
+    quietMode = 0;
+
+    char legacyPath[] = "/tmp/kargo-export-legacyXXXXXX";
+    char bufferedPath[] = "/tmp/kargo-exportXXXXXX";
+    int legacyFd = mkstemp(legacyPath);
+    int bufferedFd = mkstemp(bufferedPath);
+    if (legacyFd < 0 || bufferedFd < 0) {
+        printError("Gecici dosya olusturulamadi.");
+        return;
+    }
+    close(bufferedFd);
+
+    // Eski yol: once arsiv, sonra canli liste, kayit basina bir fprintf
+    double start = monotonicSeconds();
+    FILE* legacy = fdopen(legacyFd, "w");
+    long legacyRecords = 0;
+    fprintf(legacy, "customerID,shipmentID,date,status,deliveryTime,archived\n");
+    for (int id = 1; id <= customerCount; id++) {
+        Customer* customer = findCustomer(id);
+        Shipment archived;
+        ArchiveCursor cursor;
+        ArchiveBlock** archive = customerArchive(customer);
+        openArchiveCursor(&cursor, archive ? *archive : NULL);
+        while (nextArchivedShipment(&cursor, &archived)) {
+            fprintf(legacy, "%d,%d,%s,%s,%d,1\n", id, archived.shipmentID, archived.date, archived.status, archived.deliveryTime);
+            legacyRecords++;
+        }
+        for (Shipment* s = customerHistory(customer); s != NULL; s = s->next) {
+            fprintf(legacy, "%d,%d,%s,%s,%d,0\n", id, s->shipmentID, s->date, s->status, s->deliveryTime);
+            legacyRecords++;
+        }
+    }
+    fclose(legacy);
+    double legacySeconds = monotonicSeconds() - start;
+
+    ExportCursor cursor;
+    openExportCursor(&cursor, 0);
+    start = monotonicSeconds();
+    long records = exportToFile(bufferedPath, EXPORT_CSV, 0, &cursor);
+    double bufferedSeconds = monotonicSeconds() - start;
+
+    struct stat info;
+    stat(bufferedPath, &info);
+    double megabytes = info.st_size / 1048576.0;
+    printf("%ld kayit, %.1f MB CSV:\n", records, megabytes);
+    printf("  Kayit basina fprintf : %.3f s (%.0f MB/s, %ld kayit)\n", legacySeconds, megabytes / legacySeconds, legacyRecords);
+    printf("  Tamponlu disa aktarim: %.3f s (%.0f MB/s, %.1fx)\n", bufferedSeconds, megabytes / bufferedSeconds,
+           legacySeconds / bufferedSeconds);
+
+    // Sayfali cikti: her sayfada imlec anahtara cevrilip yeniden cozulur
+    int fd = open(bufferedPath, O_RDONLY);
+    char* full = (char*)safeMalloc((size_t)info.st_size);
+    ssize_t fullLength = read(fd, full, (size_t)info.st_size);
+    close(fd);
+
+    ByteBuffer paged = { NULL, 0, 0 };
+    char token[48] = "";
+    long pages = 0, pagedRecords = 0;
+    int ordered = 1;
+    do {
+        parseExportToken(&cursor, token, 0);
+        if (pages == 0) cursor.headerWritten = 0;
+        pagedRecords += exportShipments(&cursor, 997, EXPORT_CSV, &paged);
+        formatExportToken(&cursor, token, sizeof(token));
+        pages++;
+    } while (token[0] != '\0');
+
+    // Her musteride (tarih, ID) sirasi korunmali
+    char previous[64] = "";
+    for (char* line = full; line < full + fullLength; ) {
+        char* end = memchr(line, '\n', (size_t)(full + fullLength - line));
+        char head[40], key[64];
+        int customerID = 0, shipmentID = 0;
+        char lineDate[11] = "";
+        size_t headLength = (size_t)(end - line) < sizeof(head) - 1 ? (size_t)(end - line) : sizeof(head) - 1;
+        memcpy(head, line, headLength); // sscanf tum tamponu taramasin
+        head[headLength] = '\0';
+        if (sscanf(head, "%d,%d,%10[0-9-]", &customerID, &shipmentID, lineDate) == 3) {
+            snprintf(key, sizeof(key), "%010d %s %010d", customerID, lineDate, shipmentID);
+            if (strcmp(previous, key) >= 0) ordered = 0;
+            strcpy(previous, key);
+        }
+        line = end + 1;
+    }
+
+    int identical = fullLength == (ssize_t)paged.length && memcmp(full, paged.data, paged.length) == 0;
+    printf("  Sayfali (997 kayit, %ld sayfa): %ld kayit, tek seferlik ciktiyla %s, sira %s\n", pages, pagedRecords,
+           identical ? "ayni" : "FARKLI", ordered ? "dogru" : "HATALI");
+
+    free(full);
+    bufferFree(&paged);
+    unlink(legacyPath);
+    unlink(bufferedPath);
+}
+
+// Bolumlu mod olcumunde bir calismanin sureleri ve karsilastirilacak yanitlari
+typedef struct PartitionBenchRun {
+    double seconds[3]; // Musteri ekleme, gonderi ekleme, okuma
+    long failures;
+    ByteBuffer totals; // OP_FLEET_TOTALS yaniti
+    ByteBuffer names;  // OP_FIND_BY_NAME yanitlari
+    ByteBuffer counts; // Musteri basina gonderi sayilari
+    ByteBuffer latest; // Son gonderilerin tarihleri (ID'ler bolumlere gore farkli uretilir)
+} PartitionBenchRun;
+
+size_t beginBenchFrame(ByteBuffer* frames, int opcode) {
+    size_t lengthSlot = frames->length;
+    bufferAppendInt32(frames, 0);
+    bufferAppendU8(frames, (unsigned int)opcode);
+    return lengthSlot;
+}
+
+// Birikmis cerceveleri isler; basarisiz yanitlari sayar, istenirse durum
+// baytindan sonraki govdeyi collect'e ekler
+void flushBenchFrames(ClientConnection* client, PartitionBenchRun* run, ByteBuffer* collect) {
+    processClientFrames(client);
+    for (size_t offset = 0; offset + 4 <= client->output.length; ) {
+        uint32_t length = decodeU32(client->output.data + offset);
+        const unsigned char* body = client->output.data + offset + 4;
+        if (length == 0 || body[0] != STATUS_OK) run->failures++;
+        if (collect != NULL && length > 1) bufferAppend(collect, body + 1, length - 1);
+        offset += 4 + length;
+    }
+    client->output.length = 0;
+}
+
+void runPartitionWorkload(long customerCount, int shipmentsPerCustomer, PartitionBenchRun* run) {
+    static const char* firstNames[8] = { "Ali", "Ayse", "Mehmet", "Zeynep", "Can", "Elif", "Emre", "Deniz" };
+    static const char* lastNames[16] = { "Yilmaz", "Kaya", "Demir", "Celik", "Sahin", "Yildiz", "Aydin", "Ozturk",
+                                         "Arslan", "Dogan", "Kilic", "Aslan", "Cetin", "Kara", "Koc", "Kurt" };
+    static const char* statuses[3] = { "Teslim Edildi", "Teslim Edilmedi", "Yolda" };
+    ClientConnection client;
+    char date[11];
+    int startDay = daysFromCivil(2020, 1, 1);
+    long pending = 0;
+
+    memset(&client, 0, sizeof(client));
+    client.fd = -1;
+    memset(run, 0, sizeof(*run));
+
+    double start = monotonicSeconds();
+    for (long i = 0; i < customerCount; i++) {
+        size_t slot = beginBenchFrame(&client.input, OP_ADD_CUSTOMER);
+        bufferAppendString(&client.input, firstNames[i % 8]);
+        bufferAppendString(&client.input, lastNames[(i / 8) % 16]);
+        patchFrameLength(&client.input, slot);
+        if (++pending == 512) {
+            flushBenchFrames(&client, run, NULL);
+            pending = 0;
+        }
+    }
+    flushBenchFrames(&client, run, NULL);
+    pending = 0;
+    run->seconds[0] = monotonicSeconds() - start;
+
+    start = monotonicSeconds();
+    for (int j = 0; j < shipmentsPerCustomer; j++) {
+        for (long i = 1; i <= customerCount; i++) {
+            daysToDate(startDay + (int)((i * 7 + j * 13) % 1500), date);
+            size_t slot = beginBenchFrame(&client.input, OP_ADD_SHIPMENT);
+            bufferAppendInt32(&client.input, (int32_t)i);
+            bufferAppendString(&client.input, date);
+            bufferAppendString(&client.input, statuses[(i + j) % 3]);
+            bufferAppendInt32(&client.input, 1 + (int)((i + j) % 9));
+            patchFrameLength(&client.input, slot);
+            if (++pending == 512) {
+                flushBenchFrames(&client, run, NULL);
+                pending = 0;
+            }
+        }
+    }
+    flushBenchFrames(&client, run, NULL);
+    pending = 0;
+    run->seconds[1] = monotonicSeconds() - start;
+
+    // Okuma: musteri basina sayac ve gecmis
+    start = monotonicSeconds();
+    for (long i = 1; i <= customerCount; i++) {
+        size_t slot = beginBenchFrame(&client.input, OP_COUNT_SHIPMENTS);
+        bufferAppendInt32(&client.input, (int32_t)i);
+        patchFrameLength(&client.input, slot);
+        if (++pending == 512) {
+            flushBenchFrames(&client, run, &run->counts);
+            pending = 0;
+        }
+    }
+    flushBenchFrames(&client, run, &run->counts);
+    pending = 0;
+    for (long i = 1; i <= customerCount; i++) {
+        size_t slot = beginBenchFrame(&client.input, OP_GET_SHIPMENTS);
+        bufferAppendInt32(&client.input, (int32_t)i);
+        patchFrameLength(&client.input, slot);
+        if (++pending == 512) {
+            flushBenchFrames(&client, run, NULL);
+            pending = 0;
+        }
+    }
+    flushBenchFrames(&client, run, NULL);
+    run->seconds[2] = monotonicSeconds() - start;
+
+    // Dogrulama sorgulari (olcume dahil degil)
+    size_t slot = beginBenchFrame(&client.input, OP_FLEET_TOTALS);
+    patchFrameLength(&client.input, slot);
+    flushBenchFrames(&client, run, &run->totals);
+
+    for (int i = 0; i < 16; i++) {
+        slot = beginBenchFrame(&client.input, OP_FIND_BY_NAME);
+        bufferAppendString(&client.input, lastNames[i]);
+        bufferAppendU8(&client.input, 0);
+        bufferAppendInt32(&client.input, (int32_t)(i * 37 % 200));
+        bufferAppendInt32(&client.input, 64);
+        patchFrameLength(&client.input, slot);
+    }
+    slot = beginBenchFrame(&client.input, OP_FIND_BY_NAME);
+    bufferAppendString(&client.input, "K");
+    bufferAppendU8(&client.input, 1);
+    bufferAppendInt32(&client.input, 150);
+    bufferAppendInt32(&client.input, 40);
+    patchFrameLength(&client.input, slot);
+    flushBenchFrames(&client, run, &run->names);
+
+    ByteBuffer latest = { NULL, 0, 0 };
+    slot = beginBenchFrame(&client.input, OP_LAST_SHIPMENTS);
+    bufferAppendInt32(&client.input, SERVER_MAX_LAST_SHIPMENTS);
+    patchFrameLength(&client.input, slot);
+    flushBenchFrames(&client, run, &latest);
+    ByteReader reader = { latest.data, latest.length, 0, 0 };
+    int count = readInt32(&reader);
+    for (int i = 0; i < count && !reader.failed; i++) {
+        Shipment shipment;
+        readShipmentRecord(&reader, &shipment);
+        bufferAppend(&run->latest, shipment.date, 10);
+    }
+
+    bufferFree(&latest);
+    bufferFree(&client.input);
+    bufferFree(&client.output);
+}
+
+int sameBenchBytes(const ByteBuffer* a, const ByteBuffer* b) {
+    return a->length == b->length && (a->length == 0 || memcmp(a->data, b->data, a->length) == 0);
+}
+
+void freePartitionBenchRun(PartitionBenchRun* run) {
+    bufferFree(&run->totals);
+    bufferFree(&run->names);
+    bufferFree(&run->counts);
+    bufferFree(&run->latest);
+}
+
+// Ayni istek akisi once N isci surecle, sonra tek surecte islenir. Yazma ve
+// okuma hizlari ile iki calismanin yanitlari karsilastirilir.
+void runPartitionBenchmark(int partitions, long customerCount, int shipmentsPerCustomer) {
+    static const char* phases[3] = { "Musteri ekleme", "Gonderi ekleme", "Okuma" };
+    long requests[3] = { customerCount, customerCount * shipmentsPerCustomer, customerCount * 2 };
+    PartitionBenchRun partitioned, single;
+
+    if (!startPartitionWorkers(partitions)) return;
+    printf("%d bolum, %ld musteri x %d gonderi (cevrimici CPU: %ld)\n", partitions, customerCount,
+           shipmentsPerCustomer, sysconf(_SC_NPROCESSORS_ONLN));
+    quietMode = 1;
+    runPartitionWorkload(customerCount, shipmentsPerCustomer, &partitioned);
+    stopPartitionWorkers();
+
+    // Isciler kapandi; on surec hic veri tutmadigi icin akis bastan calisir
+    runPartitionWorkload(customerCount, shipmentsPerCustomer, &single);
+    quietMode = 0;
+
+    printf("%-16s %14s %14s %8s\n", "Asama", "Tek surec/s", "Bolumlu/s", "Oran");
+    for (int i = 0; i < 3; i++) {
+        double singleRate = requests[i] / (single.seconds[i] > 0 ? single.seconds[i] : 1e-9);
+        double partitionedRate = requests[i] / (partitioned.seconds[i] > 0 ? partitioned.seconds[i] : 1e-9);
+        printf("%-16s %14.0f %14.0f %7.2fx\n", phases[i], singleRate, partitionedRate, partitionedRate / singleRate);
+    }
+    printf("Basarisiz istek: tek surec %ld, bolumlu %ld\n", single.failures, partitioned.failures);
+    printf("Toplamlar %s, isim aramalari %s, musteri sayaclari %s, son gonderi tarihleri %s\n",
+           sameBenchBytes(&single.totals, &partitioned.totals) ? "ayni" : "FARKLI",
+           sameBenchBytes(&single.names, &partitioned.names) ? "ayni" : "FARKLI",
+           sameBenchBytes(&single.counts, &partitioned.counts) ? "ayni" : "FARKLI",
+           sameBenchBytes(&single.latest, &partitioned.latest) ? "ayni" : "FARKLI");
+
+    freePartitionBenchRun(&partitioned);
+    freePartitionBenchRun(&single);
+}
+
+// Sehir agini okuyucu yokken bosaltir (yalnizca olcumler arasinda)
+void resetCityNetwork() {
+    CityNode* oldRoot = root;
+    publishPointer(root, (CityNode*)NULL);
+    commitWrite();
+    freeCityTree(oldRoot);
+    freeCityIndex(&cityIndex);
+    autoCityID = 1;
+}
+
+// Agaci on sirada (cocuklar kardeslerden once) gezip ID, ebeveyn sirasi ve
+// teslim suresinden bir ozet cikarir; ayni sekilde kurulan agaclarin ozeti aynidir
+uint64_t cityTreeDigest(long cityCount) {
+    CityNode** stack = (CityNode**)safeMalloc((cityCount + 1) * sizeof(CityNode*));
+    uint64_t digest = 1469598103934665603ull;
+    int top = 0;
+    if (root != NULL) stack[top++] = root;
+    while (top > 0) {
+        CityNode* node = stack[--top];
+        digest = (digest ^ (uint64_t)node->cityID) * 1099511628211ull;
+        digest = (digest ^ (uint64_t)node->deliveryTime) * 1099511628211ull;
+        if (node->sibling != NULL) stack[top++] = node->sibling;
+        if (node->child != NULL) stack[top++] = node->child;
+    }
+    free(stack);
+    return digest;
+}
+
+// 10^4'ten maxCities'e kadar sentetik aglarda acilis suresi: sehir basina
+// eski addCity (tam agac aramasi), dizinli addCity ve dosyadan toplu yukleme
+void runCityLoadBenchmark(long maxCities) {
+    char path[] = "/tmp/kargo-sehirXXXXXX";
+    char cityName[50];
+
+    quietMode = 1;
+    printf("%10s %14s %14s %14s %12s\n", "Sehir", "Eski addCity", "addCity", "Toplu yukleme", "Agaclar");
+    for (long count = 10000; count <= maxCities; count *= 10) {
+        // Her sehrin ebeveyni kendinden onceki rastgele bir sehirdir (satirlar ebeveyn sirasinda)
+        int* parents = (int*)safeMalloc((count + 1) * sizeof(int));
+        uint64_t seed = 0x9E3779B97F4A7C15ull ^ (uint64_t)count;
+        parents[1] = 0;
+        for (long i = 2; i <= count; i++) {
+            seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+            parents[i] = 1 + (int)(seed % (uint64_t)(i - 1));
+        }
+        int fd = mkstemp(path);
+        if (fd < 0) {
+            perror("mkstemp");
+            free(parents);
+            break;
+        }
+        FILE* file = fdopen(fd, "w");
+        fprintf(file, "# SehirID,EbeveynID,SehirAdi,TeslimSuresi\n");
+        for (long i = 1; i <= count; i++) {
+            fprintf(file, "%ld,%d,Sube%ld,%ld\n", i, parents[i], i, 1 + i % 9);
+        }
+        fclose(file);
+
+        double legacySeconds = -1;
+        uint64_t legacyDigest = 0;
+#ifdef KARGO_LEGACY_BENCH
+        if (count <= 20000) { // Karesel oldugu icin buyuk aglarda atlanir
+            resetCityNetwork();
+            double start = monotonicSeconds();
+            for (long i = 1; i <= count; i++) {
+                snprintf(cityName, sizeof(cityName), "Sube%ld", i);
+                legacyAddCity(parents[i], (int)i, cityName, 1 + (int)(i % 9));
+            }
+            legacySeconds = monotonicSeconds() - start;
+            legacyDigest = cityTreeDigest(count);
+        }
+#endif
+
+        resetCityNetwork();
+        double start = monotonicSeconds();
+        for (long i = 1; i <= count; i++) {
+            snprintf(cityName, sizeof(cityName), "Sube%ld", i);
+            addCity(parents[i], (int)i, cityName, 1 + (int)(i % 9));
+        }
+        double indexedSeconds = monotonicSeconds() - start;
+        uint64_t indexedDigest = cityTreeDigest(count);
+
+        resetCityNetwork();
+        start = monotonicSeconds();
+        int loaded = loadCityNetwork(path);
+        double bulkSeconds = monotonicSeconds() - start;
+        uint64_t bulkDigest = cityTreeDigest(count);
+        unlink(path);
+        strcpy(path, "/tmp/kargo-sehirXXXXXX");
+
+        char legacyText[32];
+        if (legacySeconds >= 0) snprintf(legacyText, sizeof(legacyText), "%.1f ms", legacySeconds * 1000);
+        else strcpy(legacyText, "-");
+        int same = loaded == count && bulkDigest == indexedDigest && (legacySeconds < 0 || legacyDigest == indexedDigest);
+        printf("%10ld %14s %11.1f ms %11.1f ms %12s\n", count, legacyText, indexedSeconds * 1000,
+               bulkSeconds * 1000, same ? "ayni" : "FARKLI");
+        free(parents);
+    }
+    quietMode = 0;
+#ifdef KARGO_LEGACY_BENCH
+    printf("Eski addCity 20000 sehirden buyuk aglarda olculmedi (ebeveyn aramasi agac boyunca).\n");
+#else
+    printf("Eski addCity derlenmedi (-DKARGO_LEGACY_BENCH ile derleyin).\n");
+#endif
+}
+
+// Izleme maliyeti olcumu icin ayni is, span'li ve span'siz
+__attribute__((noinline)) uint64_t traceBenchPlain(uint64_t x) {
+    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+    return x;
+}
+
+__attribute__((noinline)) uint64_t traceBenchSpanned(uint64_t x) {
+    TRACE_SPAN("olcum");
+    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+    return x;
+}
+
+double traceBenchLoop(long count, int spanned) {
+    volatile uint64_t sink;
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    double start = monotonicSeconds();
+    for (long i = 0; i < count; i++) {
+        x = spanned ? traceBenchSpanned(x) : traceBenchPlain(x);
+    }
+    sink = x;
+    (void)sink;
+    return (monotonicSeconds() - start) * 1e9 / count;
+}
+
+#ifdef KARGO_TRACE
+// Bu is parcaciginin halkasindaki fromHead sonrasi olaylari ada gore toplar
+void printTraceSummary(uint64_t fromHead) {
+    typedef struct SpanTotal {
+        const char* name;
+        long count;
+        uint64_t total;
+    } SpanTotal;
+    SpanTotal totals[32];
+    int totalCount = 0;
+    TraceRing* ring = traceRing;
+    uint64_t head = ring->head;
+    if (head - fromHead > TRACE_RING_EVENTS) fromHead = head - TRACE_RING_EVENTS;
+
+    for (uint64_t i = fromHead; i < head; i++) {
+        const TraceEvent* event = &ring->events[i & (TRACE_RING_EVENTS - 1)];
+        int k = 0;
+        while (k < totalCount && totals[k].name != event->name) k++;
+        if (k == totalCount) {
+            if (totalCount == 32) continue;
+            totals[totalCount].name = event->name;
+            totals[totalCount].count = 0;
+            totals[totalCount++].total = 0;
+        }
+        totals[k].count++;
+        totals[k].total += event->duration;
+    }
+    for (int i = 0; i < totalCount; i++) {
+        printf("  %-30s %8ld kez %10.2f ms %10.2f us/kez\n", totals[i].name, totals[i].count,
+               totals[i].total / 1e6, totals[i].total / 1e3 / totals[i].count);
+    }
+}
+#endif
+
+// Span basina maliyet (izleme kapali/acik) ve izlenen islemlerin asama dokumu
+void runTraceBenchmark(long spanCount) {
+    if (spanCount <= 0) {
+        printError("Cagri sayisi pozitif olmalidir.");
+        return;
+    }
+    double plain = traceBenchLoop(spanCount, 0);
+    double disabled = traceBenchLoop(spanCount, 1);
+    printf("%ld cagri: span'siz %.2f ns, span'li (izleme kapali) %.2f ns/cagri\n", spanCount, plain, disabled);
+#ifdef KARGO_TRACE
+    int wasEnabled = traceEnabled;
+    traceEnabled = 1;
+    double enabled = traceBenchLoop(spanCount, 1);
+    printf("Izleme acik: %.2f ns/cagri (span basina %.2f ns)\n", enabled, enabled - plain);
+
+    // Son 5 gonderi: kopyalama, siralama ve serbest birakma
+    char date[11];
+    int startDay = daysFromCivil(2023, 1, 1);
+    quietMode = 1;
+    for (int i = 0; i < 2000; i++) {
+        int customerID = addCustomer("Ali", "Yilmaz");
+        for (int j = 0; j < 25; j++) {
+            daysToDate(startDay + (i * 7 + j * 13) % 700, date);
+            addShipment(customerID, date, "Yolda", 1 + j % 9);
+        }
+    }
+    Shipment lastFive[5];
+    uint64_t mark = traceRing->head;
+    for (int i = 0; i < 20; i++) collectLastShipments(lastFive, 5);
+    printf("collectLastShipments (50000 gonderi, 20 kez):\n");
+    printTraceSummary(mark);
+
+    // Sehir ekleme: dizinli ve eski surum
+    char cityName[50];
+    resetCityNetwork();
+    mark = traceRing->head;
+    for (int i = 1; i <= 10000; i++) {
+        snprintf(cityName, sizeof(cityName), "Sube%d", i);
+        addCity(i == 1 ? 0 : 1 + (i * 7919) % (i - 1), i, cityName, 1 + i % 9);
+    }
+    printf("addCity (10000 sehir):\n");
+    printTraceSummary(mark);
+#ifdef KARGO_LEGACY_BENCH
+    resetCityNetwork();
+    mark = traceRing->head;
+    for (int i = 1; i <= 10000; i++) {
+        snprintf(cityName, sizeof(cityName), "Sube%d", i);
+        legacyAddCity(i == 1 ? 0 : 1 + (i * 7919) % (i - 1), i, cityName, 1 + i % 9);
+    }
+    printf("legacyAddCity (10000 sehir):\n");
+    printTraceSummary(mark);
+#endif
+    quietMode = 0;
+    traceEnabled = wasEnabled;
+#else
+    printf("Izleme derlenmedi (-DKARGO_TRACE); TRACE_SPAN bos makrodur.\n");
+#endif
+}
+
+// Musteri gecmislerindeki gonderi sirasindan ve ozet sayaclarindan bir ozet
+// cikarir; geri alma ve yinelemenin durumu tam olarak geri getirdigini dogrular
+uint64_t shipmentStateDigest() {
+    uint64_t digest = 1469598103934665603ull;
+    for (Customer* customer = customerList; customer != NULL; customer = customer->next) {
+        digest = (digest ^ (uint64_t)customerShipmentCounts[customerSlot(customer->customerID)]) * 1099511628211ull;
+        for (Shipment* shipment = customerHistory(customer); shipment != NULL; shipment = shipment->next) {
+            digest = (digest ^ (uint64_t)shipment->shipmentID) * 1099511628211ull;
+        }
+    }
+    for (int i = 0; i < statusRollupCount; i++) {
+        digest = (digest ^ (uint64_t)statusRollups[i].stats.count) * 1099511628211ull;
+        digest = (digest ^ (uint64_t)statusRollups[i].stats.sum) * 1099511628211ull;
+    }
+    return digest;
+}
+
+int addUndoBenchCustomers(int customerCount) {
+    int firstCustomer = 0;
+    for (int i = 0; i < customerCount; i++) {
+        int customerID = addCustomer("Ali", "Yilmaz");
+        if (i == 0) firstCustomer = customerID;
+    }
+    return firstCustomer;
+}
+
+// Ayni tohumla ayni gonderi dagilimini yeni musterilere ekler; her tur ayni
+// uzunlukta gecmislerle calisir. Eklemelerin suresini doner.
+double undoBenchInsert(long shipmentCount, int firstCustomer, int customerCount) {
+    char date[11];
+    int firstDay = daysFromCivil(2024, 1, 1);
+    unsigned int seed = 12345;
+    double start = monotonicSeconds();
+    for (long i = 0; i < shipmentCount; i++) {
+        seed = seed * 1103515245u + 12345u;
+        daysToDate(firstDay + (int)(seed >> 8) % 365, date);
+        addShipment(firstCustomer + (int)(i % customerCount) * idStride, date,
+                    (seed & 16) ? "Teslim Edildi" : "Teslim Edilmedi", 1 + (int)(seed >> 20) % 12);
+    }
+    return monotonicSeconds() - start;
+}
+
+// Toplu islem gunlugunun maliyeti: ayni dagilim gunluk kapali ve acik bir
+// islem icindeyken eklenir. Ilk tur isinma icindir ve sayilmaz; sonraki
+// turlarda iki durumun sirasi her tur degisir ve en iyi tur alinir. Gunluk
+// her islemden sonra ayrica atilir ve bu sure eklemelere katilmadan olculur
+// (aksi halde sonraki gunluksuz ekleme atma isini kendi suresine yazar).
+// Ardindan islem geri alinir, yinelenir ve iptal edilir; her adimda gecmislerin
+// ozeti islem oncesi ya da sonrasiyla karsilastirilir.
+void runUndoBenchmark(long shipmentCount) {
+    enum { ROUNDS = 5, PER_CUSTOMER = 20 };
+    int customerCount = (int)(shipmentCount / PER_CUSTOMER) > 0 ? (int)(shipmentCount / PER_CUSTOMER) : 1;
+    quietMode = 1;
+
+    double idle = 0, logged = 0, discard = 0;
+    int discarded = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int step = 0; step < 2; step++) {
+            int withLog = (round + step) % 2;
+            int firstCustomer = addUndoBenchCustomers(customerCount);
+            if (!withLog) {
+                double seconds = undoBenchInsert(shipmentCount, firstCustomer, customerCount);
+                if (round == 1 || seconds < idle) idle = seconds;
+                continue;
+            }
+
+            beginBatch();
+            double seconds = undoBenchInsert(shipmentCount, firstCustomer, customerCount);
+            int entries = commitBatch();
+            double start = monotonicSeconds();
+            discardOpLog("olcum");
+            double discardSeconds = monotonicSeconds() - start;
+            if (round == 0) continue; // Isinma turu
+            if (round == 1 || seconds < logged) logged = seconds;
+            if (round == 1 || discardSeconds < discard) {
+                discard = discardSeconds;
+                discarded = entries;
+            }
+        }
+    }
+
+    // Geri alma olcumu icin ayri bir islem
+    int batchCustomer = addUndoBenchCustomers(customerCount);
+    beginBatch();
+    undoBenchInsert(shipmentCount, batchCustomer, customerCount);
+    commitBatch();
+
+    uint64_t committed = shipmentStateDigest();
+    double start = monotonicSeconds();
+    int undone = undoBatch();
+    double undoSeconds = monotonicSeconds() - start;
+    uint64_t afterUndo = shipmentStateDigest();
+
+    start = monotonicSeconds();
+    int redone = redoBatch();
+    double redoSeconds = monotonicSeconds() - start;
+    int redoMatches = shipmentStateDigest() == committed;
+
+    // Geri alinmis hal, islem olmadan kurulan durumla ayni olmali
+    undoBatch();
+    int undoMatches = shipmentStateDigest() == afterUndo;
+    redoBatch();
+
+    int firstCustomer = addUndoBenchCustomers(customerCount);
+    uint64_t beforeBatch = shipmentStateDigest();
+    beginBatch();
+    undoBenchInsert(shipmentCount, firstCustomer, customerCount);
+    start = monotonicSeconds();
+    int rolledBack = rollbackBatch();
+    double rollbackSeconds = monotonicSeconds() - start;
+    int rollbackMatches = shipmentStateDigest() == beforeBatch;
+    quietMode = 0;
+
+    printf("%ld gonderi/tur, tur basina %d yeni musteri, isinmadan sonra %d tur (en iyi tur):\n",
+           shipmentCount, customerCount, ROUNDS - 1);
+    printf("  Ekleme, gunluk kapali:     %8.1f ns/gonderi\n", idle / shipmentCount * 1e9);
+    printf("  Ekleme, toplu islem icinde: %7.1f ns/gonderi (%+.1f%%)\n", logged / shipmentCount * 1e9,
+           (logged / idle - 1) * 100);
+    printf("  Gunlugu atma: %d kayit %.2f ms (%.1f ns/kayit)\n", discarded, discard * 1e3,
+           discard / discarded * 1e9);
+    printf("  Geri alma: %d kayit %.2f ms (%.1f ns/kayit), durum %s\n", undone, undoSeconds * 1e3,
+           undoSeconds / undone * 1e9, undoMatches ? "ayni" : "FARKLI");
+    printf("  Yineleme:  %d kayit %.2f ms (%.1f ns/kayit), durum %s\n", redone, redoSeconds * 1e3,
+           redoSeconds / redone * 1e9, redoMatches ? "ayni" : "FARKLI");
+    printf("  Iptal:     %d kayit %.2f ms, durum %s\n", rolledBack, rollbackSeconds * 1e3,
+           rollbackMatches ? "ayni" : "FARKLI");
+    printf("  Gunluk kaydi %zu bayt; dugumler kopyalanmaz\n", sizeof(OpLogEntry));
+}
+
+// Gecici bir CSV dosyasi uretir ve farkli is parcacigi sayilariyla aktarir
+void runImportBenchmark(long rowCount, int maxThreads) {
+    char path[] = "/tmp/kargo-importXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        perror("mkstemp");
+        return;
+    }
+
+    FILE* file = fdopen(fd, "w");
+    long customerCount = rowCount / 100 + 1;
+    char date[11];
+    for (long i = 0; i < customerCount; i++) {
+        fprintf(file, "C,Ad%ld,Soyad%ld\n", i % 997, i % 4099);
+    }
+    for (long i = 0; i < rowCount; i++) {
+        daysToDate(daysFromCivil(2020, 1, 1) + (int)((i * 7919) % 1500), date);
+        fprintf(file, "S,%ld,%s,%s,%ld\n", 1 + (i * 31) % customerCount, date,
+                (i % 3) ? "Teslim Edildi" : "Teslim Edilmedi", 1 + i % 9);
+    }
+    fclose(file);
+
+    printf("%ld musteri + %ld gonderi satiri aktariliyor:\n", customerCount, rowCount);
+    for (int threads = 1; ; threads *= 2) {
+        if (threads > maxThreads) threads = maxThreads;
+
+        long importedCustomers, importedShipments;
+        double start = monotonicSeconds();
+        int errors = importCsvFile(path, threads, &importedCustomers, &importedShipments);
+        double elapsed = monotonicSeconds() - start;
+        printf("  %2d is parcacigi: %.3f s, %.0f satir/s (%ld gonderi, %d hata)\n", threads, elapsed,
+               (customerCount + rowCount) / elapsed, importedShipments, errors);
+
+        // Sonraki olcum bos depoyla baslasin
+        freeCustomerList();
+        autoCustomerID = 1;
+        autoShipmentID = 1;
+        if (threads == maxThreads) break;
+    }
+    unlink(path);
+}
+
+// Snapshot okuyucu olcumu icin paylasilan durum
+#define SNAPSHOT_BENCH_PRELOAD 1000
+#define SNAPSHOT_BENCH_SAMPLES 200000
+
+// Olcumler asama (0: yazici bosta, 1: yogun yazma) ve okuma turune gore tutulur
+typedef struct SnapshotBenchReader {
+    pthread_t thread;
+    double* latencies[2][3]; // Tur 0: kuyruk+stack, 1: sehir agaci, 2: son 5 gonderi
+    int sampleCount[2][3];
+    long inconsistent[2];
+} SnapshotBenchReader;
+
+int snapshotBenchPhase = 0; // 2: okuyucular dursun
+
+void* snapshotBenchReaderMain(void* argument) {
+    SnapshotBenchReader* reader = (SnapshotBenchReader*)argument;
+    Shipment lastFive[5];
+    int round = 0;
+
+    int phase;
+    while ((phase = __atomic_load_n(&snapshotBenchPhase, __ATOMIC_ACQUIRE)) < 2) {
+        int kind = round++ % 3;
+        double start = monotonicSeconds();
+
+        if (kind == 0) {
+            // Yazici her adimda bir ekleyip bir cikardigindan boyut N veya N+1 olmali
+            int queueCount = 0, stackCount = 0;
+            beginSnapshotRead();
+            for (PriorityQueueNode* n = readPointer(priorityQueueChain); n != NULL; n = readPointer(n->next)) {
+                if (isVisible(n->born, readPointer(n->died))) queueCount++;
+            }
+            for (ShipmentStackNode* n = readPointer(shipmentStackChain); n != NULL; n = readPointer(n->next)) {
+                if (isVisible(n->born, readPointer(n->died))) stackCount++;
+            }
+            endSnapshotRead();
+            if (queueCount < SNAPSHOT_BENCH_PRELOAD || queueCount > SNAPSHOT_BENCH_PRELOAD + 1 ||
+                stackCount < SNAPSHOT_BENCH_PRELOAD || stackCount > SNAPSHOT_BENCH_PRELOAD + 1) {
+                reader->inconsistent[phase]++;
+            }
+        } else if (kind == 1) {
+            beginSnapshotRead();
+            CityNode* treeRoot = readPointer(root);
+            volatile int total = countCities(treeRoot) + calculateTreeDepth(treeRoot) + calculateMinDeliveryTime(treeRoot);
+            (void)total;
+            endSnapshotRead();
+        } else {
+            collectLastShipments(lastFive, 5);
+        }
+
+        if (reader->sampleCount[phase][kind] < SNAPSHOT_BENCH_SAMPLES) {
+            reader->latencies[phase][kind][reader->sampleCount[phase][kind]++] = monotonicSeconds() - start;
+        }
+    }
+
+    releaseReaderSlot();
+    return NULL;
+}
+
+int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Bir asamanin okuyucu gecikmelerini (mikrosaniye) yazdirir
+void reportSnapshotLatencies(const char* title, int phase, SnapshotBenchReader* readers, int readerCount) {
+    static const char* names[3] = { "kuyruk+stack", "sehir agaci ", "son 5      " };
+    long inconsistent = 0;
+
+    printf("%s:\n", title);
+    for (int kind = 0; kind < 3; kind++) {
+        int total = 0;
+        for (int r = 0; r < readerCount; r++) total += readers[r].sampleCount[phase][kind];
+        if (total == 0) continue;
+
+        double* all = (double*)safeMalloc(total * sizeof(double));
+        int index = 0;
+        for (int r = 0; r < readerCount; r++) {
+            memcpy(all + index, readers[r].latencies[phase][kind], readers[r].sampleCount[phase][kind] * sizeof(double));
+            index += readers[r].sampleCount[phase][kind];
+        }
+        qsort(all, total, sizeof(double), compareDoubles);
+        printf("  %s  %7d okuma, p50 %8.1f us, p99 %8.1f us\n", names[kind], total,
+               all[total / 2] * 1e6, all[(int)(total * 0.99)] * 1e6);
+        free(all);
+    }
+    for (int r = 0; r < readerCount; r++) {
+        inconsistent += readers[r].inconsistent[phase];
+    }
+    printf("  Tutarsiz goruntu: %ld\n", inconsistent);
+}
+
+// Okuyucularin gecikmesini yazici bostayken ve yogun yazma altindayken karsilastirir
+void runSnapshotBenchmark(int readerCount, double seconds) {
+    if (readerCount < 1) readerCount = 1;
+    if (readerCount > SNAPSHOT_MAX_READERS - 1) readerCount = SNAPSHOT_MAX_READERS - 1;
+
+    char date[11];
+    quietMode = 1;
+    for (int i = 0; i < SNAPSHOT_BENCH_PRELOAD; i++) {
+        int customerID = addCustomer("Ali", "Yilmaz");
+        for (int j = 0; j < 20; j++) {
+            daysToDate(daysFromCivil(2024, 1, 1) + j, date);
+            addShipment(customerID, date, "Teslim Edilmedi", 1 + (i + j) % 9);
+        }
+        addToPriorityQueue(i + 1, 1 + i % 9, "Isleme Alindi");
+        pushShipment(i + 1, "2024-01-01", "Teslim Edilmedi", 1 + i % 9);
+    }
+
+    SnapshotBenchReader* readers = (SnapshotBenchReader*)safeMalloc(readerCount * sizeof(SnapshotBenchReader));
+    memset(readers, 0, readerCount * sizeof(SnapshotBenchReader));
+    for (int r = 0; r < readerCount; r++) {
+        for (int phase = 0; phase < 2; phase++) {
+            for (int kind = 0; kind < 3; kind++) {
+                readers[r].latencies[phase][kind] = (double*)safeMalloc(SNAPSHOT_BENCH_SAMPLES * sizeof(double));
+            }
+        }
+    }
+
+    snapshotBenchPhase = 0;
+    int startedReaders = 0;
+    while (startedReaders < readerCount &&
+           pthread_create(&readers[startedReaders].thread, NULL, snapshotBenchReaderMain, &readers[startedReaders]) == 0) {
+        startedReaders++;
+    }
+    if (startedReaders < readerCount) {
+        printf("Okuyucu is parcacigi acilamadi; %d okuyucuyla devam ediliyor.\n", startedReaders);
+    }
+
+    // 1. Asama: yazici bosta
+    double phaseEnd = monotonicSeconds() + seconds;
+    while (monotonicSeconds() < phaseEnd) {
+        usleep(10000);
+    }
+    __atomic_store_n(&snapshotBenchPhase, 1, __ATOMIC_RELEASE);
+
+    // 2. Asama: yazici surekli ekleyip cikariyor
+    long writes = 0;
+    PriorityQueueNode taken;
+    ShipmentStackNode top;
+    phaseEnd = monotonicSeconds() + seconds;
+    while (monotonicSeconds() < phaseEnd) {
+        for (int i = 0; i < 256; i++, writes++) {
+            int shipmentID = SNAPSHOT_BENCH_PRELOAD + 1 + (int)(writes % 1000000000);
+            addToPriorityQueue(shipmentID, 1 + (int)(writes % 9), "Isleme Alindi");
+            takePriorityQueueHead(&taken);
+            pushShipment(shipmentID, "2024-02-01", "Teslimatta", 2);
+            takeStackTop(&top);
+            if (writes % 64 == 0) {
+                addShipment(1 + (int)(writes / 64 % SNAPSHOT_BENCH_PRELOAD), "2024-02-01", "Teslim Edildi", 3);
+            }
+        }
+    }
+    __atomic_store_n(&snapshotBenchPhase, 2, __ATOMIC_RELEASE);
+    for (int r = 0; r < startedReaders; r++) {
+        pthread_join(readers[r].thread, NULL);
+    }
+
+    reportSnapshotLatencies("Yazici bosta", 0, readers, startedReaders);
+    reportSnapshotLatencies("Yogun yazma altinda", 1, readers, startedReaders);
+    printf("  Yazici: %.0f islem/s\n", writes * 4 / seconds);
+
+    for (int r = 0; r < readerCount; r++) {
+        for (int phase = 0; phase < 2; phase++) {
+            for (int kind = 0; kind < 3; kind++) free(readers[r].latencies[phase][kind]);
+        }
+    }
+    free(readers);
+    quietMode = 0;
+}
+
+// Stack'e ekle/cikar dongusunun tekillestirme acik ve kapali maliyeti.
+// Stack'te surekli DEDUP_BENCH_LIVE canli ID bulunur; her 10 eklemeden biri
+// canli bir ID'nin tekrarıdir (tarayici yeniden denemesi).
+#define DEDUP_BENCH_LIVE 100000
+
+// Filtre sayaclari stats'a kopyalanir (isaretciler serbest birakilmis olur)
+double timeDedupPushPop(long operationCount, long* rejected, ShipmentIDFilter* stats) {
+    ShipmentStackNode top;
+    for (int i = 1; i <= DEDUP_BENCH_LIVE; i++) {
+        pushShipment(i, "2024-01-01", "Teslim Edilmedi", 1);
+    }
+
+    *rejected = 0;
+    double start = monotonicSeconds();
+    for (long i = 0; i < operationCount; i++) {
+        if (i % 10 == 9) {
+            // Canli ID tekrari: tekillestirme aciksa reddedilir
+            if (pushShipment(1 + (int)(i % DEDUP_BENCH_LIVE), "2024-01-01", "Teslim Edilmedi", 1)) {
+                takeStackTop(&top);
+            } else {
+                (*rejected)++;
+            }
+            continue;
+        }
+        pushShipment(DEDUP_BENCH_LIVE + 1 + (int)i, "2024-01-01", "Teslim Edilmedi", 1);
+        takeStackTop(&top);
+    }
+    double elapsed = monotonicSeconds() - start;
+
+    *stats = stackIDFilter;
+    freeShipmentStack();
+    return elapsed;
+}
+
+void runDedupBenchmark(long operationCount) {
+    long rejected;
+    ShipmentIDFilter stats;
+    quietMode = 1;
+
+    shipmentDedupEnabled = 0;
+    double plain = timeDedupPushPop(operationCount, &rejected, &stats);
+
+    shipmentDedupEnabled = 1;
+    double deduped = timeDedupPushPop(operationCount, &rejected, &stats);
+    quietMode = 0;
+
+    printf("Tekillestirme (kesin ID kumesi):\n");
+    printf("  Kapali: %.1f ns/ekleme+cikarma\n", plain * 1e9 / operationCount);
+    printf("  Acik:   %.1f ns/ekleme+cikarma (ekleme basina ek %.1f ns)\n",
+           deduped * 1e9 / operationCount, (deduped - plain) * 1e9 / operationCount);
+    printf("  Reddedilen tekrar: %ld / %ld\n", rejected, operationCount / 10);
+    printf("  Bellek: kesin kume %zu bayt (%u yuva, %u canli ID)\n",
+           (size_t)stats.slotCount * sizeof(int64_t), stats.slotCount, stats.live);
+}
+
+int compareInts(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Son 90 gunun gunluk adet ve p95 sorgusu: ozetlerden okuma ile tum
+// gecmisi gezip gunlere gore gruplamanin karsilastirmasi
+void runRollupBenchmark(long shipmentCount) {
+    enum { CUSTOMERS = 1000, SPAN_DAYS = 365, QUERY_DAYS = 90, ROUNDS = 20 };
+    char date[11];
+    int firstDay = daysFromCivil(2024, 1, 1);
+    quietMode = 1;
+
+    for (int i = 0; i < CUSTOMERS; i++) {
+        addCustomer("Ali", "Yilmaz");
+    }
+    unsigned int seed = 12345;
+    double start = monotonicSeconds();
+    for (long i = 0; i < shipmentCount; i++) {
+        seed = seed * 1103515245u + 12345u;
+        daysToDate(firstDay + (int)(seed >> 8) % SPAN_DAYS, date);
+        int deliveryTime = 1 + (int)(seed >> 20) % 12 + ((seed & 0xff) == 0 ? 40 : 0);
+        addShipment(1 + (int)(i % CUSTOMERS), date, (seed & 16) ? "Teslim Edildi" : "Teslim Edilmedi", deliveryTime);
+    }
+    double loadSeconds = monotonicSeconds() - start;
+    quietMode = 0;
+
+    int endDay = rollupLastDay;
+    DeliveryRollup* days = (DeliveryRollup*)safeMalloc(QUERY_DAYS * sizeof(DeliveryRollup));
+    int rollupP95[QUERY_DAYS];
+    start = monotonicSeconds();
+    for (int round = 0; round < ROUNDS; round++) {
+        collectDailyRollups(endDay, QUERY_DAYS, days);
+        for (int d = 0; d < QUERY_DAYS; d++) rollupP95[d] = rollupPercentile(&days[d], 0.95);
+    }
+    double rollupSeconds = (monotonicSeconds() - start) / ROUNDS;
+
+    // Eski yol: tum gonderileri gez, penceredekileri gunlere dagit, siralayip p95 al
+    int* values[QUERY_DAYS];
+    int counts[QUERY_DAYS], capacities[QUERY_DAYS];
+    int exactP95[QUERY_DAYS];
+    for (int d = 0; d < QUERY_DAYS; d++) {
+        capacities[d] = 64;
+        values[d] = (int*)safeMalloc(capacities[d] * sizeof(int));
+    }
+    start = monotonicSeconds();
+    for (int round = 0; round < ROUNDS; round++) {
+        memset(counts, 0, sizeof(counts));
+        for (Customer* customer = customerList; customer != NULL; customer = customer->next) {
+            for (Shipment* shipment = customerHistory(customer); shipment != NULL; shipment = shipment->next) {
+                int d = dateToDays(shipment->date) - (endDay - QUERY_DAYS + 1);
+                if (d < 0 || d >= QUERY_DAYS) continue;
+                if (counts[d] == capacities[d]) {
+                    capacities[d] *= 2;
+                    values[d] = (int*)safeRealloc(values[d], capacities[d] * sizeof(int));
+                }
+                values[d][counts[d]++] = shipment->deliveryTime;
+            }
+        }
+        for (int d = 0; d < QUERY_DAYS; d++) {
+            if (counts[d] == 0) {
+                exactP95[d] = 0;
+                continue;
+            }
+            qsort(values[d], counts[d], sizeof(int), compareInts);
+            int rank = (int)(0.95 * counts[d] + 0.999999);
+            exactP95[d] = values[d][(rank > 0 ? rank : 1) - 1];
+        }
+    }
+    double walkSeconds = (monotonicSeconds() - start) / ROUNDS;
+
+    int mismatches = 0;
+    for (int d = 0; d < QUERY_DAYS; d++) {
+        if ((int)days[d].count != counts[d] || rollupP95[d] != exactP95[d]) mismatches++;
+        free(values[d]);
+    }
+    free(days);
+
+    printf("%ld gonderi (%d gun), ozet guncellemeli yukleme %.2f s\n", shipmentCount, SPAN_DAYS, loadSeconds);
+    printf("Son %d gun, gunluk adet + p95:\n", QUERY_DAYS);
+    printf("  Ozetlerden:       %10.1f us\n", rollupSeconds * 1e6);
+    printf("  Gecmisi gezerek:  %10.1f us (%.0fx)\n", walkSeconds * 1e6, walkSeconds / rollupSeconds);
+    printf("  Farkli gun sayisi: %d / %d\n", mismatches, QUERY_DAYS);
+}
+
+#ifdef KARGO_LEGACY_BENCH
+// Arsivleme oncesi qsort ile kullanilan karsilastirici (yalnizca --bench-sort icin)
+int legacyCompareArchiveCandidates(const void* a, const void* b) {
+    const Shipment* x = *(Shipment* const*)a;
+    const Shipment* y = *(Shipment* const*)b;
+    int dayX = dateToDays(x->date), dayY = dateToDays(y->date);
+    if (dayX != dayY) return (dayX > dayY) - (dayX < dayY);
+    return (x->shipmentID > y->shipmentID) - (x->shipmentID < y->shipmentID);
+}
+
+// Dugumleri order sirasiyla tek listeye baglar
+Shipment* linkShipmentsInOrder(Shipment* nodes, const int* order, long count) {
+    Shipment* head = NULL;
+    for (long i = count - 1; i >= 0; i--) {
+        nodes[order[i]].next = head;
+        head = &nodes[order[i]];
+    }
+    return head;
+}
+
+// Uretilmis cekirdekleri onceki el yazimi surumlerle karsilastirir:
+// teslim suresine gore liste siralama, tarihe gore sirali ekleme, teslim
+// edilmis kargo arama ve arsiv adaylarinin dizi siralamasi
+void runSortBenchmark(long length, int rounds) {
+    Shipment* nodes = (Shipment*)safeMalloc((size_t)length * sizeof(Shipment));
+    int* order = (int*)safeMalloc((size_t)length * sizeof(int));
+    int* legacyOrder = (int*)safeMalloc((size_t)length * sizeof(int));
+    int firstDay = daysFromCivil(2018, 1, 1);
+    unsigned int seed = 2024;
+
+    for (long i = 0; i < length; i++) {
+        seed = seed * 1103515245u + 12345u;
+        nodes[i].shipmentID = (int)i + 1;
+        daysToDate(firstDay + (int)(seed >> 8) % 2500, nodes[i].date);
+        strcpy(nodes[i].status, "Teslim Edilmedi");
+        nodes[i].deliveryTime = 1 + (int)(seed >> 20) % 30;
+        nodes[i].version = 0;
+        order[i] = (int)i;
+    }
+    printf("%ld dugumluk listeler, %d tur:\n", length, rounds);
+
+    // 1) Teslim suresine gore siralama (tum kargolar teslim edilmemis: eski
+    //    karsilastirici bu durumda kararli teslim suresi sirasidir)
+    double legacySeconds = 0, kernelSeconds = 0;
+    int mismatches = 0;
+    for (int round = 0; round < rounds; round++) {
+        for (long i = length - 1; i > 0; i--) {
+            seed = seed * 1103515245u + 12345u;
+            long j = (long)((seed >> 4) % (unsigned int)(i + 1));
+            int swap = order[i]; order[i] = order[j]; order[j] = swap;
+        }
+        Shipment* list = linkShipmentsInOrder(nodes, order, length);
+        double start = monotonicSeconds();
+        legacyMergeSortShipments(&list);
+        legacySeconds += monotonicSeconds() - start;
+        long k = 0;
+        for (Shipment* s = list; s != NULL; s = s->next) legacyOrder[k++] = s->shipmentID;
+
+        list = linkShipmentsInOrder(nodes, order, length);
+        start = monotonicSeconds();
+        shipmentsByDeliverySort(&list);
+        kernelSeconds += monotonicSeconds() - start;
+        k = 0;
+        for (Shipment* s = list; s != NULL; s = s->next) {
+            if (legacyOrder[k++] != s->shipmentID) mismatches++;
+        }
+    }
+    printf("  Liste siralama (teslim suresi): eski %.2f ms, cekirdek %.2f ms (%.1fx), farkli konum %d\n",
+           legacySeconds * 1e3 / rounds, kernelSeconds * 1e3 / rounds, legacySeconds / kernelSeconds, mismatches);
+
+    // 2) Tarihe gore sirali ekleme (addShipment ve toplu aktarim birlestirmesi)
+    long insertCount = length < 8000 ? length : 8000;
+    Shipment* legacyList = NULL;
+    double start = monotonicSeconds();
+    for (long i = 0; i < insertCount; i++) {
+        Shipment** current = &legacyList;
+        while (*current != NULL && strcmp((*current)->date, nodes[i].date) <= 0) {
+            current = &(*current)->next;
+        }
+        nodes[i].next = *current;
+        *current = &nodes[i];
+    }
+    legacySeconds = monotonicSeconds() - start;
+    long k = 0;
+    for (Shipment* s = legacyList; s != NULL; s = s->next) legacyOrder[k++] = s->shipmentID;
+
+    Shipment* kernelList = NULL;
+    start = monotonicSeconds();
+    for (long i = 0; i < insertCount; i++) {
+        Shipment** current = shipmentsByDateInsertLink(&kernelList, &nodes[i]);
+        nodes[i].next = *current;
+        *current = &nodes[i];
+    }
+    kernelSeconds = monotonicSeconds() - start;
+    mismatches = 0;
+    k = 0;
+    for (Shipment* s = kernelList; s != NULL; s = s->next) {
+        if (legacyOrder[k++] != s->shipmentID) mismatches++;
+    }
+    printf("  Sirali ekleme (%ld kayit):       eski %.2f ms, cekirdek %.2f ms (%.1fx), farkli konum %d\n",
+           insertCount, legacySeconds * 1e3, kernelSeconds * 1e3, legacySeconds / kernelSeconds, mismatches);
+
+    // 3) Teslim edilmis kargo arama: tarih sirali listede rastgele gunler
+    for (long i = 0; i < length; i++) {
+        strcpy(nodes[i].status, (i % 3 == 0) ? "Teslim Edilmedi" : "Teslim Edildi");
+    }
+    Shipment* sorted = linkShipmentsInOrder(nodes, order, length);
+    shipmentsByDateIDSort(&sorted);
+    int queries = rounds * 20;
+    long legacyFound = 0, kernelFound = 0;
+    char date[11];
+    legacySeconds = kernelSeconds = 0;
+    for (int q = 0; q < queries; q++) {
+        seed = seed * 1103515245u + 12345u;
+        daysToDate(firstDay + (int)(seed >> 8) % 2500, date);
+        start = monotonicSeconds();
+        legacyFound += legacySearchDeliveredInList(sorted, date) != NULL;
+        legacySeconds += monotonicSeconds() - start;
+        start = monotonicSeconds();
+        kernelFound += searchDeliveredInList(sorted, date) != NULL;
+        kernelSeconds += monotonicSeconds() - start;
+    }
+    printf("  Teslim edilmis arama (%d sorgu): eski %.1f us, cekirdek %.1f us (%.1fx), bulunan %ld / %ld\n",
+           queries, legacySeconds * 1e6 / queries, kernelSeconds * 1e6 / queries, legacySeconds / kernelSeconds,
+           legacyFound, kernelFound);
+
+    // 4) Arsiv adaylari: qsort + fonksiyon isaretcisi ile dizi cekirdegi
+    Shipment** legacyItems = (Shipment**)safeMalloc((size_t)length * sizeof(Shipment*));
+    Shipment** kernelItems = (Shipment**)safeMalloc((size_t)length * sizeof(Shipment*));
+    legacySeconds = kernelSeconds = 0;
+    mismatches = 0;
+    for (int round = 0; round < rounds; round++) {
+        for (long i = 0; i < length; i++) {
+            legacyItems[i] = kernelItems[i] = &nodes[order[(i + round * 7919L) % length]];
+        }
+        start = monotonicSeconds();
+        qsort(legacyItems, (size_t)length, sizeof(Shipment*), legacyCompareArchiveCandidates);
+        legacySeconds += monotonicSeconds() - start;
+        start = monotonicSeconds();
+        shipmentsByDateIDSortArray(kernelItems, (size_t)length);
+        kernelSeconds += monotonicSeconds() - start;
+        for (long i = 0; i < length; i++) mismatches += legacyItems[i] != kernelItems[i];
+    }
+    printf("  Dizi siralama (tarih, ID):       qsort %.2f ms, cekirdek %.2f ms (%.1fx), farkli konum %d\n",
+           legacySeconds * 1e3 / rounds, kernelSeconds * 1e3 / rounds, legacySeconds / kernelSeconds, mismatches);
+
+    free(legacyItems);
+    free(kernelItems);
+    free(legacyOrder);
+    free(order);
+    free(nodes);
+}
+#else
+void runSortBenchmark(long length, int rounds) {
+    (void)length;
+    (void)rounds;
+    printf("Eski siralama ve arama surumleri derlenmedi (-DKARGO_LEGACY_BENCH ile derleyin).\n");
+}
+#endif
+
+// Ayrik Olayli Dagitim Simulasyonu
+//
+// Kargolar merkeze (kok sehir) ulasinca addToPriorityQueue ile kuyruga girer ve
+// merkez kuyrugu toplam teslim suresine gore isler. Her kargo kokten hedef
+// sehre kadar agac boyunca ilerler: her hub'da islenir, sonra alt sehre o
+// sehrin deliveryTime'i kadar (gun) yolculukla gecer. Ara hub'larda bekleme
+// FIFO'dur. Her hub saatte en fazla hubCapacity kargo isler (tek hat).
+// Olay takvimi ikili yigindir (binary heap); zaman dakika cinsindendir.
+#define SIM_MINUTES_PER_DAY 1440.0
+#define SIM_SAMPLE_MINUTES 60.0
+#define SIM_REPORT_ROWS 24
+
+enum SimEventType {
+    SIM_ARRIVAL,      // Kargo merkeze ulasti
+    SIM_SERVICE_DONE, // Hub kargoyu isledi
+    SIM_HOP_ARRIVAL,  // Kargo bir alt hub'a ulasti
+    SIM_SAMPLE        // Kuyruk derinligi olcumu
+};
+
+typedef struct SimEvent {
+    double time;
+    uint32_t sequence; // Ayni zamanli olaylar eklenme sirasiyla islenir
+    int type;
+    int parcel;
+    int hub;
+} SimEvent;
+
+typedef struct EventCalendar {
+    SimEvent* heap;
+    int count;
+    int capacity;
+    uint32_t nextSequence;
+} EventCalendar;
+
+typedef struct SimHub {
+    CityNode* city;
+    int parent;            // Ebeveyn hub (kok icin -1)
+    double transitMinutes; // Ebeveynden bu hub'a yolculuk
+    int busy;              // Islenen kargo (-1: bos)
+    int* waiting;          // FIFO halka tampon; kok hub yerine priorityQueue kullanilir
+    int head, length, capacity;
+    long processed;
+    int maxWaiting;
+} SimHub;
+
+typedef struct SimParcel {
+    double arrival;
+    int destination; // Hub indeksi
+    int routeDays;   // Kokten hedefe toplam teslim suresi (kuyruk onceligi)
+} SimParcel;
+
+typedef struct SimSample {
+    double time;
+    int rootWaiting;
+    int totalWaiting;
+} SimSample;
+
+int simEventBefore(const SimEvent* a, const SimEvent* b) {
+    return a->time < b->time || (a->time == b->time && (int32_t)(a->sequence - b->sequence) < 0);
+}
+
+void scheduleEvent(EventCalendar* calendar, double time, int type, int parcel, int hub) {
+    if (calendar->count == calendar->capacity) {
+        calendar->capacity = calendar->capacity ? calendar->capacity * 2 : 1024;
+        calendar->heap = (SimEvent*)safeRealloc(calendar->heap, calendar->capacity * sizeof(SimEvent));
+    }
+
+    SimEvent event = { time, calendar->nextSequence++, type, parcel, hub };
+    int index = calendar->count++;
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (!simEventBefore(&event, &calendar->heap[parent])) break;
+        calendar->heap[index] = calendar->heap[parent];
+        index = parent;
+    }
+    calendar->heap[index] = event;
+}
+
+int nextEvent(EventCalendar* calendar, SimEvent* out) {
+    if (calendar->count == 0) {
+        return 0;
+    }
+    *out = calendar->heap[0];
+
+    SimEvent last = calendar->heap[--calendar->count];
+    int index = 0;
+    while (1) {
+        int child = 2 * index + 1;
+        if (child >= calendar->count) break;
+        if (child + 1 < calendar->count && simEventBefore(&calendar->heap[child + 1], &calendar->heap[child])) {
+            child++;
+        }
+        if (!simEventBefore(&calendar->heap[child], &last)) break;
+        calendar->heap[index] = calendar->heap[child];
+        index = child;
+    }
+    calendar->heap[index] = last;
+    return 1;
+}
+
+// Agaci on-sirada hub dizisine acar
+void flattenSimHubs(CityNode* node, int parent, SimHub** hubs, int* count, int* capacity) {
+    for (; node != NULL; node = node->sibling) {
+        if (*count == *capacity) {
+            *capacity = *capacity ? *capacity * 2 : 64;
+            *hubs = (SimHub*)safeRealloc(*hubs, *capacity * sizeof(SimHub));
+        }
+        int index = (*count)++;
+        SimHub* hub = &(*hubs)[index];
+        memset(hub, 0, sizeof(SimHub));
+        hub->city = node;
+        hub->parent = parent;
+        hub->transitMinutes = node->deliveryTime * SIM_MINUTES_PER_DAY;
+        hub->busy = -1;
+        flattenSimHubs(node->child, index, hubs, count, capacity);
+    }
+}
+
+// from hub'indan destination'a giden yoldaki bir sonraki hub
+int nextSimHop(const SimHub* hubs, int from, int destination) {
+    int hop = destination;
+    while (hubs[hop].parent != from) {
+        hop = hubs[hop].parent;
+    }
+    return hop;
+}
+
+void pushSimWaiting(SimHub* hub, int parcel) {
+    if (hub->length == hub->capacity) {
+        int newCapacity = hub->capacity ? hub->capacity * 2 : 16;
+        int* ring = (int*)safeMalloc(newCapacity * sizeof(int));
+        for (int i = 0; i < hub->length; i++) {
+            ring[i] = hub->waiting[(hub->head + i) % hub->capacity];
+        }
+        free(hub->waiting);
+        hub->waiting = ring;
+        hub->head = 0;
+        hub->capacity = newCapacity;
+    }
+    hub->waiting[(hub->head + hub->length++) % hub->capacity] = parcel;
+    if (hub->length > hub->maxWaiting) hub->maxWaiting = hub->length;
+}
+
+// Kayitli trafik: her satir "dakika,sehirID". Satirlar dakikaya gore siralanir.
+int loadSimTrace(const char* path, const SimHub* hubs, int hubCount, SimParcel** parcels) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        printf("Hata: %s acilamadi: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    int maxCityID = 0;
+    for (int i = 0; i < hubCount; i++) {
+        if (hubs[i].city->cityID > maxCityID) maxCityID = hubs[i].city->cityID;
+    }
+    int* hubByCity = (int*)safeMalloc((maxCityID + 1) * sizeof(int));
+    for (int i = 0; i <= maxCityID; i++) hubByCity[i] = -1;
+    for (int i = 0; i < hubCount; i++) hubByCity[hubs[i].city->cityID] = i;
+
+    char line[128];
+    int count = 0, capacity = 0, lineNumber = 0;
+    *parcels = NULL;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        lineNumber++;
+        double minute;
+        int cityID;
+        if (line[0] == '#' || line[0] == '\n') continue;
+        if (sscanf(line, "%lf,%d", &minute, &cityID) != 2 || minute < 0 ||
+            cityID <= 0 || cityID > maxCityID || hubByCity[cityID] < 0) {
+            printInfo("Satir %d: gecersiz kayit.\n", lineNumber);
+            continue;
+        }
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 1024;
+            *parcels = (SimParcel*)safeRealloc(*parcels, capacity * sizeof(SimParcel));
+        }
+        (*parcels)[count].arrival = minute;
+        (*parcels)[count].destination = hubByCity[cityID];
+        count++;
+    }
+    fclose(file);
+    free(hubByCity);
+    return count;
+}
+
+int compareSimArrivals(const void* a, const void* b) {
+    double x = ((const SimParcel*)a)->arrival, y = ((const SimParcel*)b)->arrival;
+    return (x > y) - (x < y);
+}
+
+// Hub bossa siradaki kargoyu isleme alir
+void startSimService(EventCalendar* calendar, SimHub* hubs, int hubIndex, double now, double serviceMinutes) {
+    SimHub* hub = &hubs[hubIndex];
+    if (hub->busy >= 0) {
+        return;
+    }
+
+    if (hubIndex == 0) {
+        PriorityQueueNode head;
+        if (!takePriorityQueueHead(&head)) return;
+        hub->busy = head.shipmentID - 1;
+        hub->length--;
+    } else {
+        if (hub->length == 0) return;
+        hub->busy = hub->waiting[hub->head];
+        hub->head = (hub->head + 1) % hub->capacity;
+        hub->length--;
+    }
+    scheduleEvent(calendar, now + serviceMinutes, SIM_SERVICE_DONE, hub->busy, hubIndex);
+}
+
+// parcelCount kadar rastgele (ya da tracePath'ten okunan) kargoyu bir gune yayarak
+// dagitimi simule eder. hubCapacity: hub basina saatlik isleme kapasitesi.
+void runDispatchSimulation(long parcelCount, int hubCapacity, const char* tracePath) {
+    SimHub* hubs = NULL;
+    int hubCount = 0, hubCapacityAllocated = 0;
+    flattenSimHubs(root, -1, &hubs, &hubCount, &hubCapacityAllocated);
+    if (hubCount == 0) {
+        printf("Teslimat agi bos.\n");
+        return;
+    }
+    if (hubCapacity <= 0) hubCapacity = 1;
+    double serviceMinutes = 60.0 / hubCapacity;
+
+    SimParcel* parcels = NULL;
+    if (tracePath != NULL) {
+        int loaded = loadSimTrace(tracePath, hubs, hubCount, &parcels);
+        if (loaded < 0) {
+            free(hubs);
+            return;
+        }
+        parcelCount = loaded;
+        qsort(parcels, parcelCount, sizeof(SimParcel), compareSimArrivals);
+    } else {
+        // Gune esit dagilmis rastgele anlar siralaninca Poisson gelisleri verir;
+        // hedefler kok disindaki sehirlere esit dagilimlidir
+        parcels = (SimParcel*)safeMalloc((parcelCount > 0 ? parcelCount : 1) * sizeof(SimParcel));
+        uint64_t seed = 88172645463325252ull;
+        for (long i = 0; i < parcelCount; i++) {
+            seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17; // xorshift64
+            parcels[i].arrival = (seed >> 11) * (SIM_MINUTES_PER_DAY / 9007199254740992.0);
+            parcels[i].destination = hubCount > 1 ? 1 + (int)((seed >> 20) % (uint64_t)(hubCount - 1)) : 0;
+        }
+        qsort(parcels, parcelCount, sizeof(SimParcel), compareSimArrivals);
+    }
+
+    for (long i = 0; i < parcelCount; i++) {
+        int routeDays = 0;
+        for (int hop = parcels[i].destination; hop > 0; hop = hubs[hop].parent) {
+            routeDays += hubs[hop].city->deliveryTime;
+        }
+        parcels[i].routeDays = routeDays;
+    }
+
+    EventCalendar calendar = { NULL, 0, 0, 0 };
+    double* latencies = (double*)safeMalloc((parcelCount > 0 ? parcelCount : 1) * sizeof(double));
+    SimSample* samples = NULL;
+    int sampleCount = 0, sampleCapacity = 0;
+    long delivered = 0, events = 0, nextArrival = 0;
+    double lastDelivery = 0;
+
+    quietMode = 1;
+    if (parcelCount > 0) {
+        scheduleEvent(&calendar, parcels[0].arrival, SIM_ARRIVAL, 0, 0);
+        scheduleEvent(&calendar, 0, SIM_SAMPLE, -1, 0);
+        nextArrival = 1;
+    }
+
+    double wallStart = monotonicSeconds();
+    SimEvent event;
+    while (nextEvent(&calendar, &event)) {
+        events++;
+        switch (event.type) {
+            case SIM_ARRIVAL:
+                addToPriorityQueue(event.parcel + 1, parcels[event.parcel].routeDays, "Simulasyon");
+                if (++hubs[0].length > hubs[0].maxWaiting) hubs[0].maxWaiting = hubs[0].length;
+                startSimService(&calendar, hubs, 0, event.time, serviceMinutes);
+                if (nextArrival < parcelCount) {
+                    scheduleEvent(&calendar, parcels[nextArrival].arrival, SIM_ARRIVAL, (int)nextArrival, 0);
+                    nextArrival++;
+                }
+                break;
+
+            case SIM_SERVICE_DONE: {
+                SimHub* hub = &hubs[event.hub];
+                hub->busy = -1;
+                hub->processed++;
+                int destination = parcels[event.parcel].destination;
+                if (event.hub == destination) {
+                    latencies[delivered++] = event.time - parcels[event.parcel].arrival;
+                    lastDelivery = event.time;
+                } else {
+                    int next = nextSimHop(hubs, event.hub, destination);
+                    scheduleEvent(&calendar, event.time + hubs[next].transitMinutes, SIM_HOP_ARRIVAL, event.parcel, next);
+                }
+                startSimService(&calendar, hubs, event.hub, event.time, serviceMinutes);
+                break;
+            }
+
+            case SIM_HOP_ARRIVAL:
+                pushSimWaiting(&hubs[event.hub], event.parcel);
+                startSimService(&calendar, hubs, event.hub, event.time, serviceMinutes);
+                break;
+
+            case SIM_SAMPLE: {
+                if (sampleCount == sampleCapacity) {
+                    sampleCapacity = sampleCapacity ? sampleCapacity * 2 : 256;
+                    samples = (SimSample*)safeRealloc(samples, sampleCapacity * sizeof(SimSample));
+                }
+                int totalWaiting = 0;
+                for (int i = 0; i < hubCount; i++) totalWaiting += hubs[i].length;
+                samples[sampleCount++] = (SimSample){ event.time, hubs[0].length, totalWaiting };
+                if (delivered < parcelCount) {
+                    scheduleEvent(&calendar, event.time + SIM_SAMPLE_MINUTES, SIM_SAMPLE, -1, 0);
+                }
+                break;
+            }
+        }
+    }
+    double wallSeconds = monotonicSeconds() - wallStart;
+    quietMode = 0;
+
+    printf("Simulasyon: %ld kargo, %d hub, hub basina saatte %d kargo\n", parcelCount, hubCount, hubCapacity);
+    printf("  %ld olay %.2f s'de islendi (%.0f olay/s)\n", events, wallSeconds, events / wallSeconds);
+    if (delivered > 0) {
+        qsort(latencies, delivered, sizeof(double), compareDoubles);
+        printf("  Teslim edilen: %ld, son teslim %.1f. saatte (gunde ortalama %.1f kargo)\n", delivered,
+               lastDelivery / 60.0, delivered / (lastDelivery > 0 ? lastDelivery / SIM_MINUTES_PER_DAY : 1));
+        printf("  Gecikme (saat): p50 %.1f, p90 %.1f, p99 %.1f, en fazla %.1f\n",
+               latencies[delivered / 2] / 60.0, latencies[(long)(delivered * 0.90)] / 60.0,
+               latencies[(long)(delivered * 0.99)] / 60.0, latencies[delivered - 1] / 60.0);
+    }
+    printf("  Merkez kuyrugu en fazla %d kargo\n", hubs[0].maxWaiting);
+
+    // Saatlik olcumler en fazla SIM_REPORT_ROWS satira, her aralik kendi en yuksek degeriyle yazilir
+    printf("  Saat  Merkez kuyrugu  Tum hub'larda bekleyen\n");
+    int stride = (sampleCount + SIM_REPORT_ROWS - 1) / SIM_REPORT_ROWS;
+    for (int i = 0; i < sampleCount; i += stride) {
+        int rootPeak = 0, totalPeak = 0;
+        for (int j = i; j < i + stride && j < sampleCount; j++) {
+            if (samples[j].rootWaiting > rootPeak) rootPeak = samples[j].rootWaiting;
+            if (samples[j].totalWaiting > totalPeak) totalPeak = samples[j].totalWaiting;
+        }
+        printf("  %5.0f %15d %23d\n", samples[i].time / 60.0, rootPeak, totalPeak);
+    }
+
+    // En cok bekleten hub'lar
+    printf("  Hub                   Islenen  En fazla bekleyen  Doluluk\n");
+    for (int shown = 0; shown < 5 && shown < hubCount; shown++) {
+        int best = -1;
+        for (int i = 0; i < hubCount; i++) {
+            if (hubs[i].maxWaiting >= 0 && (best < 0 || hubs[i].maxWaiting > hubs[best].maxWaiting)) best = i;
+        }
+        if (best < 0) break;
+        printf("  %-20s %8ld %18d %7.1f%%\n", hubs[best].city->cityName, hubs[best].processed, hubs[best].maxWaiting,
+               lastDelivery > 0 ? 100.0 * hubs[best].processed * serviceMinutes / lastDelivery : 0.0);
+        hubs[best].maxWaiting = -1; // Tekrar secilmesin
+    }
+
+    for (int i = 0; i < hubCount; i++) free(hubs[i].waiting);
+    free(hubs);
+    free(parcels);
+    free(latencies);
+    free(samples);
+    free(calendar.heap);
+}
+
+// Yogun merkezli trafik: kargolarin %40'i Istanbul'a, kalani diger sehirlere.
+// Ayni kargolar once tek kuyruga (hepsi kokte), sonra hub kuyruklarina dagitilip
+// artan isci sayilariyla bosaltilir. Tek cekirdekli bir makinede (200000
+// kargo, 1-4 isci) iki duzen arasinda fark olcum gurultusu icindedir
+// (0.88x-1.07x); kazanc ancak cekirdek sayisi kadar isciyle beklenir.
+#define HUB_BENCH_WORK 400
+
+_Thread_local uint64_t hubBenchSink = 0;
+
+// Etiket basma / rota hesabi yerine gecen sabit is
+void hubBenchHandler(int hub, const HubParcel* parcel, void* context) {
+    (void)context;
+    uint64_t x = (uint64_t)parcel->shipmentID * 2654435761u + (uint64_t)hub;
+    for (int i = 0; i < HUB_BENCH_WORK; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+    }
+    hubBenchSink += x;
+}
+
+void fillHubBenchQueues(long parcelCount, int singleQueue, const int* cityIDs, int cityCount) {
+    uint64_t seed = 0x2545F4914F6CDD1Dull;
+    for (long i = 0; i < parcelCount; i++) {
+        seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+        int cityID = (seed % 100) < 40 ? cityIDs[0] : cityIDs[1 + (seed >> 8) % (uint64_t)(cityCount - 1)];
+        enqueueHubParcel(singleQueue ? cityIDs[0] : cityID, (int)i + 1, 1 + (int)((seed >> 32) % 15), "Isleme Alindi");
+    }
+}
+
+void runHubDispatchBenchmark(long parcelCount, int maxThreads) {
+    buildHubQueues();
+    if (hubQueueCount < 2) {
+        printf("Olcum icin en az iki sehir gerekli.\n");
+        return;
+    }
+    int* cityIDs = (int*)safeMalloc(hubQueueCount * sizeof(int));
+    for (int i = 0; i < hubQueueCount; i++) cityIDs[i] = hubQueues[i].city->cityID;
+
+    printf("%ld kargo, %d hub (%%40'i %s'a), kargo basina %d adimlik is:\n", parcelCount, hubQueueCount,
+           hubQueues[0].city->cityName, HUB_BENCH_WORK);
+    printf("  Isci   Tek kuyruk (kargo/s)   Hub kuyruklari (kargo/s)   Kazanc\n");
+    for (int threads = 1; ; threads *= 2) {
+        if (threads > maxThreads) threads = maxThreads;
+
+        double rate[2];
+        for (int mode = 0; mode < 2; mode++) {
+            fillHubBenchQueues(parcelCount, mode == 0, cityIDs, hubQueueCount);
+            double start = monotonicSeconds();
+            long drained = drainHubQueues(threads, hubBenchHandler, NULL);
+            rate[mode] = drained / (monotonicSeconds() - start);
+        }
+        printf("  %4d %22.0f %26.0f %7.2fx\n", threads, rate[0], rate[1], rate[1] / rate[0]);
+        if (threads == maxThreads) break;
+    }
+
+    long stolen = 0;
+    for (int i = 0; i < hubQueueCount; i++) stolen += hubQueues[i].stolen;
+    printf("  Calinan toplam kargo: %ld\n", stolen);
+    free(cityIDs);
+}
+
+// argv[1]'deki tekillestirme secenegini uygular; tukettigi arguman sayisini doner
+int parseDedupOption(int argc, char* argv[]) {
+    if (argc >= 2 && strcmp(argv[1], "--no-dedup") == 0) {
+        shipmentDedupEnabled = 0;
+        return 1;
+    }
+    return 0;
+}
+
+int parsePartitionOption(int argc, char* argv[]) {
+    if (argc >= 3 && strcmp(argv[1], "--partitions") == 0) {
+        requestedPartitions = atoi(argv[2]);
+        return 2;
+    }
+    return 0;
+}
+
+int parseMemoryOption(int argc, char* argv[]) {
+    if (argc >= 3 && strcmp(argv[1], "--memory-limit") == 0) {
+        double megabytes = atof(argv[2]);
+        if (megabytes > 0) memoryCeiling = (size_t)(megabytes * 1048576);
+        return 2;
+    }
+    if (argc >= 3 && strcmp(argv[1], "--spill-file") == 0) {
+        spillPath = argv[2];
+        return 2;
+    }
+    return 0;
+}
+
+int parseTraceOption(int argc, char* argv[]) {
+    if (argc >= 3 && strcmp(argv[1], "--trace") == 0) {
+#ifdef KARGO_TRACE
+        tracePath = argv[2];
+        traceEnabled = 1;
+        atexit(flushTraceAtExit);
+#else
+        printf("Izleme derlenmedi (-DKARGO_TRACE ile derleyin); --trace yok sayildi.\n");
+#endif
+        return 2;
+    }
+    return 0;
+}
+
+const char* cityNetworkPath = NULL; // --cities (NULL: varsayilan sehirler)
+
+int parseCityOption(int argc, char* argv[]) {
+    if (argc >= 3 && strcmp(argv[1], "--cities") == 0) {
+        cityNetworkPath = argv[2];
+        return 2;
+    }
+    return 0;
+}
+
+// Ana fonksiyon
+// Kullanim: ./kargo                          -> etkilesimli menu
+//           ./kargo --server <soket>          -> Unix soket sunucusu
+//           ./kargo --bench-customers <adet>  -> musteri bellek raporu
+//           ./kargo --bench-archive <musteri> <gonderi> -> arsiv sikistirma raporu
+//           ./kargo --import <dosya.csv>      -> CSV aktarip menuye gec
+//           ./kargo --bench-import <satir> [is parcacigi] -> paralel CSV aktarim olcumu
+//           ./kargo --bench-snapshot <okuyucu> <saniye> -> yazici altinda okuyucu gecikmesi
+//           ./kargo --bench-dedup <islem>     -> kargo ID tekillestirme maliyeti
+//           ./kargo --bench-rollup <gonderi>  -> gunluk ozet sorgusu ve gecmis taramasi
+//           ./kargo --bench-sort <uzunluk> <tur> -> siralama/arama cekirdekleri ve eski surumler
+//                                             (yalnizca -DKARGO_LEGACY_BENCH ile)
+//           ./kargo --simulate <kargo> [saatlik kapasite] [kayit.csv] -> dagitim simulasyonu
+//           ./kargo --bench-hubs <kargo> [isci] -> hub kuyruklari ve tek kuyruk karsilastirmasi
+//           ./kargo --bench-memory <musteri> <gonderi> <MB> -> tavan altinda diske tasima dogrulamasi
+//           ./kargo --bench-export <musteri> <gonderi> -> CSV disa aktarim hizi ve sayfalama dogrulamasi
+//           ./kargo --bench-partitions <bolum> <musteri> <gonderi> -> bolumlu ve tek surec karsilastirmasi
+//           ./kargo --bench-cities [en buyuk ag] -> 10^4'ten itibaren sehir agi acilis suresi
+//                                             (eski addCity yalnizca -DKARGO_LEGACY_BENCH ile)
+//           ./kargo --bench-trace [cagri]     -> span maliyeti ve izlenen islemlerin asama dokumu
+//           ./kargo --bench-undo [gonderi]    -> toplu islem gunlugu ekleme maliyeti, geri alma/yineleme suresi
+// Diger seceneklerden once verilebilir:
+//           --no-dedup                        -> kuyruk/stack ID tekillestirmesini kapat
+//           --memory-limit <MB>               -> bellek tavani; asilinca eski gecmisler diske tasinir
+//           --spill-file <dosya>              -> tasma segmenti (varsayilan /tmp altinda gecici dosya)
+//           --partitions <N>                  -> sunucu istekleri musteri ID'sine gore N isci surece dagitir
+//           --cities <dosya>                  -> varsayilan sehirler yerine agi dosyadan yukle
+//           --trace <dosya.json>              -> -DKARGO_TRACE ile derlendiyse cikista Chrome izleme dosyasi
+int main(int argc, char* argv[]) {
+    int consumed;
+    while ((consumed = parseDedupOption(argc, argv)) > 0 || (consumed = parseMemoryOption(argc, argv)) > 0 ||
+           (consumed = parsePartitionOption(argc, argv)) > 0 || (consumed = parseCityOption(argc, argv)) > 0 ||
+           (consumed = parseTraceOption(argc, argv)) > 0) {
+        argv += consumed;
+        argc -= consumed;
+    }
+
+    if (cityNetworkPath == NULL) {
+        initializeDefaultCities();
+    } else if (loadCityNetwork(cityNetworkPath) < 0) {
+        return 1;
+    }
+
+    if (argc >= 3 && strcmp(argv[1], "--server") == 0) {
+        int result = runServer(argv[2]);
+        cleanup();
+        return result;
+    }
+    if (argc >= 2 && strcmp(argv[1], "--bench-customers") == 0) {
+        runCustomerBenchmark(argc >= 3 ? atol(argv[2]) : 10000000L);
+        cleanup();
+        return 0;
+    }
+    if (argc >= 3 && strcmp(argv[1], "--import") == 0) {
+        long importedCustomers, importedShipments;
+        int errors = importCsvFile(argv[2], defaultThreadCount(), &importedCustomers, &importedShipments);
+        if (errors >= 0) {
+            printf("%ld musteri ve %ld gonderi aktarildi, %d satir hatali.\n",
+                   importedCustomers, importedShipments, errors);
+        }
+    }
+    if (argc >= 2 && strcmp(argv[1], "--bench-import") == 0) {
+        runImportBenchmark(argc >= 3 ? atol(argv[2]) : 2000000, argc >= 4 ? atoi(argv[3]) : defaultThreadCount());
+        cleanup();
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "--bench-snapshot") == 0) {
+        runSnapshotBenchmark(argc >= 3 ? atoi(argv[2]) : 2, argc >= 4 ? atof(argv[3]) : 2.0);
+        cleanup();
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "--bench-hubs") == 0) {
+        runHubDispatchBenchmark(argc >= 3 ? atol(argv[2]) : 2000000, argc >= 4 ? atoi(argv[3]) : defaultThreadCount());
+        cleanup();
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "--simulate") == 0) {
+        runDispatchSimulation(argc >= 3 ? atol(argv[2]) : 100000, argc >= 4 ? atoi(argv[3]) : 3600,
+                              argc >= 5 ? argv[4] : NULL);
+        cleanup();
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "--bench-sort") == 0) {
+        runSortBenchmark(argc >= 3 ? atol(argv[2]) : 20000, argc >= 4 ? atoi(argv[3]) : 20);
+        cleanup();
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "--bench-rollup") == 0) {
+        runRollupBenchmark(argc >= 3 ? atol(argv[2]) : 200000);
+        cleanup();
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "--bench-dedup") == 0) {
+        runDedupBenchmark(argc >= 3 ? atol(argv[2]) : 5000000);
+        cleanup();
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "--bench-memory") == 0) {
+        runMemoryBenchmark(argc >= 3 ? atol(argv[2]) : 20000, argc >= 4 ? atoi(argv[3]) : 50,
+                           argc >= 5 ? atof(argv[4]) : 8.0);
+        cleanup();
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "--bench-export") == 0) {
+        runExportBenchmark(argc >= 3 ? atol(argv[2]) : 20000, argc >= 4 ? atoi(argv[3]) : 100);
+        cleanup();
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "--bench-partitions") == 0) {
+        runPartitionBenchmark(argc >= 3 ? atoi(argv[2]) : 4, argc >= 4 ? atol(argv[3]) : 20000,
+                              argc >= 5 ? atoi(argv[4]) : 20);
+        cleanup();
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "--bench-cities") == 0) {
+        runCityLoadBenchmark(argc >= 3 ? atol(argv[2]) : 1000000);
+        cleanup();
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "--bench-trace") == 0) {
+        runTraceBenchmark(argc >= 3 ? atol(argv[2]) : 20000000);
+        cleanup();
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "--bench-undo") == 0) {
+        runUndoBenchmark(argc >= 3 ? atol(argv[2]) : 200000);
+        cleanup();
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "--bench-archive") == 0) {
+        runArchiveBenchmark(argc >= 3 ? atol(argv[2]) : 2000, argc >= 4 ? atoi(argv[3]) : 1000);
+        cleanup();
+        return 0;
+    }
+
     menu();
     return 0;
 }